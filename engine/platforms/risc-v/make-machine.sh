@@ -19,14 +19,14 @@ docker run \
     --max-mcycle=0 \
     --initial-hash \
     --store="$MACHINE_TEMP_DIR" \
-    --flash-drive="label:verifier,filename:build/poker-lib.ext2" \
+    --flash-drive="label:verifier,filename:build/poker-verify.ext2" \
     --flash-drive="label:metadata,length:1<<12" \
     --flash-drive="label:players,length:1<<12" \
     --flash-drive="label:turnsMetadata,length:1<<16" \
     --flash-drive="label:turnsData,length:1<<20" \
     --flash-drive="label:verificationInfo,length:1<<12" \
     --flash-drive="label:output,length:1<<12" \
-    -- $'LD_LIBRARY_PATH=/mnt/verifier/lib /mnt/verifier/verify $(flashdrive players)  $(flashdrive turnsMetadata)  $(flashdrive verificationInfo) $(flashdrive turnsData) $(flashdrive output)'
+    -- $'/mnt/verifier/verify $(flashdrive players)  $(flashdrive turnsMetadata)  $(flashdrive verificationInfo) $(flashdrive turnsData) $(flashdrive output)'
 
 
 mkdir -p $MACHINES_DIR
@@ -13,11 +13,11 @@ docker run \
   -v `pwd`/../.xfer:/poker/xfer \
   -w /home/$(id -u -n) \
   --rm $CARTESI_PLAYGROUND_DOCKER cartesi-machine \
-    --flash-drive="label:verifier,filename:build/poker-lib.ext2" \
+    --flash-drive="label:verifier,filename:build/poker-verify.ext2" \
     --flash-drive="label:metadata,length:1<<12" \
     --flash-drive="label:players,filename:/poker/xfer/player-info.raw" \
     --flash-drive="label:turnsMetadata,filename:/poker/xfer/turn-metadata.raw" \
     --flash-drive="label:turnsData,filename:/poker/xfer/turn-data.raw" \
     --flash-drive="label:verificationInfo,filename:/poker/xfer/verification-info.raw" \
     --flash-drive="label:output,filename:/poker/xfer/output.raw,shared" \
-    -- $'LD_LIBRARY_PATH=/mnt/verifier/lib /mnt/verifier/verify $(flashdrive players)  $(flashdrive turnsMetadata)  $(flashdrive verificationInfo) $(flashdrive turnsData) $(flashdrive output)'
+    -- $'/mnt/verifier/verify $(flashdrive players)  $(flashdrive turnsMetadata)  $(flashdrive verificationInfo) $(flashdrive turnsData) $(flashdrive output)'
@@ -0,0 +1,468 @@
+#include <gmp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "compression.h"
+#include "game-generator.h"
+#include "game-playback.h"
+#include "messages.h"
+#include "participant.h"
+#include "poker-lib.h"
+#include "solver.h"
+
+using namespace poker;
+
+/*
+ * Microbenchmarks for each protocol stage.
+ * Results are written to stdout as JSON; a summary goes to stderr.
+ *
+ * Usage: bench [-n <iterations>] [-p <tmcg profile>] [<stage>...]
+*/
+
+// Allocation counters
+// operator new/delete are replaced for the whole program; GMP allocations
+// are counted through mp_set_memory_functions
+
+static std::atomic<uint64_t> alloc_count(0);
+static std::atomic<uint64_t> alloc_bytes(0);
+static std::atomic<uint64_t> gmp_alloc_count(0);
+
+void* operator new(std::size_t size) {
+    alloc_count++;
+    alloc_bytes += size;
+    void* p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    alloc_count++;
+    alloc_bytes += size;
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& nt) noexcept {
+    return operator new(size, nt);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete(void* p, std::size_t) noexcept { free(p); }
+void operator delete[](void* p, std::size_t) noexcept { free(p); }
+
+static void* (*gmp_alloc)(size_t);
+static void* (*gmp_realloc)(void*, size_t, size_t);
+static void (*gmp_free)(void*, size_t);
+
+static void* counting_gmp_alloc(size_t size) {
+    gmp_alloc_count++;
+    alloc_bytes += size;
+    return gmp_alloc(size);
+}
+
+static void* counting_gmp_realloc(void* p, size_t old_size, size_t new_size) {
+    gmp_alloc_count++;
+    alloc_bytes += new_size;
+    return gmp_realloc(p, old_size, new_size);
+}
+
+static void count_gmp_allocations() {
+    mp_get_memory_functions(&gmp_alloc, &gmp_realloc, &gmp_free);
+    mp_set_memory_functions(counting_gmp_alloc, counting_gmp_realloc, gmp_free);
+}
+
+/*
+ * Samples of a single benchmark.
+ * Each start()/stop() pair is one sample covering `ops` operations
+*/
+class bench {
+    typedef std::chrono::steady_clock clock;
+
+    clock::time_point _t0;
+    uint64_t _allocs0, _bytes0, _gmp_allocs0;
+
+   public:
+    std::string name;
+    std::vector<double> samples;  // microseconds per operation
+    uint64_t ops;
+    uint64_t allocs;
+    uint64_t bytes;
+    uint64_t gmp_allocs;
+
+    bench(const std::string& n) : name(n), ops(0), allocs(0), bytes(0), gmp_allocs(0) {}
+
+    void start() {
+        _allocs0 = alloc_count;
+        _bytes0 = alloc_bytes;
+        _gmp_allocs0 = gmp_alloc_count;
+        _t0 = clock::now();
+    }
+
+    void stop(int n = 1) {
+        auto t1 = clock::now();
+        allocs += alloc_count - _allocs0;
+        bytes += alloc_bytes - _bytes0;
+        gmp_allocs += gmp_alloc_count - _gmp_allocs0;
+        ops += n;
+        samples.push_back(std::chrono::duration<double, std::micro>(t1 - _t0).count() / n);
+    }
+
+    void finish() {
+        std::sort(samples.begin(), samples.end());
+    }
+
+    // nearest-rank percentile, valid after finish()
+    double percentile(double p) {
+        if (samples.empty())
+            return 0;
+        auto rank = (size_t)std::ceil(p / 100.0 * samples.size());
+        return samples[rank ? rank - 1 : 0];
+    }
+
+    void write_json(std::ostream& os) {
+        double sum = 0;
+        for (auto s : samples)
+            sum += s;
+        auto n = ops ? ops : 1;
+        os << "{\"name\":\"" << name << "\""
+           << ",\"samples\":" << samples.size()
+           << ",\"ops\":" << ops
+           << ",\"min_us\":" << (samples.empty() ? 0 : samples.front())
+           << ",\"median_us\":" << percentile(50)
+           << ",\"p90_us\":" << percentile(90)
+           << ",\"p99_us\":" << percentile(99)
+           << ",\"max_us\":" << (samples.empty() ? 0 : samples.back())
+           << ",\"mean_us\":" << (samples.empty() ? 0 : sum / samples.size())
+           << ",\"allocs_per_op\":" << (double)allocs / n
+           << ",\"alloc_bytes_per_op\":" << (double)bytes / n
+           << ",\"gmp_allocs_per_op\":" << (double)gmp_allocs / n
+           << "}";
+    }
+};
+
+static int iterations = 10;
+static const char* profile = "standard";
+static std::vector<std::string> selected;
+static std::vector<std::unique_ptr<bench>> results;
+
+static bool enabled(const std::string& stage) {
+    return selected.empty() || std::find(selected.begin(), selected.end(), stage) != selected.end();
+}
+
+static bench& new_bench(const std::string& name) {
+    results.push_back(std::unique_ptr<bench>(new bench(name)));
+    return *results.back();
+}
+
+#define check(expr)                                                             \
+    {                                                                           \
+        game_error _res = (expr);                                               \
+        if (_res) {                                                             \
+            std::cerr << "*** " #expr " failed with " << _res << std::endl;    \
+            exit(-1);                                                           \
+        }                                                                       \
+    }
+
+// Alice and Bob after the key generation protocol, ready to shuffle
+struct session {
+    participant alice;
+    participant bob;
+    blob group;
+    blob alice_key;
+
+    session() : alice(false, profile), bob(false, profile) {
+        alice.init(ALICE, 2, false);
+        bob.init(BOB, 2, false);
+        check(alice.create_group(group));
+        check(bob.load_group(group));
+        blob bob_key;
+        check(alice.generate_key(alice_key));
+        check(bob.generate_key(bob_key));
+        check(alice.load_their_key(bob_key));
+        check(bob.load_their_key(alice_key));
+        check(alice.finalize_key_generation());
+        check(bob.finalize_key_generation());
+    }
+};
+
+static void bench_group_and_keys(session& s) {
+    if (enabled("create_group")) {
+        auto& b = new_bench("create_group");
+        for (int i = 0; i < iterations; i++) {
+            participant p(false, profile);
+            p.init(ALICE, 2, false);
+            blob group;
+            b.start();
+            check(p.create_group(group));
+            b.stop();
+        }
+    }
+
+    if (enabled("generate_key")) {
+        auto& b = new_bench("generate_key");
+        for (int i = 0; i < iterations; i++) {
+            participant p(false, profile);
+            p.init(BOB, 2, false);
+            blob group(s.group);
+            check(p.load_group(group));
+            blob key;
+            b.start();
+            check(p.generate_key(key));
+            b.stop();
+        }
+    }
+
+    if (enabled("create_vsshe_group")) {
+        auto& b = new_bench("create_vsshe_group");
+        for (int i = 0; i < iterations; i++) {
+            participant p(false, profile);
+            p.init(BOB, 2, false);
+            blob key, vsshe;
+            blob group(s.group), alice_key(s.alice_key);
+            check(p.load_group(group));
+            check(p.generate_key(key));
+            check(p.load_their_key(alice_key));
+            check(p.finalize_key_generation());
+            b.start();
+            check(p.create_vsshe_group(vsshe));
+            b.stop();
+        }
+    }
+}
+
+static void bench_stack_and_cards(session& s) {
+    if (!enabled("shuffle_stack") && !enabled("load_stack") &&
+        !enabled("prove_card_secret") && !enabled("verify_card_secret"))
+        return;
+
+    blob vsshe;
+    check(s.alice.create_vsshe_group(vsshe));
+    check(s.bob.load_vsshe_group(vsshe));
+    check(s.alice.create_stack());
+    check(s.bob.create_stack());
+
+    // Alice keeps shuffling, Bob verifies and follows every shuffle
+    auto& shuffle = new_bench("shuffle_stack");
+    auto& load = new_bench("load_stack");
+    for (int i = 0; i < iterations; i++) {
+        blob stack, proof;
+        shuffle.start();
+        check(s.alice.shuffle_stack(stack, proof));
+        shuffle.stop();
+        load.start();
+        check(s.bob.load_stack(stack, proof));
+        load.stop();
+    }
+
+    check(s.alice.take_cards_from_stack(NUM_CARDS));
+    check(s.bob.take_cards_from_stack(NUM_CARDS));
+
+    auto& prove = new_bench("prove_card_secret");
+    auto& verify = new_bench("verify_card_secret");
+    for (int i = 0; i < iterations; i++) {
+        blob proof;
+        auto card_index = i % NUM_CARDS;
+        prove.start();
+        check(s.alice.prove_card_secret(card_index, proof));
+        prove.stop();
+        verify.start();
+        check(s.bob.verify_card_secret(card_index, proof));
+        verify.stop();
+    }
+}
+
+static void bench_messages(game_generator& gen) {
+    // the VSSHE message carries the group, a stack and its proof: the largest one
+    auto& wrapped = std::get<1>(gen.turns[2]);
+    std::string raw;
+    check(unwrap_and_decompress(wrapped, raw));
+
+    if (enabled("compress") || enabled("decompress")) {
+        auto& c = new_bench("compress");
+        auto& d = new_bench("decompress");
+        std::string compressed, decompressed;
+        for (int i = 0; i < iterations; i++) {
+            c.start();
+            check(compress(raw, compressed));
+            c.stop();
+            d.start();
+            check(decompress(compressed, decompressed));
+            d.stop();
+        }
+    }
+
+    if (enabled("encoder") || enabled("decoder")) {
+        auto& e = new_bench("encoder");
+        auto& d = new_bench("decoder");
+        for (int i = 0; i < iterations; i++) {
+            std::istringstream is(raw);
+            message* msg;
+            d.start();
+            check(message::decode(is, &msg));
+            d.stop();
+            std::unique_ptr<message> m(msg);
+            std::ostringstream os;
+            e.start();
+            check(m->write(os));
+            e.stop();
+        }
+    }
+}
+
+static void bench_solver() {
+    if (!enabled("compare_hands"))
+        return;
+
+    const int batch = 1000;
+    std::mt19937 rng(1);
+    std::vector<card_t> hands(batch * 14);
+    for (int i = 0; i < batch; i++) {
+        card_t deck[DECK_SIZE];
+        for (int c = 0; c < DECK_SIZE; c++)
+            deck[c] = c;
+        std::shuffle(deck, deck + DECK_SIZE, rng);
+        // two hands sharing the five public cards
+        for (int c = 0; c < 5; c++)
+            hands[i * 14 + c] = hands[i * 14 + 7 + c] = deck[c];
+        hands[i * 14 + 5] = deck[5];
+        hands[i * 14 + 6] = deck[6];
+        hands[i * 14 + 12] = deck[7];
+        hands[i * 14 + 13] = deck[8];
+    }
+
+    solver s;
+    auto& b = new_bench("compare_hands");
+    for (int i = 0; i < iterations; i++) {
+        int result;
+        b.start();
+        for (int h = 0; h < batch; h++)
+            check(s.compare_hands(&hands[h * 14], &hands[h * 14 + 7], 7, &result));
+        b.stop(batch);
+    }
+}
+
+static void bench_solver_batch() {
+    if (!enabled("compare_batch"))
+        return;
+
+    // large enough to be spread over all cores
+    const int batch = 1 << 20;
+    std::mt19937 rng(1);
+    std::vector<card_t> hands1(batch * HAND_SIZE), hands2(batch * HAND_SIZE);
+    for (int i = 0; i < batch; i++) {
+        card_t deck[DECK_SIZE];
+        for (int c = 0; c < DECK_SIZE; c++)
+            deck[c] = c;
+        std::shuffle(deck, deck + DECK_SIZE, rng);
+        for (int c = 0; c < HAND_SIZE; c++) {
+            hands1[i * HAND_SIZE + c] = deck[c];
+            hands2[i * HAND_SIZE + c] = c < NUM_PUBLIC_CARDS ? deck[c] : deck[c + NUM_PRIVATE_CARDS];
+        }
+    }
+
+    solver s;
+    std::vector<int> results(batch);
+    auto& b = new_bench("compare_batch");
+    for (int i = 0; i < iterations; i++) {
+        b.start();
+        check(s.compare_batch(hands1.data(), hands2.data(), batch, results.data()));
+        b.stop(batch);
+    }
+}
+
+static void bench_playback(game_generator& gen) {
+    if (!enabled("game_playback"))
+        return;
+
+    auto& b = new_bench("game_playback");
+    for (int i = 0; i < iterations; i++) {
+        std::istringstream is(gen.raw_turn_data);
+        game_playback vcr;
+        b.start();
+        check(vcr.playback(is));
+        b.stop();
+    }
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            iterations = std::stoi(argv[++i]);
+        } else if (arg == "-p" && i + 1 < argc && find_tmcg_profile(argv[i + 1])) {
+            profile = argv[++i];
+        } else if (arg[0] == '-') {
+            fprintf(stderr, "Usage: %s [-n <iterations>] [-p <tmcg profile>] [<stage>...]\nprofiles:", argv[0]);
+            for (int p = 0; p < num_tmcg_profiles; p++)
+                fprintf(stderr, " %s", tmcg_profiles[p].name);
+            fprintf(stderr, "\n");
+            exit(-1);
+        } else {
+            selected.push_back(arg);
+        }
+    }
+
+    init_poker_lib();
+    count_gmp_allocations();
+
+    if (enabled("create_group") || enabled("generate_key") || enabled("create_vsshe_group") ||
+        enabled("shuffle_stack") || enabled("load_stack") ||
+        enabled("prove_card_secret") || enabled("verify_card_secret")) {
+        session s;
+        bench_group_and_keys(s);
+        bench_stack_and_cards(s);
+    }
+
+    if (enabled("compress") || enabled("decompress") || enabled("encoder") ||
+        enabled("decoder") || enabled("game_playback")) {
+        game_generator gen;
+        check(gen.generate());
+        bench_messages(gen);
+        bench_playback(gen);
+    }
+
+    bench_solver();
+    bench_solver_batch();
+
+    // stages measured together (e.g. shuffle_stack and load_stack) are
+    // only reported when selected
+    results.erase(std::remove_if(results.begin(), results.end(),
+                                 [](const std::unique_ptr<bench>& r) { return !enabled(r->name); }),
+                  results.end());
+    for (auto& r : results)
+        r->finish();
+
+    std::cout << "{\"iterations\":" << iterations << ",\"profile\":\"" << profile << "\",\"benchmarks\":[";
+    for (size_t i = 0; i < results.size(); i++) {
+        if (i)
+            std::cout << ",";
+        results[i]->write_json(std::cout);
+    }
+    std::cout << "]}" << std::endl;
+
+    for (auto& r : results)
+        fprintf(stderr, "%-20s median %12.1f us  p90 %12.1f us  allocs/op %10.1f  gmp allocs/op %10.1f\n",
+                r->name.c_str(), r->percentile(50), r->percentile(90),
+                (double)r->allocs / (r->ops ? r->ops : 1),
+                (double)r->gmp_allocs / (r->ops ? r->ops : 1));
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include <memory.h>
+#include <cstring>
 #include "bignumber.h"
 #include <iostream>
 
@@ -11,6 +12,14 @@ std::string bignumber::to_string(int base)  const{
     return s;
 }
 
+void bignumber::append_string(std::string& out, int base) const {
+    auto pos = out.size();
+    // sizeinbase may be one too large; room for the sign and the terminator
+    out.resize(pos + mpz_sizeinbase(n, base) + 2);
+    mpz_get_str(&out[pos], base, n);
+    out.resize(pos + strlen(&out[pos]));
+}
+
 game_error bignumber::parse_string(const char* s, int base) {
     if (mpz_set_str(n, s, base))
         return BIG_UNPARSEABLE;
@@ -67,6 +76,17 @@ game_error bignumber::write_binary_be(std::ostream& out, int len) {
     return res;
 }
 
+game_error bignumber::get_uint64(uint64_t& v) const {
+    if (mpz_sgn(n) < 0 || mpz_sizeinbase(n, 2) > 64)
+        return BIG_OUT_OF_RANGE;
+    v = 0;
+    mpz_export(&v, NULL, -1, sizeof(v), 0, 0, n);
+    return SUCCESS;
+}
+
+void bignumber::set_uint64(uint64_t v) {
+    mpz_import(n, 1, -1, sizeof(v), 0, 0, &v);
+}
 
 std::ostream& operator << (std::ostream &out, const bignumber& v) {
     auto tmp = v.to_string();
@@ -1,6 +1,7 @@
 #ifndef BIGNUMBER_H
 #define BIGNUMBER_H
 
+#include <cstdint>
 #include <ostream>
 #include <gmp.h>
 #include <string>
@@ -81,11 +82,16 @@ public:
     }
     
     std::string to_string(int base=10) const;
+    // Appends the digits to out, without a temporary string
+    void append_string(std::string& out, int base=10) const;
     game_error parse_string(const char* s, int base=10);
     void load_binary_be(char* data, int len);
     void store_binary_be(char* data, int len);
     game_error read_binary_be(std::istream& in, int len);
     game_error write_binary_be(std::ostream& out, int len);
+    // BIG_OUT_OF_RANGE unless 0 <= value < 2^64
+    game_error get_uint64(uint64_t& v) const;
+    void set_uint64(uint64_t v);
     
 };
 
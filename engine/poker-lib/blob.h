@@ -42,6 +42,22 @@ public:
   blob& operator = (const blob& rhs);
 };
 
+/*
+ *  Read-only stream over memory owned by the caller
+*/
+class memory_istream : public std::istream {
+  struct view_buf : public std::streambuf {
+    view_buf(const char* data, size_t len) {
+      char* p = const_cast<char*>(data);
+      setg(p, p, p + len);
+    }
+  };
+  view_buf _view;
+
+public:
+  memory_istream(const char* data, size_t len) : std::istream(&_view), _view(data, len) {}
+};
+
 }
 
 #endif
\ No newline at end of file
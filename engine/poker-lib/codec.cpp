@@ -51,11 +51,9 @@ game_error encoder::write(const char* v, int len, char pfx) {
     auto s = ss.str();
     _out << s;
     if (len) {
-        for(int i=0; i<len; i++) {
-            _out.write(v+i, 1);
-            if (!_out.good())
-                return COD_ERROR;
-        }
+        _out.write(v, len);
+        if (!_out.good())
+            return COD_ERROR;
     }
     _written += len + s.size();
     return SUCCESS;
@@ -86,7 +84,10 @@ game_error decoder::read(int& v) {
 }
 
 game_error decoder::read(bool& v) {
-    return read((int&)v);
+    int temp;
+    game_error res = read(temp);
+    if (!res) v = temp != 0;
+    return res;
 }
 
 game_error decoder::read(message_type& v) {
@@ -119,12 +120,10 @@ game_error decoder::read(std::string &v, char expected_pfx) {
     _in >> len;
     if (_in.get() != separator) return COD_ERROR;
     if (!_in.good()) return COD_ERROR;
-    if (len) {
-        v.resize(len);
-        for(int i=0; i<len && _in.good(); i++) {
-            v[i] = _in.get();
-        }
-    }
+    if (len < 0 || len > max_string_len) return COD_ERROR;
+    v.resize(len);
+    if (len)
+        _in.read(&v[0], len);
     return _in.good() ? SUCCESS : COD_ERROR;
 }
 
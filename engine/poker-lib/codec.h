@@ -9,6 +9,10 @@
 
 namespace poker {
 
+// Longest string the decoder accepts. Far above any message or checkpoint,
+// it keeps a corrupt length from forcing a huge allocation
+const int max_string_len = 16 * 1024 * 1024;
+
 enum message_type {
     MSG_VTMF,
     MSG_VTMF_RESPONSE,
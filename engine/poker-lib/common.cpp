@@ -4,8 +4,6 @@
 
 namespace poker {
 
-bool logging_enabled = false;
-
 game_error public_cards_range(game_step step, int& first_card_index, int& card_count) {
     switch(step) {
         case OPEN_FLOP:
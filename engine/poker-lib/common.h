@@ -4,12 +4,12 @@
 #include <iostream>
 
 #include "cards.h"
+#include "log.h"
 
 namespace poker {
 
-extern bool logging_enabled;
-
-#define logger if(!logging_enabled) {} else std::cerr
+// Debug level log line (see log.h)
+#define logger logger_at(poker::LOG_DEBUG)
 
 const int NONE = -1;
 const int ALICE = 0;
@@ -109,10 +109,13 @@ enum game_error {
     PRR_ALICE_MONEY_DIVERGES,
     PRR_BOB_MONEY_DIVERGES,
     PRR_BIG_BLIND_DIVERGES,
+    PRR_SAVE_VERSION_MISMATCH,
+    PRR_SAVE_BACKEND_MISMATCH,
 
     // solver errors
     SRR_UNKNOWN_CARD = 300,
     SRR_DUPLICATE_CARD,
+    SRR_INVALID_CARD_COUNT,
 
     // game_state errors
     GRR_INVALID_PLAYER = 400,
@@ -142,6 +145,8 @@ enum game_error {
     TMC_VERIFYCARDSECRET,
     TMC_INVALID_CARD_INDEX,
     TMC_PROVE_CARD,
+    TMC_UNKNOWN_PROFILE,
+    TMC_PROFILE_REJECTED,
 
     // Verifier
     PLB_UNKNOWN_MSG_TYPE = 700,
@@ -153,6 +158,7 @@ enum game_error {
     VRF_OPEN_ALICE_PRIVATE_CARDS,
     VRF_OPEN_BOB_PRIVATE_CARDS,
     VRF_EOF,
+    VRF_VERIFY_ONLY,
 
     // Big number
     BIG_UNPARSEABLE = 800,
@@ -160,6 +166,7 @@ enum game_error {
     VRF_INVALID_PLAYER_COUNT,
     BIG_WRITE_ERROR,
     VRF_PLAYER_ADDRESS_NOT_FOUND,
+    BIG_OUT_OF_RANGE,
 
     // Compression
     CPR_COMPRESS_INIT = 900,
@@ -178,6 +185,29 @@ enum game_error {
     PLB_CURRENT_PLAYER_MISMATCH,
     PLB_OPEN_ALICE_PRIVATE_CARDS,
     PLB_OPEN_BOB_PRIVATE_CARDS,
+
+    // library configuration
+    CFG_INVALID_LOG_LEVEL = 1100,
+
+    // preflop equity table
+    PEQ_OPEN_TABLE = 1200,
+    PEQ_INVALID_TABLE,
+    PEQ_TABLE_NOT_LOADED,
+
+    // C API
+    API_BUFFER_TOO_SMALL = 1300,
+
+    // Game snapshot
+    SNP_INVALID_SNAPSHOT = 1400,
+
+    // Table manager
+    TBL_UNKNOWN_TABLE = 1500,
+    TBL_CALL_FAILED,
+
+    // Elliptic curve participant
+    ECC_INVALID_GROUP = 1600,
+    ECC_INVALID_POINT,
+    ECC_INVALID_SCALAR,
 };
 
 constexpr int private_card_index(int player, int card) {
@@ -1,129 +1,155 @@
-#include <vector>
+#include <cstring>
 #include <sstream>
 #include <brotli/decode.h>
+#ifndef POKER_VERIFY_ONLY
 #include <brotli/encode.h>
+#endif
 
 #include "compression.h"
+#include "trace.h"
 
 namespace poker {
 
-static BROTLI_BOOL compress_stream(BrotliEncoderState* enc, BrotliEncoderOperation op, std::vector<uint8_t>* output, uint8_t* input, size_t input_length);
-static BROTLI_BOOL decompress_stream(BrotliDecoderState* dec, std::vector<uint8_t>* output, uint8_t* input, size_t input_length);
+#ifndef POKER_VERIFY_ONLY
+static BROTLI_BOOL compress_stream(BrotliEncoderState* enc, BrotliEncoderOperation op, std::string* output, const uint8_t* input, size_t input_length);
+#endif
+static BROTLI_BOOL decompress_stream(BrotliDecoderState* dec, std::string* output, const uint8_t* input, size_t input_length);
 
 struct wrap_header {
   int32_t total_len;
   int32_t data_len;
 };
 
-std::string wrap(const std::string& data) {
-    wrap_header hdr;
-
-    hdr.data_len = data.size();
-    hdr.total_len = sizeof(hdr) + hdr.data_len;
-
-    auto pads = 0;
+static int wrap_padding(const wrap_header& hdr) {
     auto mod = hdr.total_len % wrap_padding_size;
-    if (mod != 0)
-      pads += (wrap_padding_size - mod);;    
-    hdr.total_len += pads;
+    return mod ? wrap_padding_size - mod : 0;
+}
 
-    std::ostringstream os;
-    os.write((const char*)&hdr, sizeof(hdr));
-    os.write(data.data(), data.size());
-    for(; pads; pads--)
-      os.write("\0", 1);
+// Fills in the header reserved at the start of out and pads the result
+static void finish_wrap(std::string& out) {
+    wrap_header hdr;
+    hdr.data_len = out.size() - sizeof(hdr);
+    hdr.total_len = out.size();
+    auto pads = wrap_padding(hdr);
+    hdr.total_len += pads;
+    memcpy(&out[0], &hdr, sizeof(hdr));
+    out.append(pads, '\0');
+}
 
-    return os.str();
+std::string wrap(const std::string& data) {
+    std::string out(sizeof(wrap_header), '\0');
+    out.append(data);
+    finish_wrap(out);
+    return out;
 }
 
-game_error unwrap(const std::string& in, std::string& out) {
+game_error unwrap(const char* in, size_t in_len, const char** data, size_t* data_len) {
     wrap_header hdr;
 
-    if (in.size() < sizeof(wrap_header))
+    if (in_len < sizeof(wrap_header))
         return CPR_INVALID_DATA_LENGTH;
 
-    std::istringstream is(in);
-    is.read((char*)&hdr, sizeof(hdr));
-    if (!is.good())
-        return CPR_READ_ERROR;
+    memcpy(&hdr, in, sizeof(hdr));
 
     if (hdr.data_len > wrap_max_len)
       return CPR_DATA_TOO_BIG;
 
-    if (in.size() < sizeof(hdr) + hdr.data_len)
+    if (hdr.data_len < 0 || in_len < sizeof(hdr) + hdr.data_len)
       return CPR_INSUFFICIENT_DATA;
-    
-    out = in.substr(sizeof(hdr), hdr.data_len);
 
+    *data = in + sizeof(hdr);
+    *data_len = hdr.data_len;
     return SUCCESS;
 }
 
-game_error compress(const std::string& in, std::string &out) {
-    std::vector<uint8_t> output;
-    
+game_error unwrap(const std::string& in, std::string& out) {
+    game_error res;
+    const char* data;
+    size_t data_len;
+    if ((res = unwrap(in.data(), in.size(), &data, &data_len)))
+        return res;
+    out.assign(data, data_len);
+    return SUCCESS;
+}
+
+// The verify-only library decompresses only, without Brotli's encoder
+#ifndef POKER_VERIFY_ONLY
+// Appends the compressed input to out
+static game_error compress_append(const char* in, size_t in_len, std::string &out) {
     BrotliEncoderState* enc = BrotliEncoderCreateInstance(0, 0, 0);
     if (!enc)
         return CPR_COMPRESS_INIT;
 
-    auto in_size = in.size();
-    auto ok = compress_stream(enc, BROTLI_OPERATION_PROCESS, &output, (uint8_t*)in.data(), in.size());
-    if (ok != BROTLI_TRUE)
-        return CPR_COMPRESS;
-
-    ok = compress_stream(enc, BROTLI_OPERATION_FLUSH, &output, NULL, 0);
-    if (ok != BROTLI_TRUE)
-        return CPR_COMPRESS_FLUSH;
+    game_error res = SUCCESS;
+    if (compress_stream(enc, BROTLI_OPERATION_PROCESS, &out, (const uint8_t*)in, in_len) != BROTLI_TRUE)
+        res = CPR_COMPRESS;
+    else if (compress_stream(enc, BROTLI_OPERATION_FLUSH, &out, NULL, 0) != BROTLI_TRUE)
+        res = CPR_COMPRESS_FLUSH;
 
     BrotliEncoderDestroyInstance(enc);
+    return res;
+}
 
-    out = std::string(output.begin(), output.end());
-    //logger << "## --> compressed " << in_size << " -> " << out.size() << std::endl;
+game_error compress(const char* in, size_t in_len, std::string &out) {
+    TRACE_FUNC("compression");
+    out.clear();
+    return compress_append(in, in_len, out);
+}
 
-    return SUCCESS; 
+game_error compress(const std::string& in, std::string &out) {
+    return compress(in.data(), in.size(), out);
 }
+#endif
 
-game_error decompress(const std::string& in, std::string &out) {
-    std::vector<uint8_t> output;
-    
+game_error decompress(const char* in, size_t in_len, std::string &out) {
+    TRACE_FUNC("compression");
     BrotliDecoderState* dec = BrotliDecoderCreateInstance(0, 0, 0);
     if (!dec)
         return CPR_DECOMPRESS_INIT;
 
-    auto ok = decompress_stream(dec, &output, (uint8_t*)in.data(), in.size());
+    out.clear();
+    auto ok = decompress_stream(dec, &out, (const uint8_t*)in, in_len);
+    BrotliDecoderDestroyInstance(dec);
     if (ok != BROTLI_TRUE)
         return CPR_DECOMPRESS;
 
-    BrotliDecoderDestroyInstance(dec);
+    return SUCCESS;
+}
 
-    out = std::string(output.begin(), output.end());
-    // logger << "## --< decompressed " << in.size() << " -> " << out.size() << std::endl;
-    
-    return SUCCESS; 
+game_error decompress(const std::string& in, std::string &out) {
+    return decompress(in.data(), in.size(), out);
 }
 
+#ifndef POKER_VERIFY_ONLY
 game_error compress_and_wrap(const std::string& in, std::string &out) {
+    TRACE_FUNC("compression");
     game_error res;
-    std::string compressed;
+    out.assign(sizeof(wrap_header), '\0');
     if (in.size())
-        if ((res=compress(in, compressed)))
+        if ((res=compress_append(in.data(), in.size(), out)))
             return res;
-    out = wrap(compressed);
+    finish_wrap(out);
     return SUCCESS;
 }
+#endif
 
-game_error unwrap_and_decompress(const std::string& in, std::string &out) {
+game_error unwrap_and_decompress(const char* in, size_t in_len, std::string &out) {
+    TRACE_FUNC("compression");
     game_error res;
-
-    std::string compressed;
-    if ((res=unwrap(in, compressed)))
+    const char* compressed;
+    size_t compressed_len;
+    if ((res=unwrap(in, in_len, &compressed, &compressed_len)))
         return res;
 
-    if (!compressed.size())
-        out = compressed;
-    else
-        if ((res=decompress(compressed, out)))
-            return res;
-    return SUCCESS;
+    if (!compressed_len) {
+        out.clear();
+        return SUCCESS;
+    }
+    return decompress(compressed, compressed_len, out);
+}
+
+game_error unwrap_and_decompress(const std::string& in, std::string &out) {
+    return unwrap_and_decompress(in.data(), in.size(), out);
 }
 
 game_error unwrap_next(std::istream& in, std::string& out) {
@@ -158,7 +184,8 @@ game_error unwrap_and_decompress_next(std::istream& is, std::string &out) {
     return decompress(compressed, out);
 }
 
-static BROTLI_BOOL compress_stream(BrotliEncoderState* enc, BrotliEncoderOperation op, std::vector<uint8_t>* output, uint8_t* input, size_t input_length) {
+#ifndef POKER_VERIFY_ONLY
+static BROTLI_BOOL compress_stream(BrotliEncoderState* enc, BrotliEncoderOperation op, std::string* output, const uint8_t* input, size_t input_length) {
   BROTLI_BOOL ok = BROTLI_TRUE;
 
   size_t available_in = input_length;
@@ -176,7 +203,7 @@ static BROTLI_BOOL compress_stream(BrotliEncoderState* enc, BrotliEncoderOperati
     size_t buffer_length = 0; // Request all available output.
     const uint8_t* buffer = BrotliEncoderTakeOutput(enc, &buffer_length);
     if (buffer_length) {
-      (*output).insert((*output).end(), buffer, buffer + buffer_length);
+      output->append((const char*)buffer, buffer_length);
     }
 
     if (available_in || BrotliEncoderHasMoreOutput(enc)) {
@@ -187,8 +214,9 @@ static BROTLI_BOOL compress_stream(BrotliEncoderState* enc, BrotliEncoderOperati
   }
   return ok;
 }
+#endif
 
-static BROTLI_BOOL decompress_stream(BrotliDecoderState* dec, std::vector<uint8_t>* output, uint8_t* input, size_t input_length) {
+static BROTLI_BOOL decompress_stream(BrotliDecoderState* dec, std::string* output, const uint8_t* input, size_t input_length) {
   BROTLI_BOOL ok = BROTLI_TRUE;
   size_t available_in = input_length;
   const uint8_t* next_in = input;
@@ -203,7 +231,7 @@ static BROTLI_BOOL decompress_stream(BrotliDecoderState* dec, std::vector<uint8_
     size_t buffer_length = 0; // Request all available output.
     const uint8_t* buffer = BrotliDecoderTakeOutput(dec, &buffer_length);
     if (buffer_length) {
-      (*output).insert((*output).end(), buffer, buffer + buffer_length);
+      output->append((const char*)buffer, buffer_length);
     }
   }
   ok = result != BROTLI_DECODER_RESULT_ERROR && !available_in;
@@ -10,12 +10,22 @@ const int wrap_padding_size = 4096;
 
 std::string wrap(const std::string& data);
 game_error unwrap(const std::string& in, std::string& out);
+// Locates the payload inside in, without copying it
+game_error unwrap(const char* in, size_t in_len, const char** data, size_t* data_len);
 
+// Output is written directly into out, reusing its capacity
+#ifndef POKER_VERIFY_ONLY
 game_error compress(const std::string& in, std::string &out);
+game_error compress(const char* in, size_t in_len, std::string &out);
+#endif
 game_error decompress(const std::string& in, std::string &out);
+game_error decompress(const char* in, size_t in_len, std::string &out);
 
+#ifndef POKER_VERIFY_ONLY
 game_error compress_and_wrap(const std::string& in, std::string &out);
+#endif
 game_error unwrap_and_decompress(const std::string& in, std::string &out);
+game_error unwrap_and_decompress(const char* in, size_t in_len, std::string &out);
 
 game_error unwrap_next(std::istream& in, std::string& out);
 game_error unwrap_and_decompress_next(std::istream& is, std::string &out);
@@ -0,0 +1,142 @@
+#include "drbg.h"
+
+#include <gcrypt.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace poker {
+
+static inline uint32_t rotl(uint32_t v, int n) {
+    return (v << n) | (v >> (32 - n));
+}
+
+static inline void quarter_round(uint32_t* x, int a, int b, int c, int d) {
+    x[a] += x[b];
+    x[d] = rotl(x[d] ^ x[a], 16);
+    x[c] += x[d];
+    x[b] = rotl(x[b] ^ x[c], 12);
+    x[a] += x[b];
+    x[d] = rotl(x[d] ^ x[a], 8);
+    x[c] += x[d];
+    x[b] = rotl(x[b] ^ x[c], 7);
+}
+
+static inline uint32_t load32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void store32(unsigned char* p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+void chacha20_block(const uint32_t key[8], uint32_t counter, const uint32_t nonce[3], unsigned char out[64]) {
+    uint32_t state[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+    for (int i = 0; i < 8; i++)
+        state[4 + i] = key[i];
+    state[12] = counter;
+    for (int i = 0; i < 3; i++)
+        state[13 + i] = nonce[i];
+
+    uint32_t x[16];
+    memcpy(x, state, sizeof(x));
+    for (int i = 0; i < 10; i++) {
+        quarter_round(x, 0, 4, 8, 12);
+        quarter_round(x, 1, 5, 9, 13);
+        quarter_round(x, 2, 6, 10, 14);
+        quarter_round(x, 3, 7, 11, 15);
+        quarter_round(x, 0, 5, 10, 15);
+        quarter_round(x, 1, 6, 11, 12);
+        quarter_round(x, 2, 7, 8, 13);
+        quarter_round(x, 3, 4, 9, 14);
+    }
+    for (int i = 0; i < 16; i++)
+        store32(out + 4 * i, x[i] + state[i]);
+}
+
+void hash_chain(unsigned char chain[DRBG_SEED_SIZE], const void* data, size_t len) {
+    gcry_md_hd_t md;
+    gcry_md_open(&md, GCRY_MD_SHA256, 0);
+    gcry_md_write(md, chain, DRBG_SEED_SIZE);
+    gcry_md_write(md, data, len);
+    memcpy(chain, gcry_md_read(md, GCRY_MD_SHA256), DRBG_SEED_SIZE);
+    gcry_md_close(md);
+}
+
+/*
+ * chacha20_drbg
+*/
+
+chacha20_drbg::chacha20_drbg() : _position(0) {
+    unsigned char zero[DRBG_SEED_SIZE] = {0};
+    seed(zero);
+}
+
+void chacha20_drbg::seed(const unsigned char seed[DRBG_SEED_SIZE]) {
+    for (int i = 0; i < 8; i++)
+        _key[i] = load32(seed + 4 * i);
+    seek(0);
+}
+
+// 64-bit block counter: the low word in the counter, the high word in the nonce
+void chacha20_drbg::load_block() {
+    uint64_t block = _position / sizeof(_block);
+    uint32_t nonce[3] = {(uint32_t)(block >> 32), 0, 0};
+    chacha20_block(_key, (uint32_t)block, nonce, _block);
+}
+
+void chacha20_drbg::seek(uint64_t position) {
+    _position = position;
+    load_block();
+}
+
+void chacha20_drbg::generate(unsigned char* buf, size_t len, int /*level*/) {
+    while (len) {
+        size_t offset = _position % sizeof(_block);
+        size_t n = std::min(len, sizeof(_block) - offset);
+        memcpy(buf, _block + offset, n);
+        buf += n;
+        len -= n;
+        _position += n;
+        if (_position % sizeof(_block) == 0)
+            load_block();
+    }
+}
+
+/*
+ * buffered_csprng
+*/
+
+buffered_csprng::buffered_csprng(fill_function fill, size_t batch_size) : _fill(fill), _buffer(batch_size), _available(0) {}
+
+buffered_csprng::~buffered_csprng() {
+    std::fill(_buffer.begin(), _buffer.end(), 0);
+}
+
+void buffered_csprng::generate(unsigned char* buf, size_t len, int level) {
+    if (level >= RANDOM_VERY_STRONG || len > _buffer.size()) {
+        _fill(buf, len, level);
+        return;
+    }
+#ifdef POKER_THREADS
+    std::unique_lock<std::mutex> lock(_mutex);
+#endif
+    while (len) {
+        if (!_available) {
+            _fill(_buffer.data(), _buffer.size(), RANDOM_STRONG);
+            _available = _buffer.size();
+        }
+        auto start = _buffer.data() + _buffer.size() - _available;
+        size_t n = std::min(len, _available);
+        memcpy(buf, start, n);
+        memset(start, 0, n);
+        buf += n;
+        len -= n;
+        _available -= n;
+    }
+}
+
+}  // namespace poker
@@ -0,0 +1,91 @@
+#ifndef DRBG_H
+#define DRBG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#ifdef POKER_THREADS
+#include <mutex>
+#endif
+
+namespace poker {
+
+// libgcrypt random levels (gcry_random_level)
+const int RANDOM_WEAK = 0;
+const int RANDOM_STRONG = 1;
+const int RANDOM_VERY_STRONG = 2;
+
+/*
+ * Source of random bytes for libTMCG, installed per participant
+*/
+class random_source {
+   public:
+    virtual ~random_source() {}
+    virtual void generate(unsigned char* buf, size_t len, int level) = 0;
+};
+
+const int DRBG_SEED_SIZE = 32;
+
+// Extends a SHA-256 hash chain with a message: chain = SHA-256(chain || data),
+// hashed in place without copying data
+void hash_chain(unsigned char chain[DRBG_SEED_SIZE], const void* data, size_t len);
+
+/*
+ * ChaCha20 block function (RFC 8439)
+*/
+void chacha20_block(const uint32_t key[8], uint32_t counter, const uint32_t nonce[3], unsigned char out[64]);
+
+/*
+ * Deterministic random bit generator: the ChaCha20 keystream of a 256-bit
+ * seed. The same seed yields the same bytes on every platform, whatever
+ * the levels and sizes of the requests
+*/
+class chacha20_drbg : public random_source {
+    uint32_t _key[8];
+    // bytes generated since seeding
+    uint64_t _position;
+    unsigned char _block[64];
+
+    void load_block();
+
+   public:
+    chacha20_drbg();
+
+    void seed(const unsigned char seed[DRBG_SEED_SIZE]);
+    void generate(unsigned char* buf, size_t len, int level) override;
+
+    // Position in the keystream, to continue a restored generator
+    uint64_t position() const { return _position; }
+    void seek(uint64_t position);
+};
+
+/*
+ * Strong random bytes taken from a buffer refilled in batches, so that
+ * the many small requests of a proof cost one call to the system
+ * generator. Very strong requests (private keys) bypass the buffer.
+ * Used bytes are wiped
+*/
+class buffered_csprng : public random_source {
+   public:
+    typedef std::function<void(unsigned char* buf, size_t len, int level)> fill_function;
+
+   private:
+    fill_function _fill;
+    std::vector<unsigned char> _buffer;
+    size_t _available;
+#ifdef POKER_THREADS
+    std::mutex _mutex;
+#endif
+
+   public:
+    buffered_csprng(fill_function fill, size_t batch_size = 4096);
+    virtual ~buffered_csprng();
+
+    void generate(unsigned char* buf, size_t len, int level) override;
+};
+
+}  // namespace poker
+
+#endif
@@ -0,0 +1,1100 @@
+#include "ec_participant.h"
+
+#include <gcrypt.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include "codec.h"
+#include "metrics.h"
+#include "service_locator.h"
+#include "trace.h"
+
+namespace poker {
+
+static const char* ec_curve = "Ed25519";
+static const char* ec_group_name = "ec-ed25519";
+static const size_t EC_POINT_SIZE = 32;
+static const size_t EC_SCALAR_SIZE = 32;
+// random game identifier of the group message, bound by the key proofs
+static const size_t EC_SESSION_SIZE = 32;
+
+static void system_random(unsigned char* buf, size_t len, int level) {
+    gcry_randomize(buf, len, (gcry_random_level)level);
+}
+
+/*
+ * Point of the curve, see ec_group::identity() for the neutral element
+*/
+class ec_point {
+    gcry_mpi_point_t _p;
+
+   public:
+    ec_point() : _p(gcry_mpi_point_new(0)) {}
+    ec_point(const ec_point& other) : _p(gcry_mpi_point_copy(other._p)) {}
+    ~ec_point() { gcry_mpi_point_release(_p); }
+
+    ec_point& operator=(const ec_point& other) {
+        if (this != &other)
+            reset(gcry_mpi_point_copy(other._p));
+        return *this;
+    }
+
+    gcry_mpi_point_t get() const { return _p; }
+    void reset(gcry_mpi_point_t p) {
+        gcry_mpi_point_release(_p);
+        _p = p;
+    }
+};
+
+/*
+ * Integer modulo the group order
+*/
+class ec_scalar {
+    gcry_mpi_t _v;
+
+   public:
+    ec_scalar() : _v(gcry_mpi_new(0)) {}
+    ec_scalar(const ec_scalar& other) : _v(gcry_mpi_copy(other._v)) {}
+    ~ec_scalar() { gcry_mpi_release(_v); }
+
+    ec_scalar& operator=(const ec_scalar& other) {
+        if (this != &other)
+            reset(gcry_mpi_copy(other._v));
+        return *this;
+    }
+
+    gcry_mpi_t get() const { return _v; }
+    void reset(gcry_mpi_t v) {
+        gcry_mpi_release(_v);
+        _v = v;
+    }
+};
+
+/*
+ * Operations of the prime order subgroup of Ed25519.
+ * A context is not thread safe: concurrent tasks use their own
+*/
+class ec_group {
+    gcry_ctx_t _ctx;
+    gcry_mpi_point_t _g;
+    gcry_mpi_t _n;
+    ec_point _identity;
+    // encodings of (type+1)*G
+    std::vector<std::string> _card_points;
+    std::vector<ec_point> _generators;
+
+    ec_scalar reduce(const unsigned char* data, size_t len) {
+        ec_scalar k;
+        gcry_mpi_t v;
+        gcry_mpi_scan(&v, GCRYMPI_FMT_USG, data, len, NULL);
+        gcry_mpi_mod(v, v, _n);
+        k.reset(v);
+        return k;
+    }
+
+   public:
+    ec_group() {
+        gcry_mpi_ec_new(&_ctx, NULL, ec_curve);
+        _g = gcry_mpi_ec_get_point("g", _ctx, 1);
+        _n = gcry_mpi_ec_get_mpi("n", _ctx, 1);
+        // decoded rather than built from its coordinates, which the Ed25519
+        // field arithmetic expects at full size
+        std::string identity(EC_POINT_SIZE, '\0');
+        identity[0] = 1;
+        decode(identity, _identity, false);
+    }
+    ~ec_group() {
+        gcry_mpi_point_release(_g);
+        gcry_mpi_release(_n);
+        gcry_ctx_release(_ctx);
+    }
+    ec_group(const ec_group&) = delete;
+    void operator=(const ec_group&) = delete;
+
+    const ec_point& identity() const { return _identity; }
+
+    ec_point mul_base(const ec_scalar& k) {
+        ec_point r;
+        gcry_mpi_ec_mul(r.get(), k.get(), _g, _ctx);
+        return r;
+    }
+
+    ec_point mul(const ec_scalar& k, const ec_point& p) {
+        ec_point r;
+        gcry_mpi_ec_mul(r.get(), k.get(), p.get(), _ctx);
+        return r;
+    }
+
+    ec_point add(const ec_point& p, const ec_point& q) {
+        ec_point r;
+        gcry_mpi_ec_add(r.get(), p.get(), q.get(), _ctx);
+        return r;
+    }
+
+    ec_point sub(const ec_point& p, const ec_point& q) {
+        ec_point r;
+        gcry_mpi_ec_sub(r.get(), p.get(), q.get(), _ctx);
+        return r;
+    }
+
+    bool has_x(const ec_point& p) {
+        gcry_mpi_t x = gcry_mpi_new(0);
+        bool nonzero = !gcry_mpi_ec_get_affine(x, NULL, p.get(), _ctx) && gcry_mpi_cmp_ui(x, 0);
+        gcry_mpi_release(x);
+        return nonzero;
+    }
+
+    bool is_identity(const ec_point& p) {
+        gcry_mpi_t x = gcry_mpi_new(0), y = gcry_mpi_new(0);
+        bool identity = !gcry_mpi_ec_get_affine(x, y, p.get(), _ctx) && !gcry_mpi_cmp_ui(x, 0) && !gcry_mpi_cmp_ui(y, 1);
+        gcry_mpi_release(x);
+        gcry_mpi_release(y);
+        return identity;
+    }
+
+    std::string encode(const ec_point& p) {
+        gcry_mpi_ec_set_point("q", p.get(), _ctx);
+        gcry_mpi_t q = gcry_mpi_ec_get_mpi("q@eddsa", _ctx, 1);
+        unsigned int nbits;
+        auto data = (const char*)gcry_mpi_get_opaque(q, &nbits);
+        std::string s(data, nbits / 8);
+        gcry_mpi_release(q);
+        return s;
+    }
+
+    // Accepts the canonical encodings of the points of the prime order
+    // subgroup only. Points encoded by us skip the checks. The subgroup
+    // check is a full multiplication by n, as costly as the rest of a
+    // proof step: values that only enter a proof as commitments skip it
+    bool decode(const std::string& s, ec_point& p, bool validate = true, bool subgroup = true) {
+        if (s.size() != EC_POINT_SIZE)
+            return false;
+        gcry_mpi_t q = gcry_mpi_set_opaque_copy(NULL, s.data(), s.size() * 8);
+        gcry_error_t err = gcry_mpi_ec_set_mpi("q", q, _ctx);
+        gcry_mpi_release(q);
+        if (err)
+            return false;
+        auto point = gcry_mpi_ec_get_point("q", _ctx, 1);
+        if (!point)
+            return false;
+        p.reset(point);
+        if (!validate)
+            return true;
+        // The decoding does not check that x exists. Points with x = 0
+        // are (0, 1) and (0, -1), on the curve, on which
+        // gcry_mpi_ec_curve_point() aborts. Both signs of x = 0 encode
+        // the identity, only one is canonical
+        if (encode(p) != s)
+            return false;
+        if (has_x(p) ? !gcry_mpi_ec_curve_point(point, _ctx) : (s[EC_POINT_SIZE - 1] & 0x80) != 0)
+            return false;
+        if (!subgroup)
+            return true;
+        ec_point o;
+        gcry_mpi_ec_mul(o.get(), _n, point, _ctx);
+        return is_identity(o);
+    }
+
+    std::string encode(const ec_scalar& k) {
+        unsigned char buf[EC_SCALAR_SIZE];
+        size_t len = 0;
+        gcry_mpi_print(GCRYMPI_FMT_USG, buf, sizeof(buf), &len, k.get());
+        std::string s(EC_SCALAR_SIZE - len, '\0');
+        s.append((const char*)buf, len);
+        return s;
+    }
+
+    bool decode(const std::string& s, ec_scalar& k) {
+        gcry_mpi_t v;
+        if (s.size() != EC_SCALAR_SIZE || gcry_mpi_scan(&v, GCRYMPI_FMT_USG, s.data(), s.size(), NULL))
+            return false;
+        k.reset(v);
+        return gcry_mpi_cmp(v, _n) < 0;
+    }
+
+    // 512 bits reduced modulo the order, a negligible bias
+    ec_scalar random_scalar(random_source* r, int level) {
+        unsigned char buf[64];
+        r->generate(buf, sizeof(buf), level);
+        ec_scalar k = reduce(buf, sizeof(buf));
+        memset(buf, 0, sizeof(buf));
+        return k;
+    }
+
+    ec_scalar hash_to_scalar(const std::string& data) {
+        unsigned char digest[64];
+        gcry_md_hash_buffer(GCRY_MD_SHA512, digest, data.data(), data.size());
+        return reduce(digest, sizeof(digest));
+    }
+
+    ec_scalar add(const ec_scalar& a, const ec_scalar& b) {
+        ec_scalar r;
+        gcry_mpi_addm(r.get(), a.get(), b.get(), _n);
+        return r;
+    }
+
+    ec_scalar mul(const ec_scalar& a, const ec_scalar& b) {
+        ec_scalar r;
+        gcry_mpi_mulm(r.get(), a.get(), b.get(), _n);
+        return r;
+    }
+
+    // a * b + c
+    ec_scalar mul_add(const ec_scalar& a, const ec_scalar& b, const ec_scalar& c) {
+        ec_scalar r;
+        gcry_mpi_mulm(r.get(), a.get(), b.get(), _n);
+        gcry_mpi_addm(r.get(), r.get(), c.get(), _n);
+        return r;
+    }
+
+    ec_scalar sub(const ec_scalar& a, const ec_scalar& b) {
+        ec_scalar r;
+        gcry_mpi_subm(r.get(), a.get(), b.get(), _n);
+        return r;
+    }
+
+    // H_0..H_DECK_SIZE of the shuffle proofs, with unknown discrete
+    // logarithms: hashes decoded as points, times the cofactor
+    const std::vector<ec_point>& generators() {
+        if (_generators.empty()) {
+            ec_scalar cofactor;
+            cofactor.reset(gcry_mpi_set_ui(NULL, 8));
+            for (int i = 0; _generators.size() <= DECK_SIZE; i++) {
+                std::string seed = "poker-ec-generator" + std::to_string(i), s(32, '\0');
+                gcry_md_hash_buffer(GCRY_MD_SHA256, &s[0], seed.data(), seed.size());
+                ec_point p;
+                if (!decode(s, p, false) || encode(p) != s || !has_x(p) || !gcry_mpi_ec_curve_point(p.get(), _ctx))
+                    continue;
+                p = mul(cofactor, p);
+                if (!is_identity(p))
+                    _generators.push_back(p);
+            }
+        }
+        return _generators;
+    }
+
+    ec_point card_point(size_t type) {
+        ec_scalar k;
+        k.reset(gcry_mpi_set_ui(NULL, type + 1));
+        return mul_base(k);
+    }
+
+    // DECK_SIZE if m is not a card
+    size_t card_type(const ec_point& m) {
+        if (_card_points.empty()) {
+            for (size_t type = 0; type < DECK_SIZE; type++)
+                _card_points.push_back(encode(card_point(type)));
+        }
+        auto s = encode(m);
+        for (size_t type = 0; type < DECK_SIZE; type++)
+            if (_card_points[type] == s)
+                return type;
+        return DECK_SIZE;
+    }
+};
+
+/*
+ * Stacks of ElGamal encryptions (c1, c2) = (r*G, m + r*h)
+*/
+
+struct point_card {
+    ec_point c1, c2;
+};
+
+typedef std::vector<point_card> point_stack;
+
+static std::string pack(const std::vector<ec_card>& cards) {
+    std::string s;
+    for (auto& c : cards)
+        s += c.c1 + c.c2;
+    return s;
+}
+
+static game_error unpack(ec_group& g, const std::string& data, std::vector<ec_card>& cards, point_stack& points) {
+    if (data.size() % (2 * EC_POINT_SIZE))
+        return ECC_INVALID_POINT;
+    cards.clear();
+    points.clear();
+    for (size_t pos = 0; pos < data.size(); pos += 2 * EC_POINT_SIZE) {
+        ec_card c{data.substr(pos, EC_POINT_SIZE), data.substr(pos + EC_POINT_SIZE, EC_POINT_SIZE)};
+        point_card p;
+        if (!g.decode(c.c1, p.c1) || !g.decode(c.c2, p.c2))
+            return ECC_INVALID_POINT;
+        cards.push_back(c);
+        points.push_back(p);
+    }
+    return SUCCESS;
+}
+
+static void decode_cards(ec_group& g, const std::vector<ec_card>& cards, point_stack& points) {
+    points.resize(cards.size());
+    for (size_t i = 0; i < cards.size(); i++) {
+        g.decode(cards[i].c1, points[i].c1, false);
+        g.decode(cards[i].c2, points[i].c2, false);
+    }
+}
+
+static void encode_cards(ec_group& g, const point_stack& points, std::vector<ec_card>& cards) {
+    cards.resize(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        cards[i].c1 = g.encode(points[i].c1);
+        cards[i].c2 = g.encode(points[i].c2);
+    }
+}
+
+static std::string encode_points(ec_group& g, const std::vector<ec_point>& points) {
+    std::string s;
+    for (auto& p : points)
+        s += g.encode(p);
+    return s;
+}
+
+// Points of a shuffle proof, checked on the curve but not in the subgroup:
+// the verification equations are linear and the statement (the stacks, G,
+// h and the generators) lies in the subgroup, so a small order component
+// only changes the hashed encodings, as a salt would. This saves 2n of the
+// 4n multiplications by n that decoding a mixed stack with its proof costs
+static bool decode_points(ec_group& g, const std::string& data, size_t n, std::vector<ec_point>& points) {
+    if (data.size() != n * EC_POINT_SIZE)
+        return false;
+    points.resize(n);
+    for (size_t i = 0; i < n; i++)
+        if (!g.decode(data.substr(i * EC_POINT_SIZE, EC_POINT_SIZE), points[i], true, false))
+            return false;
+    return true;
+}
+
+static std::string encode_scalars(ec_group& g, const std::vector<ec_scalar>& scalars) {
+    std::string s;
+    for (auto& k : scalars)
+        s += g.encode(k);
+    return s;
+}
+
+static bool decode_scalars(ec_group& g, const std::string& data, size_t n, std::vector<ec_scalar>& scalars) {
+    if (data.size() != n * EC_SCALAR_SIZE)
+        return false;
+    scalars.resize(n);
+    for (size_t i = 0; i < n; i++)
+        if (!g.decode(data.substr(i * EC_SCALAR_SIZE, EC_SCALAR_SIZE), scalars[i]))
+            return false;
+    return true;
+}
+
+/*
+ * Shuffle: out[i] = in[perm[i]] + r[i]*(G, h)
+*/
+struct shuffle_secret {
+    std::vector<int> perm;
+    std::vector<ec_scalar> r;
+};
+
+static void draw_shuffle(ec_group& g, random_source* rnd, size_t n, shuffle_secret& s) {
+    s.perm.resize(n);
+    for (size_t i = 0; i < n; i++)
+        s.perm[i] = i;
+    // Fisher-Yates, rejecting the values past the last whole multiple of i+1
+    for (size_t i = n; i-- > 1;) {
+        uint32_t bound = i + 1, limit = UINT32_MAX - UINT32_MAX % bound, v;
+        do {
+            unsigned char b[4];
+            rnd->generate(b, sizeof(b), RANDOM_STRONG);
+            v = (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+        } while (v >= limit);
+        std::swap(s.perm[i], s.perm[v % bound]);
+    }
+    s.r.clear();
+    for (size_t i = 0; i < n; i++)
+        s.r.push_back(g.random_scalar(rnd, RANDOM_STRONG));
+}
+
+static void apply_shuffle(ec_group& g, const ec_point& h, const point_stack& in, const shuffle_secret& s, point_stack& out) {
+    out.resize(in.size());
+    for (size_t i = 0; i < in.size(); i++) {
+        auto& c = in[s.perm[i]];
+        out[i].c1 = g.add(c.c1, g.mul_base(s.r[i]));
+        out[i].c2 = g.add(c.c2, g.mul(s.r[i], h));
+    }
+}
+
+// Challenges u[j] of the input cards, bound to the permutation commitment
+static void shuffle_challenges(ec_group& g, const std::string& statement, const std::string& commitment, size_t n, std::vector<ec_scalar>& u) {
+    std::string seed(64, '\0');
+    std::string data = "shuffle-u" + statement + commitment;
+    gcry_md_hash_buffer(GCRY_MD_SHA512, &seed[0], data.data(), data.size());
+    u.clear();
+    for (size_t j = 0; j < n; j++) {
+        unsigned char index[4] = {(unsigned char)j, (unsigned char)(j >> 8), (unsigned char)(j >> 16), (unsigned char)(j >> 24)};
+        u.push_back(g.hash_to_scalar(seed + std::string((const char*)index, sizeof(index))));
+    }
+}
+
+/*
+ * Proof of a shuffle (Terelius-Wikstrom, as in Haenni et al., "Pseudo-code
+ * algorithms for verifiable re-encryption mix-nets"). The prover commits to
+ * the permutation matrix with the generators H_1..H_n, derives challenges
+ * u[j] from the commitment and proves that the output weighted by the
+ * permuted challenges re-encrypts the input weighted by u, with a commitment
+ * chain (based on H_0) showing the weights are a permutation of u.
+ * About 9n scalar multiplications to prove or verify, 4n+5 values of proof
+*/
+struct shuffle_proof {
+    std::vector<ec_point> commitment, chain;
+    ec_scalar challenge;
+    ec_scalar s1, s2, s3, s4;
+    std::vector<ec_scalar> s_chain, s_perm;
+};
+
+// Commitments t of the sigma protocol, hashed into the challenge
+static ec_scalar shuffle_challenge(ec_group& g, const std::string& statement, const std::string& commitment, const std::string& chain,
+                                   const ec_point& t1, const ec_point& t2, const ec_point& t3, const point_card& t4, const std::vector<ec_point>& t_chain) {
+    std::string data = "shuffle" + statement + commitment + chain;
+    for (auto p : {&t1, &t2, &t3, &t4.c1, &t4.c2})
+        data += g.encode(*p);
+    data += encode_points(g, t_chain);
+    return g.hash_to_scalar(data);
+}
+
+static game_error prove_shuffle(ec_group& g, random_source* rnd, const ec_point& h, const std::string& statement, const point_stack& out, const shuffle_secret& secret, std::ostream& os) {
+    TRACE_FUNC("participant");
+    game_error res;
+    size_t n = out.size();
+    auto& gens = g.generators();
+    shuffle_proof proof;
+
+    // c[perm[i]] = r[perm[i]]*G + H_(i+1)
+    std::vector<ec_scalar> r(n);
+    proof.commitment.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        auto j = secret.perm[i];
+        r[j] = g.random_scalar(rnd, RANDOM_STRONG);
+        proof.commitment[j] = g.add(g.mul_base(r[j]), gens[i + 1]);
+    }
+    auto commitment = encode_points(g, proof.commitment);
+    std::vector<ec_scalar> u, u_out(n);
+    shuffle_challenges(g, statement, commitment, n, u);
+    for (size_t i = 0; i < n; i++)
+        u_out[i] = u[secret.perm[i]];
+
+    // chain[i] = r_chain[i]*G + u_out[i]*chain[i-1], from chain[-1] = H_0
+    std::vector<ec_scalar> r_chain(n);
+    proof.chain.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        r_chain[i] = g.random_scalar(rnd, RANDOM_STRONG);
+        proof.chain[i] = g.add(g.mul_base(r_chain[i]), g.mul(u_out[i], i ? proof.chain[i - 1] : gens[0]));
+    }
+
+    ec_scalar w1 = g.random_scalar(rnd, RANDOM_STRONG), w2 = g.random_scalar(rnd, RANDOM_STRONG);
+    ec_scalar w3 = g.random_scalar(rnd, RANDOM_STRONG), w4 = g.random_scalar(rnd, RANDOM_STRONG);
+    std::vector<ec_scalar> w_chain(n), w_perm(n);
+    ec_point t3 = g.mul_base(w3);
+    point_card t4{g.mul_base(w4), g.mul(w4, h)};
+    t4.c1 = g.sub(g.identity(), t4.c1);
+    t4.c2 = g.sub(g.identity(), t4.c2);
+    std::vector<ec_point> t_chain(n);
+    for (size_t i = 0; i < n; i++) {
+        w_chain[i] = g.random_scalar(rnd, RANDOM_STRONG);
+        w_perm[i] = g.random_scalar(rnd, RANDOM_STRONG);
+        t3 = g.add(t3, g.mul(w_perm[i], gens[i + 1]));
+        t4.c1 = g.add(t4.c1, g.mul(w_perm[i], out[i].c1));
+        t4.c2 = g.add(t4.c2, g.mul(w_perm[i], out[i].c2));
+        t_chain[i] = g.add(g.mul_base(w_chain[i]), g.mul(w_perm[i], i ? proof.chain[i - 1] : gens[0]));
+    }
+    auto chain = encode_points(g, proof.chain);
+    auto& e = proof.challenge;
+    e = shuffle_challenge(g, statement, commitment, chain, g.mul_base(w1), g.mul_base(w2), t3, t4, t_chain);
+
+    // responses s = w - e*secret
+    ec_scalar r_sum, r_chain_sum, r_u, r_out, v;
+    v.reset(gcry_mpi_set_ui(NULL, 1));
+    for (size_t i = n; i-- > 0;) {
+        r_chain_sum = g.mul_add(r_chain[i], v, r_chain_sum);
+        v = g.mul(u_out[i], v);
+    }
+    for (size_t j = 0; j < n; j++) {
+        r_sum = g.add(r_sum, r[j]);
+        r_u = g.mul_add(r[j], u[j], r_u);
+        r_out = g.mul_add(secret.r[j], u_out[j], r_out);
+    }
+    proof.s1 = g.sub(w1, g.mul(e, r_sum));
+    proof.s2 = g.sub(w2, g.mul(e, r_chain_sum));
+    proof.s3 = g.sub(w3, g.mul(e, r_u));
+    proof.s4 = g.sub(w4, g.mul(e, r_out));
+    for (size_t i = 0; i < n; i++) {
+        proof.s_chain.push_back(g.sub(w_chain[i], g.mul(e, r_chain[i])));
+        proof.s_perm.push_back(g.sub(w_perm[i], g.mul(e, u_out[i])));
+    }
+
+    encoder enc(os);
+    std::vector<ec_scalar> s = {proof.s1, proof.s2, proof.s3, proof.s4};
+    if ((res = enc.write(commitment)) || (res = enc.write(chain)) || (res = enc.write(g.encode(e))) || (res = enc.write(encode_scalars(g, s))) ||
+        (res = enc.write(encode_scalars(g, proof.s_chain))) || (res = enc.write(encode_scalars(g, proof.s_perm))))
+        return res;
+    return SUCCESS;
+}
+
+static bool verify_shuffle(ec_group& g, const ec_point& h, const std::string& statement, const point_stack& in, const point_stack& out, std::istream& is) {
+    TRACE_FUNC("participant");
+    size_t n = in.size();
+    // the proof uses generators H_0..H_n
+    if (n < 1 || n > DECK_SIZE || out.size() != n)
+        return false;
+    auto& gens = g.generators();
+    shuffle_proof proof;
+    std::string commitment, chain, e, s, s_chain, s_perm;
+    std::vector<ec_scalar> s1234;
+    decoder dec(is);
+    if (dec.read(commitment) || dec.read(chain) || dec.read(e) || dec.read(s) || dec.read(s_chain) || dec.read(s_perm))
+        return false;
+    if (!decode_points(g, commitment, n, proof.commitment) || !decode_points(g, chain, n, proof.chain) || !g.decode(e, proof.challenge) ||
+        !decode_scalars(g, s, 4, s1234) || !decode_scalars(g, s_chain, n, proof.s_chain) || !decode_scalars(g, s_perm, n, proof.s_perm))
+        return false;
+
+    std::vector<ec_scalar> u;
+    shuffle_challenges(g, statement, commitment, n, u);
+    auto& c = proof.commitment;
+    ec_point c_sum = g.identity(), c_u = g.identity();
+    point_card in_u{g.identity(), g.identity()};
+    ec_scalar u_prod;
+    u_prod.reset(gcry_mpi_set_ui(NULL, 1));
+    for (size_t j = 0; j < n; j++) {
+        c_sum = g.add(c_sum, g.sub(c[j], gens[j + 1]));
+        c_u = g.add(c_u, g.mul(u[j], c[j]));
+        in_u.c1 = g.add(in_u.c1, g.mul(u[j], in[j].c1));
+        in_u.c2 = g.add(in_u.c2, g.mul(u[j], in[j].c2));
+        u_prod = g.mul(u_prod, u[j]);
+    }
+    auto chain_end = g.sub(proof.chain[n - 1], g.mul(u_prod, gens[0]));
+
+    // the commitments t the responses imply
+    auto& ch = proof.challenge;
+    auto t1 = g.add(g.mul(ch, c_sum), g.mul_base(s1234[0]));
+    auto t2 = g.add(g.mul(ch, chain_end), g.mul_base(s1234[1]));
+    auto t3 = g.add(g.mul(ch, c_u), g.mul_base(s1234[2]));
+    point_card t4{g.sub(g.mul(ch, in_u.c1), g.mul_base(s1234[3])), g.sub(g.mul(ch, in_u.c2), g.mul(s1234[3], h))};
+    std::vector<ec_point> t_chain(n);
+    for (size_t i = 0; i < n; i++) {
+        auto& sp = proof.s_perm[i];
+        t3 = g.add(t3, g.mul(sp, gens[i + 1]));
+        t4.c1 = g.add(t4.c1, g.mul(sp, out[i].c1));
+        t4.c2 = g.add(t4.c2, g.mul(sp, out[i].c2));
+        t_chain[i] = g.add(g.add(g.mul(ch, proof.chain[i]), g.mul_base(proof.s_chain[i])), g.mul(sp, i ? proof.chain[i - 1] : gens[0]));
+    }
+    return g.encode(shuffle_challenge(g, statement, commitment, chain, t1, t2, t3, t4, t_chain)) == e;
+}
+
+/*
+ * ec_participant
+*/
+
+ec_participant::ec_participant(bool pipelined) : _pipelined(pipelined), _key_finalized(false), _csprng(&system_random) {
+    memset(_transcript, 0, sizeof(_transcript));
+}
+
+ec_participant::~ec_participant() {
+}
+
+void ec_participant::init(int id, int num_participants, bool predictable) {
+    _id = id;
+    _num_participants = num_participants;
+    _predictable = predictable;
+
+    char temp[10];
+    sprintf(temp, "[%d] ", _id);
+    _pfx = temp;
+}
+
+int ec_participant::id() { return _id; }
+
+int ec_participant::num_participants() { return _num_participants; }
+
+bool ec_participant::predictable() { return _predictable; }
+
+// see participant::absorb()
+void ec_participant::absorb(blob& msg) {
+    if (!_predictable)
+        return;
+    auto& data = msg.str();
+    hash_chain(_transcript, data.data(), data.size());
+    _drbg.seed(_transcript);
+}
+
+game_error ec_participant::create_group(blob& group) {
+#ifdef POKER_VERIFY_ONLY
+    return VRF_VERIFY_ONLY;
+#else
+    TRACE_FUNC("participant");
+    game_error res;
+    logger << _pfx << "create_group " << ec_group_name << std::endl;
+    _group.reset(new ec_group());
+    _session.resize(EC_SESSION_SIZE);
+    random()->generate((unsigned char*)&_session[0], _session.size(), RANDOM_STRONG);
+    encoder out(group.out());
+    if ((res = out.write(std::string(ec_group_name))) || (res = out.write(_session)))
+        return res;
+    return SUCCESS;
+#endif
+}
+
+game_error ec_participant::load_group(blob& group) {
+    TRACE_FUNC("participant");
+    absorb(group);
+    std::string name;
+    decoder in(group.in());
+    if (in.read(name) || name != ec_group_name) {
+        logger_at(LOG_ERROR) << _pfx << "*** unsupported group " << name << std::endl;
+        return ECC_INVALID_GROUP;
+    }
+    if (in.read(_session) || _session.size() != EC_SESSION_SIZE)
+        return ECC_INVALID_GROUP;
+    _group.reset(new ec_group());
+    return SUCCESS;
+}
+
+// Challenge of the Schnorr proof of a key share, bound to the game and
+// to the participant, so the proof cannot be replayed elsewhere
+static ec_scalar key_challenge(ec_group& g, const std::string& session, int id, const std::string& h, const ec_point& r) {
+    unsigned char index[4] = {(unsigned char)id, (unsigned char)(id >> 8), (unsigned char)(id >> 16), (unsigned char)(id >> 24)};
+    return g.hash_to_scalar("key" + session + std::string((const char*)index, sizeof(index)) + h + g.encode(r));
+}
+
+// Key share h_i = x_i*G with a Schnorr proof of x_i
+game_error ec_participant::generate_key(blob& key) {
+    TRACE_FUNC("participant");
+    game_error res;
+    logger << _pfx << "publishKey " << std::endl;
+    auto& g = *_group;
+    auto x = g.random_scalar(random(), RANDOM_VERY_STRONG);
+    auto k = g.random_scalar(random(), RANDOM_STRONG);
+    _x = g.encode(x);
+    _h_i = g.encode(g.mul_base(x));
+    _h = _h_i;
+    auto e = key_challenge(g, _session, _id, _h_i, g.mul_base(k));
+    encoder out(key.out());
+    if ((res = out.write(_id)) || (res = out.write(_h_i)) || (res = out.write(g.encode(e))) || (res = out.write(g.encode(g.mul_add(e, x, k)))))
+        return res;
+    return SUCCESS;
+}
+
+game_error ec_participant::load_their_key(blob& key) {
+    TRACE_FUNC("participant");
+    absorb(key);
+    logger << _pfx << "load_their_key " << std::endl;
+    auto& g = *_group;
+    int id;
+    std::string h_j, e_enc, s_enc;
+    ec_point h;
+    ec_scalar e, s;
+    decoder in(key.in());
+    bool verified = !in.read(id) && !in.read(h_j) && !in.read(e_enc) && !in.read(s_enc) &&
+                    g.decode(h_j, h) && g.decode(e_enc, e) && g.decode(s_enc, s) && id != _id &&
+                    h_j != _h_i && std::find(_their_keys.begin(), _their_keys.end(), h_j) == _their_keys.end();
+    // s*G - e*h_j = k*G
+    if (verified)
+        verified = g.encode(key_challenge(g, _session, id, h_j, g.sub(g.mul_base(s), g.mul(e, h)))) == e_enc;
+    if (!verified) {
+        logger_at(LOG_ERROR) << "*** their public key was not correctly generated!" << std::endl;
+        return TMC_KEYGENERATIONPROTOCOL_UPDATEKEY;
+    }
+    _their_keys.push_back(h_j);
+    return SUCCESS;
+}
+
+game_error ec_participant::finalize_key_generation() {
+    TRACE_FUNC("participant");
+    logger << _pfx << "finalize_key_generation " << std::endl;
+    auto& g = *_group;
+    ec_point h, h_j;
+    g.decode(_h_i, h, false);
+    for (auto& key : _their_keys) {
+        g.decode(key, h_j, false);
+        h = g.add(h, h_j);
+    }
+    _h = g.encode(h);
+    _key_finalized = true;
+    return SUCCESS;
+}
+
+game_error ec_participant::create_vsshe_group(blob& group) {
+#ifdef POKER_VERIFY_ONLY
+    return VRF_VERIFY_ONLY;
+#else
+    TRACE_FUNC("participant");
+    game_error res;
+    logger << _pfx << "create_vsshe_group" << std::endl;
+    encoder out(group.out());
+    if ((res = out.write((int)DECK_SIZE)) || (res = out.write(_h)))
+        return res;
+    return SUCCESS;
+#endif
+}
+
+// The generators of the shuffle proofs are derived, not published:
+// the group is the stack size and the common key
+game_error ec_participant::load_vsshe_group(blob& group) {
+    TRACE_FUNC("participant");
+    absorb(group);
+    logger << _pfx << "load_vsshe_group" << std::endl;
+    int size;
+    std::string h;
+    decoder in(group.in());
+    if (in.read(size) || in.read(h) || size != DECK_SIZE) {
+        logger_at(LOG_ERROR) << _pfx << "*** VRHE instance was not correctly generated!" << std::endl;
+        return TMC_VSSHE_CHECKGROUP;
+    }
+    if (h != _h) {
+        logger << "VSSHE: common public key does not match!" << std::endl;
+        return TMC_VSSHE_MISMATCH_H;
+    }
+    return SUCCESS;
+}
+
+// Open cards (O, (type+1)*G), masked by the first shuffle
+game_error ec_participant::create_stack() {
+    TRACE_FUNC("participant");
+    logger << _pfx << "create_stack " << std::endl;
+    auto& g = *_group;
+    auto identity = g.encode(g.identity());
+    _stack.clear();
+    for (size_t type = 0; type < DECK_SIZE; type++)
+        _stack.push_back({identity, g.encode(g.card_point(type))});
+    return SUCCESS;
+}
+
+game_error ec_participant::mix(const std::vector<ec_card>& stack, std::vector<ec_card>& mixed, std::ostream& mixed_stack, std::ostream& stack_proof) {
+    game_error res;
+    auto& g = *_group;
+    ec_point h;
+    point_stack in, out;
+    shuffle_secret secret;
+    g.decode(_h, h, false);
+    decode_cards(g, stack, in);
+    draw_shuffle(g, random(), in.size(), secret);
+    apply_shuffle(g, h, in, secret, out);
+    encode_cards(g, out, mixed);
+    auto out_enc = pack(mixed);
+    encoder enc(mixed_stack);
+    if ((res = enc.write(out_enc)))
+        return res;
+    return prove_shuffle(g, random(), h, _h + pack(stack) + out_enc, out, secret, stack_proof);
+}
+
+game_error ec_participant::read_stack(blob& mixed_stack, std::vector<ec_card>& mixed) {
+    std::string out_enc;
+    point_stack points;
+    decoder in(mixed_stack.in());
+    if (in.read(out_enc) || unpack(*_group, out_enc, mixed, points) || mixed.size() != _stack.size()) {
+        logger << "shuffle: read or parse error" << std::endl;
+        return TMCG_READ_STACK;
+    }
+    return SUCCESS;
+}
+
+// Points taken from the stacks, already checked
+static bool verify_stack(ec_group& g, const std::string& h_enc, const std::vector<ec_card>& stack, const std::vector<ec_card>& mixed, std::istream& stack_proof) {
+    ec_point h;
+    point_stack in, out;
+    g.decode(h_enc, h, false);
+    decode_cards(g, stack, in);
+    decode_cards(g, mixed, out);
+    return verify_shuffle(g, h, h_enc + pack(stack) + pack(mixed), in, out, stack_proof);
+}
+
+game_error ec_participant::shuffle_stack(blob& mixed_stack, blob& stack_proof) {
+    TRACE_FUNC("participant");
+    game_error res;
+    logger << _pfx << "shuffle_stack" << std::endl;
+    std::vector<ec_card> mixed;
+    if ((res = mix(_stack, mixed, mixed_stack.out(), stack_proof.out())))
+        return res;
+    _stack = mixed;
+    return SUCCESS;
+}
+
+game_error ec_participant::load_stack(blob& mixed_stack, blob& mixed_stack_proof) {
+    TRACE_FUNC("participant");
+    game_error res;
+    absorb(mixed_stack);
+    absorb(mixed_stack_proof);
+    logger << _pfx << "load_stack " << std::endl;
+    std::vector<ec_card> mixed;
+    if ((res = read_stack(mixed_stack, mixed)))
+        return res;
+    bool verified = verify_stack(*_group, _h, _stack, mixed, mixed_stack_proof.in());
+    metrics::instance().record_proof(PROOF_STACK, verified);
+    if (!verified) {
+        logger_at(LOG_ERROR) << "*** shuffle: verification failed" << std::endl;
+        return TMC_VERIFYSTACKEQUALITY;
+    }
+    _stack = mixed;
+    return SUCCESS;
+}
+
+game_error ec_participant::load_and_shuffle_stack(blob& their_stack, blob& their_proof, blob& mixed_stack, blob& stack_proof) {
+    TRACE_FUNC("participant");
+    game_error res;
+#if defined(POKER_THREADS) && !defined(POKER_VERIFY_ONLY)
+    if (_pipelined) {
+        logger << _pfx << "load_and_shuffle_stack (pipelined)" << std::endl;
+        absorb(their_stack);
+        absorb(their_proof);
+        std::vector<ec_card> theirs;
+        if ((res = read_stack(their_stack, theirs)))
+            return res;
+
+        // Verify their shuffle, in a group context of its own, while we
+        // mix on top of it. Our mix is discarded if the verification fails
+        if (!_verifier_group)
+            _verifier_group.reset(new ec_group());
+        bool verified = false;
+        task_group verifier(service_locator::instance().task_scheduler(), PRIORITY_INTERACTIVE);
+        verifier.run([&]() {
+            TRACE_SPAN("participant", "verify_their_stack");
+            verified = verify_stack(*_verifier_group, _h, _stack, theirs, their_proof.in());
+        });
+
+        std::vector<ec_card> mixed;
+        std::ostringstream mix_stack, mix_proof;
+        res = mix(theirs, mixed, mix_stack, mix_proof);
+        // runs the verification here if no worker has picked it up yet
+        verifier.wait();
+        metrics::instance().record_proof(PROOF_STACK, verified);
+        if (res)
+            return res;
+        if (!verified) {
+            logger_at(LOG_ERROR) << "*** shuffle: verification failed" << std::endl;
+            return TMC_VERIFYSTACKEQUALITY;
+        }
+        mixed_stack.out() << mix_stack.str();
+        stack_proof.out() << mix_proof.str();
+        _stack = mixed;
+        return SUCCESS;
+    }
+#endif
+    if ((res = load_stack(their_stack, their_proof)))
+        return res;
+    return shuffle_stack(mixed_stack, stack_proof);
+}
+
+game_error ec_participant::take_cards_from_stack(int count) {
+    TRACE_FUNC("participant");
+    logger << _pfx << "take_cards_from_stack(" << count << ")" << std::endl;
+    if (count > (int)_stack.size())
+        return TMC_INVALID_CARD_INDEX;
+    for (int i = 0; i < count; i++) {
+        _cards.push_back(_stack.back());
+        _stack.pop_back();
+    }
+    return SUCCESS;
+}
+
+// Decryption share d = x_i*c1 with a Chaum-Pedersen proof that
+// log_G(h_i) = log_c1(d)
+game_error ec_participant::prove_card_secret(int card_index, blob& my_proof) {
+#ifdef POKER_VERIFY_ONLY
+    return VRF_VERIFY_ONLY;
+#else
+    TRACE_FUNC("participant");
+    game_error res;
+    logger << _pfx << "prove_card_secret(" << card_index << ")" << std::endl;
+    if (card_index < 0 || card_index >= (int)_cards.size())
+        return TMC_PROVE_CARD;
+    auto& g = *_group;
+    ec_point c1;
+    ec_scalar x;
+    g.decode(_cards[card_index].c1, c1, false);
+    g.decode(_x, x);
+    auto k = g.random_scalar(random(), RANDOM_STRONG);
+    auto d = g.encode(g.mul(x, c1));
+    auto e = g.hash_to_scalar("card" + _h_i + _cards[card_index].c1 + d + g.encode(g.mul_base(k)) + g.encode(g.mul(k, c1)));
+    encoder out(my_proof.out());
+    if ((res = out.write(_h_i)) || (res = out.write(d)) || (res = out.write(g.encode(e))) || (res = out.write(g.encode(g.mul_add(e, x, k)))))
+        return res;
+    return SUCCESS;
+#endif
+}
+
+game_error ec_participant::add_card_secret(int card_index, const std::string& share) {
+    auto& g = *_group;
+    ec_point sum = g.identity(), d;
+    auto it = _card_secrets.find(card_index);
+    if (it != _card_secrets.end())
+        g.decode(it->second, sum, false);
+    g.decode(share, d, false);
+    _card_secrets[card_index] = g.encode(g.add(sum, d));
+    return SUCCESS;
+}
+
+game_error ec_participant::self_card_secret(int card_index) {
+    TRACE_FUNC("participant");
+    logger << _pfx << "self_card_secret(" << card_index << ")" << std::endl;
+    if (card_index < 0 || card_index >= (int)_cards.size())
+        return TMC_INVALID_CARD_INDEX;
+    auto& g = *_group;
+    ec_point c1;
+    ec_scalar x;
+    g.decode(_cards[card_index].c1, c1, false);
+    g.decode(_x, x);
+    _card_secrets.erase(card_index);
+    return add_card_secret(card_index, g.encode(g.mul(x, c1)));
+}
+
+game_error ec_participant::verify_card_secret(int card_index, blob& their_proof) {
+    TRACE_FUNC("participant");
+    absorb(their_proof);
+    logger << _pfx << "verify_card_secret(" << card_index << ")" << std::endl;
+    if (card_index < 0 || card_index >= (int)_cards.size())
+        return TMC_INVALID_CARD_INDEX;
+    auto& g = *_group;
+    auto& c1_enc = _cards[card_index].c1;
+    std::string h_j, d_enc, e_enc, s_enc;
+    ec_point c1, h, d;
+    ec_scalar e, s;
+    decoder in(their_proof.in());
+    bool verified = !in.read(h_j) && !in.read(d_enc) && !in.read(e_enc) && !in.read(s_enc) &&
+                    std::find(_their_keys.begin(), _their_keys.end(), h_j) != _their_keys.end() &&
+                    g.decode(h_j, h, false) && g.decode(d_enc, d) && g.decode(e_enc, e) && g.decode(s_enc, s);
+    if (verified) {
+        g.decode(c1_enc, c1, false);
+        auto a1 = g.sub(g.mul_base(s), g.mul(e, h));
+        auto a2 = g.sub(g.mul(s, c1), g.mul(e, d));
+        verified = g.encode(g.hash_to_scalar("card" + h_j + c1_enc + d_enc + g.encode(a1) + g.encode(a2))) == e_enc;
+    }
+    metrics::instance().record_proof(PROOF_CARD, verified);
+    if (!verified) {
+        logger_at(LOG_ERROR) << "*** [verify_card_secret] Card " << card_index << " verification failed!" << std::endl;
+        return TMC_VERIFYCARDSECRET;
+    }
+    return add_card_secret(card_index, d_enc);
+}
+
+game_error ec_participant::open_card(int card_index) {
+    TRACE_FUNC("participant");
+    logger_at(LOG_TRACE) << _pfx << "open_card(" << card_index << ")" << std::endl;
+    if (card_index < 0 || card_index >= (int)_cards.size())
+        return TMC_INVALID_CARD_INDEX;
+    auto& g = *_group;
+    ec_point c2, secret = g.identity();
+    g.decode(_cards[card_index].c2, c2, false);
+    auto it = _card_secrets.find(card_index);
+    if (it != _card_secrets.end())
+        g.decode(it->second, secret, false);
+    size_t card_type = g.card_type(g.sub(c2, secret));
+    if (card_type >= DECK_SIZE) {
+        logger_at(LOG_ERROR) << _pfx << "failed to open_card(" << card_index << ") = " << std::endl;
+        return TMC_INVALID_CARD_INDEX;
+    }
+    _open_cards[card_index] = card_type;
+    logger_at(LOG_TRACE) << _pfx << "open_card(" << card_index << ") = " << (int)card_type << std::endl;
+    return SUCCESS;
+}
+
+size_t ec_participant::get_open_card(int card_index) {
+    logger_at(LOG_TRACE) << _pfx << "get_open_card(" << card_index << ")" << std::endl;
+    auto card_type = _open_cards[card_index];
+    logger_at(LOG_TRACE) << _pfx << "get_open_card(" << card_index << ") = " << card_type << std::endl;
+    return card_type;
+}
+
+game_error ec_participant::save(std::ostream& os) {
+    TRACE_FUNC("participant");
+    game_error res;
+    encoder out(os);
+    if ((res = out.write((bool)_group)) || (res = out.write(_session)))
+        return res;
+    if ((res = out.write(_x)) || (res = out.write(_h_i)) || (res = out.write(_h)) || (res = out.write((int)_their_keys.size())))
+        return res;
+    for (auto& key : _their_keys)
+        if ((res = out.write(key)))
+            return res;
+    if ((res = out.write(_key_finalized)) || (res = out.write(pack(_stack))) || (res = out.write(pack(_cards))))
+        return res;
+    if ((res = out.write((int)_card_secrets.size())))
+        return res;
+    for (auto& secret : _card_secrets) {
+        if ((res = out.write(secret.first)) || (res = out.write(secret.second)))
+            return res;
+    }
+    if ((res = out.write((int)_open_cards.size())))
+        return res;
+    for (auto& card : _open_cards) {
+        if ((res = out.write(card.first)) || (res = out.write((int)card.second)))
+            return res;
+    }
+    bignumber position;
+    position.set_uint64(_drbg.position());
+    if ((res = out.write(std::string((const char*)_transcript, sizeof(_transcript)))) || (res = out.write(position)))
+        return res;
+    return SUCCESS;
+}
+
+game_error ec_participant::restore(std::istream& is) {
+    TRACE_FUNC("participant");
+    game_error res;
+    decoder in(is);
+    bool has_group;
+    if ((res = in.read(has_group)) || (res = in.read(_session)))
+        return res;
+    if (has_group && _session.size() != EC_SESSION_SIZE)
+        return COD_ERROR;
+    _group.reset(has_group ? new ec_group() : NULL);
+    int num_keys;
+    if ((res = in.read(_x)) || (res = in.read(_h_i)) || (res = in.read(_h)) || (res = in.read(num_keys)))
+        return res;
+    if (num_keys < 0 || num_keys > _num_participants)
+        return COD_ERROR;
+    _their_keys.resize(num_keys);
+    for (auto& key : _their_keys)
+        if ((res = in.read(key)))
+            return res;
+    std::string stack, cards;
+    if ((res = in.read(_key_finalized)) || (res = in.read(stack)) || (res = in.read(cards)))
+        return res;
+    // an empty stack is one not created yet
+    if (stack.size() % (2 * EC_POINT_SIZE) || cards.size() % (2 * EC_POINT_SIZE) ||
+        stack.size() > DECK_SIZE * 2 * EC_POINT_SIZE || cards.size() > DECK_SIZE * 2 * EC_POINT_SIZE)
+        return TMCG_READ_STACK;
+    _stack.clear();
+    _cards.clear();
+    for (size_t pos = 0; pos < stack.size(); pos += 2 * EC_POINT_SIZE)
+        _stack.push_back({stack.substr(pos, EC_POINT_SIZE), stack.substr(pos + EC_POINT_SIZE, EC_POINT_SIZE)});
+    for (size_t pos = 0; pos < cards.size(); pos += 2 * EC_POINT_SIZE)
+        _cards.push_back({cards.substr(pos, EC_POINT_SIZE), cards.substr(pos + EC_POINT_SIZE, EC_POINT_SIZE)});
+    int num_secrets, num_open_cards;
+    if ((res = in.read(num_secrets)))
+        return res;
+    _card_secrets.clear();
+    for (auto i = 0; i < num_secrets; i++) {
+        int card_index;
+        std::string secret;
+        if ((res = in.read(card_index)) || (res = in.read(secret)))
+            return res;
+        _card_secrets[card_index] = secret;
+    }
+    if ((res = in.read(num_open_cards)))
+        return res;
+    _open_cards.clear();
+    for (auto i = 0; i < num_open_cards; i++) {
+        int card_index, card_type;
+        if ((res = in.read(card_index)) || (res = in.read(card_type)))
+            return res;
+        _open_cards[card_index] = card_type;
+    }
+    std::string transcript;
+    bignumber position;
+    uint64_t pos;
+    if ((res = in.read(transcript)) || (res = in.read(position)) || (res = position.get_uint64(pos)))
+        return res;
+    if (transcript.size() != sizeof(_transcript))
+        return COD_ERROR;
+    memcpy(_transcript, transcript.data(), sizeof(_transcript));
+    _drbg.seed(_transcript);
+    _drbg.seek(pos);
+    return SUCCESS;
+}
+
+}  // namespace poker
@@ -0,0 +1,101 @@
+#ifndef EC_PARTICIPANT_H
+#define EC_PARTICIPANT_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "drbg.h"
+#include "i_participant.h"
+
+namespace poker {
+
+class ec_group;
+
+// ElGamal encryption, points encoded
+struct ec_card {
+    std::string c1, c2;
+};
+
+/*
+ * The VTMF and verifiable shuffle protocol over the Ed25519 group:
+ * ElGamal encryptions of the points (type+1)*G, Schnorr proofs of the
+ * key shares, Chaum-Pedersen proofs of the decryption shares and
+ * Terelius-Wikstrom proofs of the shuffles
+*/
+class ec_participant : public i_participant {
+    int _id;
+    int _num_participants;
+    bool _predictable;
+    bool _pipelined;
+    std::string _pfx;
+    std::unique_ptr<ec_group> _group;
+    // game identifier chosen by Alice in the group message
+    std::string _session;
+    // context of the pipelined verifications
+    std::unique_ptr<ec_group> _verifier_group;
+    bool _key_finalized;
+    std::string _x;
+    std::string _h_i;
+    std::string _h;
+    std::vector<std::string> _their_keys;
+    std::vector<ec_card> _stack;
+    std::vector<ec_card> _cards;
+    // sum of the decryption shares of a card
+    std::map<int, std::string> _card_secrets;
+    std::map<int, size_t> _open_cards;
+
+    // hash chain over the messages received, seeding _drbg
+    unsigned char _transcript[DRBG_SEED_SIZE];
+    chacha20_drbg _drbg;
+    buffered_csprng _csprng;
+
+    void absorb(blob& msg);
+    game_error read_stack(blob& mixed_stack, std::vector<ec_card>& mixed);
+    game_error mix(const std::vector<ec_card>& stack, std::vector<ec_card>& mixed, std::ostream& mixed_stack, std::ostream& stack_proof);
+    game_error add_card_secret(int card_index, const std::string& share);
+
+   public:
+    ec_participant(bool pipelined = false);
+    virtual ~ec_participant();
+
+    void init(int id, int num_participants, bool predictable) override;
+    int id() override;
+    int num_participants() override;
+    bool predictable() override;
+    random_source* random() { return _predictable ? (random_source*)&_drbg : &_csprng; }
+
+    game_error create_group(blob& group) override;
+    game_error load_group(blob& group) override;
+
+    // Key generation protocol
+    game_error generate_key(blob& key) override;
+    game_error load_their_key(blob& key) override;
+    game_error finalize_key_generation() override;
+
+    // VSSHE - Verifiable Secret Shuffle of Homomorphic Encryptions.
+    game_error create_vsshe_group(blob& group) override;
+    game_error load_vsshe_group(blob& group) override;
+
+    // Stack
+    game_error create_stack() override;
+    game_error shuffle_stack(blob& mixed_stack, blob& stack_proof) override;
+    game_error load_stack(blob& mixed_stack, blob& mixed_stack_proof) override;
+    game_error load_and_shuffle_stack(blob& their_stack, blob& their_proof, blob& mixed_stack, blob& stack_proof) override;
+
+    // Cards
+    game_error take_cards_from_stack(int count) override;
+    game_error prove_card_secret(int card_index, blob& my_proof) override;
+    game_error self_card_secret(int card_index) override;
+    game_error verify_card_secret(int card_index, blob& their_proof) override;
+    game_error open_card(int card_index) override;
+    size_t get_open_card(int card_index) override;
+
+    game_error save(std::ostream& os) override;
+    game_error restore(std::istream& is) override;
+};
+
+}  // namespace poker
+
+#endif
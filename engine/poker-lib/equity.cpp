@@ -0,0 +1,243 @@
+#include "equity.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "hand-eval.h"
+#include "service_locator.h"
+
+namespace poker {
+
+namespace {
+
+const uint64_t runouts_per_unit = 4096;
+const double z_95 = 1.96;
+
+uint64_t binomial(int n, int k) {
+    if (k < 0 || k > n)
+        return 0;
+    uint64_t c = 1;
+    for (int i = 1; i <= k; i++)
+        c = c * (n - k + i) / i;
+    return c;
+}
+
+// splitmix64
+struct sample_rng {
+    uint64_t state;
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+};
+
+// per worker scratch space of run_unit
+struct unit_buffers {
+    std::vector<card_t> hands[NUM_PLAYERS];
+    std::vector<uint32_t> ranks[NUM_PLAYERS];
+
+    unit_buffers() {
+        for (int p = 0; p < NUM_PLAYERS; p++) {
+            hands[p].resize(runouts_per_unit * HAND_SIZE);
+            ranks[p].resize(runouts_per_unit);
+        }
+    }
+};
+
+struct equity_counts {
+    uint64_t wins[NUM_PLAYERS];
+    uint64_t ties;
+};
+
+class equity_job {
+    card_t _hands[NUM_PLAYERS][HAND_SIZE];  // private cards, then public
+    int _num_known;                         // public cards already dealt
+    int _num_missing;
+    std::vector<card_t> _deck;              // cards left
+    const equity_options& _opts;
+
+    std::atomic<uint64_t> _wins[NUM_PLAYERS];
+    std::atomic<uint64_t> _ties;
+    std::atomic<bool> _stop;
+
+   public:
+    uint64_t num_units;
+
+    equity_job(const card_t private_cards[NUM_PLAYERS][NUM_PRIVATE_CARDS], const card_t* public_cards,
+               int num_public_cards, const equity_options& opts)
+        : _num_known(num_public_cards), _num_missing(NUM_PUBLIC_CARDS - num_public_cards), _opts(opts),
+          _ties(0), _stop(false) {
+        uint64_t used = 0;
+        for (int p = 0; p < NUM_PLAYERS; p++) {
+            _wins[p] = 0;
+            for (int i = 0; i < NUM_PRIVATE_CARDS; i++) {
+                _hands[p][i] = private_cards[p][i];
+                used |= 1ull << private_cards[p][i];
+            }
+            for (int i = 0; i < num_public_cards; i++) {
+                _hands[p][NUM_PRIVATE_CARDS + i] = public_cards[i];
+                used |= 1ull << public_cards[i];
+            }
+        }
+        for (card_t c = 0; c < DECK_SIZE; c++)
+            if (!(used >> c & 1))
+                _deck.push_back(c);
+
+        uint64_t total = opts.samples ? opts.samples : binomial(_deck.size(), _num_missing);
+        num_units = (total + runouts_per_unit - 1) / runouts_per_unit;
+    }
+
+    bool stopped() { return _stop.load(std::memory_order_relaxed); }
+
+    void run_unit(uint64_t unit, unit_buffers& buffers) {
+        if (stopped())
+            return;
+        uint64_t count = 0;
+        auto add_runout = [&](const card_t* board) {
+            for (int p = 0; p < NUM_PLAYERS; p++) {
+                auto h = buffers.hands[p].data() + count * HAND_SIZE;
+                std::copy(_hands[p], _hands[p] + NUM_PRIVATE_CARDS + _num_known, h);
+                std::copy(board, board + _num_missing, h + NUM_PRIVATE_CARDS + _num_known);
+            }
+            count++;
+        };
+
+        card_t board[NUM_PUBLIC_CARDS];
+        if (_opts.samples) {
+            // partial Fisher-Yates on a copy of the deck
+            sample_rng rng = {_opts.seed ^ (unit * 0xd1b54a32d192ed03ull)};
+            std::vector<card_t> deck(_deck);
+            auto n = std::min(runouts_per_unit, _opts.samples - unit * runouts_per_unit);
+            for (uint64_t s = 0; s < n; s++) {
+                for (int i = 0; i < _num_missing; i++) {
+                    auto j = i + rng.next() % (deck.size() - i);
+                    std::swap(deck[i], deck[j]);
+                    board[i] = deck[i];
+                }
+                add_runout(board);
+            }
+        } else {
+            // unrank the first combination of the unit, then step through
+            int m = _deck.size(), k = _num_missing;
+            uint64_t rank = unit * runouts_per_unit;
+            uint64_t total = binomial(m, k);
+            auto n = std::min(runouts_per_unit, total - rank);
+            int index[NUM_PUBLIC_CARDS];
+            for (int i = 0, c = 0; i < k; i++, c++) {
+                while (binomial(m - c - 1, k - i - 1) <= rank)
+                    rank -= binomial(m - c - 1, k - i - 1), c++;
+                index[i] = c;
+            }
+            for (uint64_t s = 0; s < n; s++) {
+                for (int i = 0; i < k; i++)
+                    board[i] = _deck[index[i]];
+                add_runout(board);
+                int i = k - 1;
+                while (i >= 0 && index[i] == m - k + i)
+                    i--;
+                if (i < 0)
+                    break;
+                index[i]++;
+                for (int j = i + 1; j < k; j++)
+                    index[j] = index[j - 1] + 1;
+            }
+        }
+
+        auto& ranks = buffers.ranks;
+        for (int p = 0; p < NUM_PLAYERS; p++)
+            rank_hands_unchecked(buffers.hands[p].data(), count, ranks[p].data());
+        equity_counts c = {{0, 0}, 0};
+        for (uint64_t i = 0; i < count; i++) {
+            if (ranks[ALICE][i] > ranks[BOB][i])
+                c.wins[ALICE]++;
+            else if (ranks[ALICE][i] < ranks[BOB][i])
+                c.wins[BOB]++;
+            else
+                c.ties++;
+        }
+        merge(c);
+    }
+
+    void merge(const equity_counts& c) {
+        for (int p = 0; p < NUM_PLAYERS; p++)
+            _wins[p].fetch_add(c.wins[p]);
+        _ties.fetch_add(c.ties);
+        if (_opts.samples && _opts.confidence > 0) {
+            equity_result r;
+            result(r);
+            if (r.error <= _opts.confidence)
+                _stop.store(true);
+        }
+    }
+
+    void result(equity_result& r) {
+        r.ties = _ties.load();
+        for (int p = 0; p < NUM_PLAYERS; p++)
+            r.wins[p] = _wins[p].load();
+        r.runouts = r.wins[ALICE] + r.wins[BOB] + r.ties;
+        r.error = 0;
+        if (!r.runouts) {
+            r.equity[ALICE] = r.equity[BOB] = 0;
+            return;
+        }
+        double n = r.runouts;
+        for (int p = 0; p < NUM_PLAYERS; p++)
+            r.equity[p] = (r.wins[p] + r.ties / 2.0) / n;
+        if (_opts.samples) {
+            // per runout outcome is 0, 1/2 or 1
+            double mean_sq = (r.wins[ALICE] + r.ties / 4.0) / n;
+            double variance = std::max(0.0, mean_sq - r.equity[ALICE] * r.equity[ALICE]);
+            r.error = z_95 * std::sqrt(variance / n);
+        }
+    }
+};
+
+}  // namespace
+
+game_error compute_equity(const card_t private_cards[NUM_PLAYERS][NUM_PRIVATE_CARDS],
+                          const card_t* public_cards, int num_public_cards,
+                          const equity_options& opts, equity_result& result) {
+    game_error res;
+    if (num_public_cards < 0 || num_public_cards > NUM_PUBLIC_CARDS)
+        return SRR_INVALID_CARD_COUNT;
+    card_t all[NUM_PLAYERS * NUM_PRIVATE_CARDS + NUM_PUBLIC_CARDS];
+    std::copy(&private_cards[0][0], &private_cards[0][0] + NUM_PLAYERS * NUM_PRIVATE_CARDS, all);
+    std::copy(public_cards, public_cards + num_public_cards, all + NUM_PLAYERS * NUM_PRIVATE_CARDS);
+    if ((res = check_hand(all, NUM_PLAYERS * NUM_PRIVATE_CARDS + num_public_cards)))
+        return res;
+
+    equity_job job(private_cards, public_cards, num_public_cards, opts);
+
+    // background work: verification of incoming messages overtakes it
+    // between chunks. A few chunks per worker even out uneven units
+    auto& sched = service_locator::instance().task_scheduler();
+    uint64_t num_chunks = opts.num_chunks > 0 ? opts.num_chunks : 4 * (sched.num_threads() + 1);
+    uint64_t grain = std::max<uint64_t>(1, (job.num_units + num_chunks - 1) / num_chunks);
+    if ((res = sched.parallel_for(job.num_units, grain, [&](size_t begin, size_t end) -> game_error {
+            unit_buffers buffers;
+            for (auto unit = begin; unit < end && !job.stopped(); unit++)
+                job.run_unit(unit, buffers);
+            return SUCCESS;
+        }, PRIORITY_BACKGROUND)))
+        return res;
+
+    job.result(result);
+    return SUCCESS;
+}
+
+game_error compute_equity(const game_state& g, const equity_options& opts, equity_result& result) {
+    card_t private_cards[NUM_PLAYERS][NUM_PRIVATE_CARDS];
+    for (int p = 0; p < NUM_PLAYERS; p++)
+        std::copy(g.players[p].cards, g.players[p].cards + NUM_PRIVATE_CARDS, private_cards[p]);
+    int num_public_cards = 0;
+    while (num_public_cards < NUM_PUBLIC_CARDS && g.public_cards[num_public_cards] != cards::uk)
+        num_public_cards++;
+    return compute_equity(private_cards, g.public_cards, num_public_cards, opts, result);
+}
+
+}  // namespace poker
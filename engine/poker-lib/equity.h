@@ -0,0 +1,50 @@
+#ifndef EQUITY_H
+#define EQUITY_H
+
+#include <cstdint>
+
+#include "common.h"
+#include "game-state.h"
+
+namespace poker {
+
+/*
+ * Heads-up all-in equity.
+ * Runouts of the unknown public cards are either all enumerated or
+ * sampled; the work is split in units that run as background tasks of
+ * the engine scheduler. Sampling stops early once the requested confidence is reached.
+*/
+
+struct equity_options {
+    equity_options() : samples(0), confidence(0), seed(0), num_chunks(0) {}
+    // 0 enumerates every runout, otherwise the maximum number of sampled runouts
+    uint64_t samples;
+    // when sampling, stop once the 95% confidence interval of the equity
+    // is within +-confidence (0 runs all samples)
+    double confidence;
+    uint64_t seed;
+    // number of chunks the units are split in, which bounds the threads
+    // working on them; 0 uses a few chunks per scheduler worker
+    int num_chunks;
+};
+
+struct equity_result {
+    uint64_t runouts;
+    uint64_t wins[NUM_PLAYERS];
+    uint64_t ties;
+    // wins plus half of the ties, per runout
+    double equity[NUM_PLAYERS];
+    // half width of the 95% confidence interval, 0 when enumerated
+    double error;
+};
+
+game_error compute_equity(const card_t private_cards[NUM_PLAYERS][NUM_PRIVATE_CARDS],
+                          const card_t* public_cards, int num_public_cards,
+                          const equity_options& opts, equity_result& result);
+
+// Uses players[].cards and the opened public_cards of g
+game_error compute_equity(const game_state& g, const equity_options& opts, equity_result& result);
+
+}  // namespace poker
+
+#endif
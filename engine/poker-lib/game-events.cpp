@@ -0,0 +1,148 @@
+#include "game-events.h"
+#include "codec.h"
+
+namespace poker {
+
+const char* game_event_type_names[] = {"card_opened", "bet", "phase", "winner"};
+
+#ifdef POKER_THREADS
+#define EVENTS_LOCK std::lock_guard<std::mutex> _lock(_mutex)
+#else
+#define EVENTS_LOCK
+#endif
+
+game_event_log::game_event_log(const game_event_log& other) {
+    *this = other;
+}
+
+game_event_log& game_event_log::operator=(const game_event_log& other) {
+    if (this == &other)
+        return *this;
+    std::vector<game_event> events;
+    other.events_since(0, events);
+    EVENTS_LOCK;
+    _events.swap(events);
+    return *this;
+}
+
+game_event& game_event_log::append(game_event_type type) {
+    _events.push_back(game_event());
+    auto& e = _events.back();
+    e.seq = _events.size();
+    e.type = type;
+    e.player = NONE;
+    e.card_index = -1;
+    e.card = cards::uk;
+    e.bet = BET_NONE;
+    e.phase = PHS_PREFLOP;
+    return e;
+}
+
+void game_event_log::card_opened(int player, int card_index, card_t card) {
+    EVENTS_LOCK;
+    auto& e = append(EVT_CARD_OPENED);
+    e.player = player;
+    e.card_index = card_index;
+    e.card = card;
+}
+
+void game_event_log::bet_placed(int player, bet_type type, const money_t& amount, const money_t& bets) {
+    EVENTS_LOCK;
+    auto& e = append(EVT_BET);
+    e.player = player;
+    e.bet = type;
+    e.amount = amount;
+    e.bets = bets;
+}
+
+void game_event_log::phase_changed(bet_phase phase) {
+    EVENTS_LOCK;
+    append(EVT_PHASE).phase = phase;
+}
+
+void game_event_log::winner_decided(int winner) {
+    EVENTS_LOCK;
+    append(EVT_WINNER).player = winner;
+}
+
+uint64_t game_event_log::last_seq() const {
+    EVENTS_LOCK;
+    return _events.size();
+}
+
+void game_event_log::events_since(uint64_t since, std::vector<game_event>& events) const {
+    EVENTS_LOCK;
+    for (auto seq = since; seq < _events.size(); seq++)
+        events.push_back(_events[seq]);
+}
+
+void game_event_log::write_json(uint64_t since, json_writer& w) const {
+    EVENTS_LOCK;
+    w.begin_object().key("last_seq").value(_events.size());
+    w.key("events").begin_array();
+    for (auto seq = since; seq < _events.size(); seq++) {
+        auto& e = _events[seq];
+        w.begin_object().key("seq").value(e.seq).key("type").value(game_event_type_names[e.type]);
+        switch (e.type) {
+            case EVT_CARD_OPENED:
+                w.key("player").value(e.player).key("index").value(e.card_index).key("card").value(e.card);
+                break;
+            case EVT_BET:
+                w.key("player").value(e.player).key("bet_type").value((int)e.bet)
+                 .key("amount").value(e.amount).key("bets").value(e.bets);
+                break;
+            case EVT_PHASE:
+                w.key("phase").value((int)e.phase);
+                break;
+            case EVT_WINNER:
+                w.key("winner").value(e.player);
+                break;
+        }
+        w.end_object();
+    }
+    w.end_array().end_object();
+}
+
+game_error game_event_log::write(std::ostream& os) const {
+    EVENTS_LOCK;
+    game_error res;
+    encoder out(os);
+    if ((res = out.write((int)_events.size())))
+        return res;
+    for (auto& e : _events) {
+        if ((res = out.write(e.type)) || (res = out.write(e.player)) || (res = out.write(e.card_index)) ||
+            (res = out.write(e.card)) || (res = out.write(e.bet)) || (res = out.write(e.amount)) ||
+            (res = out.write(e.bets)) || (res = out.write(e.phase)))
+            return res;
+    }
+    return SUCCESS;
+}
+
+game_error game_event_log::read(std::istream& is) {
+    game_error res;
+    decoder in(is);
+    int count;
+    if ((res = in.read(count)))
+        return res;
+    if (count < 0 || count > max_hand_events)
+        return COD_ERROR;
+    std::vector<game_event> events(count);
+    for (auto i = 0; i < count; i++) {
+        auto& e = events[i];
+        int type, phase;
+        e.seq = i + 1;
+        if ((res = in.read(type)) || (res = in.read(e.player)) || (res = in.read(e.card_index)) ||
+            (res = in.read(e.card)) || (res = in.read(e.bet)) || (res = in.read(e.amount)) ||
+            (res = in.read(e.bets)) || (res = in.read(phase)))
+            return res;
+        if (type < EVT_CARD_OPENED || type > EVT_WINNER)
+            return COD_ERROR;
+        e.type = (game_event_type)type;
+        e.phase = (bet_phase)phase;
+    }
+    EVENTS_LOCK;
+    _events.swap(events);
+    return SUCCESS;
+}
+
+}  // namespace poker
@@ -0,0 +1,87 @@
+#ifndef GAME_EVENTS_H
+#define GAME_EVENTS_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#ifdef POKER_THREADS
+#include <mutex>
+#endif
+
+#include "common.h"
+#include "game-state.h"
+#include "json-writer.h"
+
+namespace poker {
+
+/*
+ * Game state changes recorded by the referee, numbered 1, 2, ... so that
+ * callers can fetch only what happened since the last sequence number
+ * they saw instead of polling the whole game_state
+*/
+
+enum game_event_type {
+    EVT_CARD_OPENED,
+    EVT_BET,
+    EVT_PHASE,
+    EVT_WINNER,
+};
+
+extern const char* game_event_type_names[];
+
+struct game_event {
+    uint64_t seq;
+    game_event_type type;
+    // EVT_CARD_OPENED: owner of a private card, NONE for public cards
+    // EVT_BET: bettor
+    // EVT_WINNER: winner or TIE
+    int player;
+    // EVT_CARD_OPENED: index into the player's or the public cards
+    int card_index;
+    card_t card;
+    // EVT_BET: the bet, its amount (raises) and the player's bets after it
+    bet_type bet;
+    money_t amount;
+    money_t bets;
+    // EVT_PHASE: the new phase
+    bet_phase phase;
+};
+
+// Most events a restored log may hold; a hand has far fewer
+const int max_hand_events = 4096;
+
+class game_event_log {
+    std::vector<game_event> _events;
+#ifdef POKER_THREADS
+    mutable std::mutex _mutex;
+#endif
+
+    game_event& append(game_event_type type);
+
+   public:
+    game_event_log() {}
+    game_event_log(const game_event_log& other);
+    game_event_log& operator=(const game_event_log& other);
+
+    void card_opened(int player, int card_index, card_t card);
+    void bet_placed(int player, bet_type type, const money_t& amount, const money_t& bets);
+    void phase_changed(bet_phase phase);
+    void winner_decided(int winner);
+
+    uint64_t last_seq() const;
+
+    // Appends the events after sequence number since, oldest first
+    void events_since(uint64_t since, std::vector<game_event>& events) const;
+
+    // {"last_seq": n, "events": [...]} with the events after since
+    void write_json(uint64_t since, json_writer& w) const;
+
+    // Checkpoint of the whole log in the codec format
+    game_error write(std::ostream& os) const;
+    game_error read(std::istream& is);
+};
+
+}  // namespace poker
+
+#endif
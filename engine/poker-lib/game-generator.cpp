@@ -1,9 +1,16 @@
 #include "game-generator.h"
 
 #include <array>
+#include <chrono>
 
 namespace poker {
 
+typedef std::chrono::steady_clock generator_clock;
+
+static double elapsed_us(generator_clock::time_point t0) {
+    return std::chrono::duration<double, std::micro>(generator_clock::now() - t0).count();
+}
+
 game_error game_generator::generate() {
     game_error res;
 
@@ -18,15 +25,21 @@ game_error game_generator::generate() {
     std::string msg1, msg2;
     std::array<game_error, 2> r = {CONTINUED, CONTINUED};
     int p = ALICE;  // current player
+    auto t0 = generator_clock::now();
     if ((res = players[p].create_handshake(msg1)))
         return res;
+    if (on_message)
+        on_message(p, msg1, elapsed_us(t0));
     turns.push_back({p, msg1});
     do {
         p = opponent_id(p);
         if (r[p] == CONTINUED) {
             msg2.clear();
             logger << "\nHANDSHAKE " << p << "\n";
+            t0 = generator_clock::now();
             r[p] = players[p].process_handshake(msg1, msg2);
+            if (msg2.size() && on_message)
+                on_message(p, msg2, elapsed_us(t0));
             if (msg2.size()) {
                 turns.push_back({p, msg2});
                 msg1 = msg2;
@@ -40,13 +53,15 @@ game_error game_generator::generate() {
 
     // bets
     auto t = BET_CALL;
-    auto amount = 0;
+    money_t amount = 0;
     auto did_raise = false;
     p = players[ALICE].game().current_player;
     while (!players[ALICE].game_over() && !players[BOB].game_over()) {
         if (!players[p].game_over()) {
             r = {CONTINUED, CONTINUED};
-            if (last_aggressor >= 0 && players[p].game().phase == bet_phase::PHS_RIVER) {
+            if (bet_strategy) {
+                bet_strategy(p, players[p].game(), t, amount);
+            } else if (last_aggressor >= 0 && players[p].game().phase == bet_phase::PHS_RIVER) {
                 logger << "-=> player " << p << " AAA" << std::endl;
                 if (p == last_aggressor) {
                     logger << "-=> player " << p << " RAISE" << std::endl;
@@ -62,18 +77,24 @@ game_error game_generator::generate() {
                     t = BET_CHECK;
                 }
             }
+            t0 = generator_clock::now();
             r[p] = players[p].create_bet(t, amount, msg1);
             logger << "\n== " << p << " CREATE BET: " << r[p] << "\n";
             if (r[p] != SUCCESS && r[p] != CONTINUED)
                 return r[p];
+            if (on_message)
+                on_message(p, msg1, elapsed_us(t0));
             t = BET_CHECK;
             turns.push_back({p, msg1});
             do {
                 p = opponent_id(p);
                 if (r[p] == CONTINUED) {
                     msg2.clear();
+                    t0 = generator_clock::now();
                     r[p] = players[p].process_bet(msg1, msg2);
                     logger << "\n== " << p << " PROCESS BET: " << r[p] << "\n";
+                    if (msg2.size() && on_message)
+                        on_message(p, msg2, elapsed_us(t0));
                     if (msg2.size()) {
                         turns.push_back({p, msg2});
                         msg1 = msg2;
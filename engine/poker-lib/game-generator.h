@@ -2,6 +2,7 @@
 #define GAME_GENERATOR_H
 
 #include <array>
+#include <functional>
 #include <sstream>
 #include <tuple>
 
@@ -21,6 +22,12 @@ class game_generator {
     bignumber challenger_addr;
     int last_aggressor;
 
+    // optional hooks, used by the load generator
+    // chooses the next bet of player p; replaces the scripted betting when set
+    std::function<void(int p, game_state& g, bet_type& type, money_t& amount)> bet_strategy;
+    // called for every message produced, with the time spent producing it
+    std::function<void(int p, const std::string& msg, double elapsed_us)> on_message;
+
     // output
 
     game_state alice_game;
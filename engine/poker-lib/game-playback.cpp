@@ -1,15 +1,17 @@
 #include "game-playback.h"
 #include "compression.h"
+#include "trace.h"
 
 namespace poker {
 
-game_playback::game_playback() : _last_player_id(-1) {
+game_playback::game_playback() : _last_player_id(-1), _version(0) {
 }
 
 game_playback:: ~game_playback() {
 }
 
 game_error game_playback::playback(std::istream& logfile) {
+    TRACE_FUNC("playback");
     game_error res;
     logger << "*** game playback...\n";
     std::string serialized_msg;
@@ -18,7 +20,13 @@ game_error game_playback::playback(std::istream& logfile) {
         std::istringstream is(serialized_msg);
         if ((res=message::decode(is, &msg)))
             return res;
-        logger << "*** " << msg->to_string() << std::endl;
+        logger_at(LOG_TRACE) << "*** " << msg->to_string() << std::endl;
+        if (!_version)
+            _version = msg->version();
+        if (msg->version() != _version) {
+            delete msg;
+            return COD_VERSION_MISMATCH;
+        }
         switch(msg->type()) {
             case MSG_VTMF:
                 res = handle_vtmf((msg_vtmf*)msg);
@@ -58,7 +66,10 @@ game_error game_playback::handle_vtmf(msg_vtmf* msg) {
     if ((res=_r.step_init_game(msg->alice_money, msg->bob_money, msg->big_blind)))
         return res;
 
-    if ((res=_r.step_vtmf_group(msg->vtmf)))
+    participant_backend backend;
+    if ((res=backend_of_version(msg->version(), backend)))
+        return res;
+    if ((res=_r.step_vtmf_group(msg->vtmf, backend)))
         return res;
 
     _alice_key = msg->alice_key;
@@ -126,7 +137,7 @@ game_error game_playback::handle_bet_request(msg_bet_request* msg) {
     _bet_card_proof.clear();
     auto step = _r.step();
     if ((res=_r.bet(msg->player_id, msg->type, msg->amt))) {
-        logger << "BET ERROR " << res << std::endl;
+        logger_at(LOG_ERROR) << "BET ERROR " << res << std::endl;
         return res;
     }
     auto step_changed = _r.step() != step;
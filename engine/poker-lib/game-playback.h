@@ -20,6 +20,7 @@ class game_playback {
     blob _bet_card_proof;
     std::vector<std::unique_ptr<message>> _messages;
     int _last_player_id; // sender of the last msg replayed
+    int _version; // of the first message, shared by all of the game
 public:
     game_playback();
     virtual ~game_playback();
@@ -0,0 +1,146 @@
+#include <cstring>
+#include "game-snapshot.h"
+
+namespace poker {
+
+game_error game_snapshot::capture(const game_state& g) {
+    game_error res;
+    if ((res = g.big_blind.get_uint64(big_blind)))
+        return res;
+    for (auto p = 0; p < NUM_PLAYERS; p++) {
+        auto& ps = g.players[p];
+        if ((res = ps.total_funds.get_uint64(total_funds[p])))
+            return res;
+        if ((res = ps.bets.get_uint64(bets[p])))
+            return res;
+        if ((res = g.funds_share[p].get_uint64(funds_share[p])))
+            return res;
+        ids[p] = ps.id;
+        for (auto i = 0; i < NUM_PRIVATE_CARDS; i++)
+            private_cards[p][i] = ps.cards[i];
+    }
+    error = g.error;
+    current_player = g.current_player;
+    winner = g.winner;
+    last_aggressor = g.last_aggressor;
+    next_msg_author = g.next_msg_author;
+    phase = g.phase;
+    muck = g.muck;
+    for (auto i = 0; i < NUM_PUBLIC_CARDS; i++)
+        public_cards[i] = g.public_cards[i];
+    return SUCCESS;
+}
+
+void game_snapshot::restore(game_state& g) const {
+    g.big_blind.set_uint64(big_blind);
+    for (auto p = 0; p < NUM_PLAYERS; p++) {
+        auto& ps = g.players[p];
+        ps.id = ids[p];
+        ps.total_funds.set_uint64(total_funds[p]);
+        ps.bets.set_uint64(bets[p]);
+        g.funds_share[p].set_uint64(funds_share[p]);
+        ps.strength.reset();
+        for (auto i = 0; i < NUM_PRIVATE_CARDS; i++) {
+            ps.cards[i] = private_cards[p][i];
+            ps.strength.add_card(ps.cards[i]);
+        }
+    }
+    g.error = (game_error)error;
+    g.current_player = current_player;
+    g.winner = winner;
+    g.last_aggressor = last_aggressor;
+    g.next_msg_author = next_msg_author;
+    g.phase = (bet_phase)phase;
+    g.muck = muck;
+    for (auto i = 0; i < NUM_PUBLIC_CARDS; i++)
+        g.open_public_card(i, public_cards[i]);
+}
+
+static char* put_u64(char* data, uint64_t v) {
+    for (auto i = 0; i < 8; i++, v >>= 8)
+        *data++ = (char)(v & 0xff);
+    return data;
+}
+
+static const char* get_u64(const char* data, uint64_t& v) {
+    v = 0;
+    for (auto i = 7; i >= 0; i--)
+        v = (v << 8) | (unsigned char)data[i];
+    return data + 8;
+}
+
+void game_snapshot::encode(char* data) const {
+    *data++ = GAME_SNAPSHOT_VERSION;
+    data = put_u64(data, big_blind);
+    for (auto p = 0; p < NUM_PLAYERS; p++) {
+        data = put_u64(data, total_funds[p]);
+        data = put_u64(data, bets[p]);
+        data = put_u64(data, funds_share[p]);
+    }
+    *data++ = (char)(error & 0xff);
+    *data++ = (char)((error >> 8) & 0xff);
+    for (auto p = 0; p < NUM_PLAYERS; p++)
+        *data++ = ids[p];
+    *data++ = current_player;
+    *data++ = winner;
+    *data++ = last_aggressor;
+    *data++ = next_msg_author;
+    *data++ = phase;
+    *data++ = muck;
+    memcpy(data, public_cards, NUM_PUBLIC_CARDS);
+    data += NUM_PUBLIC_CARDS;
+    memcpy(data, private_cards, sizeof(private_cards));
+}
+
+static bool valid_card(uint8_t card) {
+    return card < DECK_SIZE || card == cards::uk;
+}
+
+static bool valid_player(int8_t player, int last) {
+    return player >= NONE && player <= last;
+}
+
+game_error game_snapshot::decode(const char* data) {
+    if (*data++ != GAME_SNAPSHOT_VERSION)
+        return SNP_INVALID_SNAPSHOT;
+    game_snapshot s;
+    data = get_u64(data, s.big_blind);
+    for (auto p = 0; p < NUM_PLAYERS; p++) {
+        data = get_u64(data, s.total_funds[p]);
+        data = get_u64(data, s.bets[p]);
+        data = get_u64(data, s.funds_share[p]);
+    }
+    s.error = (int16_t)((unsigned char)data[0] | ((unsigned char)data[1] << 8));
+    data += 2;
+    for (auto p = 0; p < NUM_PLAYERS; p++)
+        s.ids[p] = *data++;
+    s.current_player = *data++;
+    s.winner = *data++;
+    s.last_aggressor = *data++;
+    s.next_msg_author = *data++;
+    s.phase = *data++;
+    s.muck = *data++;
+    memcpy(s.public_cards, data, NUM_PUBLIC_CARDS);
+    data += NUM_PUBLIC_CARDS;
+    memcpy(s.private_cards, data, sizeof(s.private_cards));
+
+    if (s.phase > PHS_GAME_OVER || s.muck > 1 ||
+        !valid_player(s.current_player, BOB) || !valid_player(s.last_aggressor, BOB) ||
+        !valid_player(s.next_msg_author, BOB) || !valid_player(s.winner, TIE))
+        return SNP_INVALID_SNAPSHOT;
+    for (auto p = 0; p < NUM_PLAYERS; p++) {
+        if (s.ids[p] != p)
+            return SNP_INVALID_SNAPSHOT;
+        for (auto card : s.private_cards[p])
+            if (!valid_card(card))
+                return SNP_INVALID_SNAPSHOT;
+    }
+    for (auto card : s.public_cards)
+        if (!valid_card(card))
+            return SNP_INVALID_SNAPSHOT;
+
+    *this = s;
+    return SUCCESS;
+}
+
+}  // namespace poker
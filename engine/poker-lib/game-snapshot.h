@@ -0,0 +1,52 @@
+#ifndef GAME_SNAPSHOT_H
+#define GAME_SNAPSHOT_H
+
+#include <cstdint>
+#include <type_traits>
+#include "common.h"
+#include "game-state.h"
+
+namespace poker {
+
+/*
+ * Compact, trivially copyable copy of a game_state.
+ * Money is held in 64 bits instead of GMP numbers, so snapshots can be
+ * copied, kept in arrays and ring buffers (replay, undo, audit) and
+ * encoded without allocating. Cards keep their order (flop, turn, river)
+ * as one byte each; hand strengths are recomputed by restore.
+*/
+
+const int GAME_SNAPSHOT_VERSION = 1;
+// bytes written by game_snapshot::encode
+const int GAME_SNAPSHOT_SIZE = 76;
+
+struct game_snapshot {
+    uint64_t big_blind;
+    uint64_t total_funds[NUM_PLAYERS];
+    uint64_t bets[NUM_PLAYERS];
+    uint64_t funds_share[NUM_PLAYERS];
+    int16_t error;
+    int8_t ids[NUM_PLAYERS];
+    int8_t current_player;
+    int8_t winner;
+    int8_t last_aggressor;
+    int8_t next_msg_author;
+    uint8_t phase;
+    uint8_t muck;
+    uint8_t public_cards[NUM_PUBLIC_CARDS];
+    uint8_t private_cards[NUM_PLAYERS][NUM_PRIVATE_CARDS];
+
+    // BIG_OUT_OF_RANGE when an amount does not fit in 64 bits
+    game_error capture(const game_state& g);
+    void restore(game_state& g) const;
+
+    // Fixed-size little-endian encoding, independent of the struct layout
+    void encode(char* data) const;
+    game_error decode(const char* data);
+};
+
+static_assert(std::is_trivially_copyable<game_snapshot>::value, "game_snapshot must be trivially copyable");
+
+}  // namespace poker
+
+#endif
@@ -1,5 +1,6 @@
 #include <iostream>
 #include "game-state.h"
+#include "codec.h"
 
 namespace poker {
 
@@ -21,37 +22,147 @@ game_error game_state::get_player_hand(int player, card_t* hand) {
     return SUCCESS;
 }
 
-std::string game_state::to_json(char* extra_fields) {
-    char json[1024];
-    auto& p0 = players[0];
-    auto& p1 = players[1];
-    snprintf(json, sizeof(json), "{"
-        "\"current_player\": %d, "
-        "\"next_msg_author\": %d, "
-        "\"error\": %d, "
-        "\"winner\": %d, "
-        "\"public_cards\": [%d, %d, %d, %d, %d], "
-        "\"players\": ["
-            "{\"id\": %d, \"total_funds\": \"%s\", \"bets\": \"%s\", \"cards\":[%d, %d]},"
-            "{\"id\": %d, \"total_funds\": \"%s\", \"bets\": \"%s\", \"cards\":[%d, %d]}"
-        "],"
-        "\"funds_share\":[\"%s\", \"%s\"], "
-        "\"last_aggressor\": %d, "
-        "\"muck\": %d "
-        "%s %s" // extra fields
-        "}",
-        current_player, next_msg_author, (int)error, winner,
-        public_cards[0], public_cards[1], public_cards[2],
-        public_cards[3], public_cards[4],
-        p0.id, p0.total_funds.to_string().c_str(), p0.bets.to_string().c_str(), p0.cards[0], p0.cards[1],
-        p1.id, p1.total_funds.to_string().c_str(), p1.bets.to_string().c_str(), p1.cards[0], p1.cards[1],
-        funds_share[0].to_string().c_str(), funds_share[1].to_string().c_str(), 
-        last_aggressor, 
-        muck,
-        (extra_fields ? "," : ""),  (extra_fields ? extra_fields : "")
-    );
-    return std::string(json);
+void game_state::open_public_card(int index, card_t card) {
+    public_cards[index] = card;
+    for (auto& p : players)
+        p.strength.add_card(card);
 }
 
+void game_state::open_private_card(int player, int index, card_t card) {
+    players[player].cards[index] = card;
+    players[player].strength.add_card(card);
+}
+
+// null until the player's cards are known
+static void write_hand_json(json_writer& w, const player_state& p) {
+    if (p.cards[0] == cards::uk) {
+        w.null_value();
+        return;
+    }
+    w.begin_object()
+        .key("category").value(hand_category_names[p.strength.category])
+        .key("rank").value(p.strength.rank)
+        .key("outs").value(p.strength.outs)
+     .end_object();
+}
+
+void game_state::write_json_fields(json_writer& w, bool with_hand) const {
+    w.key("current_player").value(current_player)
+     .key("next_msg_author").value(next_msg_author)
+     .key("error").value((int)error)
+     .key("winner").value(winner);
+    w.key("public_cards").begin_array();
+    for (auto card : public_cards)
+        w.value(card);
+    w.end_array();
+    w.key("players").begin_array();
+    for (auto& p : players) {
+        w.begin_object()
+            .key("id").value(p.id)
+            .key("total_funds").value(p.total_funds)
+            .key("bets").value(p.bets);
+        w.key("cards").begin_array();
+        for (auto card : p.cards)
+            w.value(card);
+        w.end_array();
+        if (with_hand) {
+            w.key("hand");
+            write_hand_json(w, p);
+        }
+        w.end_object();
+    }
+    w.end_array();
+    w.key("funds_share").begin_array();
+    for (auto& share : funds_share)
+        w.value(share);
+    w.end_array();
+    w.key("last_aggressor").value(last_aggressor)
+     .key("muck").value((int)muck);
+}
+
+void game_state::write_json(json_writer& w) const {
+    w.begin_object();
+    write_json_fields(w);
+    w.end_object();
+}
+
+std::string game_state::to_json(char* extra_fields) const {
+    std::string json;
+    json_writer w(json);
+    w.begin_object();
+    write_json_fields(w, true);
+    if (extra_fields)
+        w.raw(extra_fields);
+    w.end_object();
+    return json;
+}
+
+game_error game_state::write(std::ostream& os) const {
+    game_error res;
+    encoder out(os);
+    int fields[] = {current_player, error, phase, winner, last_aggressor, next_msg_author, muck};
+    for (auto v : fields)
+        if ((res = out.write(v)))
+            return res;
+    for (auto& p : players) {
+        if ((res = out.write(p.total_funds)) || (res = out.write(p.bets)))
+            return res;
+        for (auto card : p.cards)
+            if ((res = out.write(card)))
+                return res;
+    }
+    for (auto card : public_cards)
+        if ((res = out.write(card)))
+            return res;
+    if ((res = out.write(big_blind)))
+        return res;
+    for (auto& share : funds_share)
+        if ((res = out.write(share)))
+            return res;
+    return SUCCESS;
+}
+
+static game_error read_card(decoder& in, card_t& card) {
+    game_error res;
+    if ((res = in.read(card)))
+        return res;
+    if ((card < 0 || card >= DECK_SIZE) && card != cards::uk)
+        return SRR_UNKNOWN_CARD;
+    return SUCCESS;
+}
+
+game_error game_state::read(std::istream& is) {
+    game_error res;
+    decoder in(is);
+    int err, phs;
+    if ((res = in.read(current_player)) || (res = in.read(err)) || (res = in.read(phs)) ||
+        (res = in.read(winner)) || (res = in.read(last_aggressor)) || (res = in.read(next_msg_author)) ||
+        (res = in.read(muck)))
+        return res;
+    error = (game_error)err;
+    phase = (bet_phase)phs;
+    for (auto& p : players) {
+        if ((res = in.read(p.total_funds)) || (res = in.read(p.bets)))
+            return res;
+        p.strength.reset();
+        for (auto& card : p.cards) {
+            if ((res = read_card(in, card)))
+                return res;
+            p.strength.add_card(card);
+        }
+    }
+    for (auto i = 0; i < NUM_PUBLIC_CARDS; i++) {
+        card_t card;
+        if ((res = read_card(in, card)))
+            return res;
+        open_public_card(i, card);
+    }
+    if ((res = in.read(big_blind)))
+        return res;
+    for (auto& share : funds_share)
+        if ((res = in.read(share)))
+            return res;
+    return SUCCESS;
+}
 
 }  // namespace poker
\ No newline at end of file
@@ -4,7 +4,9 @@
 #include <cstdint>
 #include "common.h"
 #include "solver.h"
+#include "hand-eval.h"
 #include "bignumber.h"
+#include "json-writer.h"
 
 namespace poker {
 
@@ -27,6 +29,8 @@ struct player_state {
     money_t total_funds;
     money_t bets;
     card_t cards[NUM_PRIVATE_CARDS];
+    // private and public cards opened so far
+    hand_strength strength;
 };
 
 class game_state {
@@ -50,7 +54,21 @@ public:
     money_t funds_share[NUM_PLAYERS];
     bool muck;
 
-    std::string to_json(char* extra_fields=NULL);
+    // Set an opened card and update the hand strengths that include it
+    void open_public_card(int index, card_t card);
+    void open_private_card(int player, int index, card_t card);
+
+    // Appends the game state as a JSON object, as the referee and the
+    // verifier report it. write_json_fields writes only its members, so
+    // callers can add their own to the same object; with_hand adds each
+    // player's hand strength, which to_json and the player APIs report
+    void write_json(json_writer& w) const;
+    void write_json_fields(json_writer& w, bool with_hand = false) const;
+    std::string to_json(char* extra_fields=NULL) const;
+
+    // Checkpoint in the codec format; read recomputes the hand strengths
+    game_error write(std::ostream& os) const;
+    game_error read(std::istream& is);
     game_error get_player_hand(int player, card_t* hand);
 };
 
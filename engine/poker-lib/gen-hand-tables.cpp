@@ -0,0 +1,182 @@
+/*
+ * Generates hand-tables.inc, the lookup tables of the native hand
+ * evaluator (hand-eval.cpp). Runs on the build host.
+ *
+ * Hands of 5 to 7 cards are ranked 1 (worst) .. 7462 (royal flush):
+ * - flush_ranks: by the rank mask of a suit holding five or more cards
+ * - noflush<n>_ranks: by a minimal perfect hash of the rank counts (a
+ *   13 digit base-5 number with digit sum n); the hash is the index of
+ *   the counts among all such numbers in lexicographic order and is
+ *   computed with quinary_offsets
+*/
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "hand-score.h"
+
+using namespace poker;
+
+const int max_cards = 7;
+const int num_hand_ranks = 7462;
+
+// sequences of `len` base-5 digits summing to `sum`
+static long count_sequences(int len, int sum) {
+    if (sum < 0)
+        return 0;
+    if (len == 0)
+        return sum == 0;
+    long n = 0;
+    for (int d = 0; d <= 4; d++)
+        n += count_sequences(len - 1, sum - d);
+    return n;
+}
+
+static long offsets[NUM_RANKS][max_cards + 1][5];
+
+static long quinary_hash(const int* counts, int sum) {
+    long h = 0;
+    for (int i = 0; i < NUM_RANKS; i++) {
+        h += offsets[i][sum][counts[i]];
+        sum -= counts[i];
+    }
+    return h;
+}
+
+static std::map<uint32_t, int> class_of_score;
+
+static int rank_of(uint32_t score) {
+    auto it = class_of_score.find(score);
+    if (it == class_of_score.end()) {
+        fprintf(stderr, "gen-hand-tables: no class for score %x\n", score);
+        exit(1);
+    }
+    return it->second;
+}
+
+// suit masks of the given rank counts, spread so that no suit has a flush
+static void spread_suits(const int* counts, uint32_t* suit_masks) {
+    int next = 0;
+    std::fill(suit_masks, suit_masks + NUM_SUITS, 0);
+    for (int r = 0; r < NUM_RANKS; r++)
+        for (int c = 0; c < counts[r]; c++)
+            suit_masks[next++ % NUM_SUITS] |= 1 << r;
+}
+
+// calls f on every rank count vector with digit sum n
+template <typename F>
+static void for_each_counts(int n, F f) {
+    int counts[NUM_RANKS] = {0};
+    std::function<void(int, int)> rec = [&](int r, int left) {
+        if (r == NUM_RANKS) {
+            if (!left)
+                f(counts);
+            return;
+        }
+        for (int c = 0; c <= std::min(4, left); c++) {
+            counts[r] = c;
+            rec(r + 1, left - c);
+        }
+        counts[r] = 0;
+    };
+    rec(0, n);
+}
+
+// one padding entry so that the last one can be read with a 32-bit gather
+static void write_table(FILE* f, const char* name, const std::vector<int>& values) {
+    fprintf(f, "static const uint16_t %s[%zu] = {", name, values.size() + 1);
+    for (size_t i = 0; i < values.size(); i++)
+        fprintf(f, "%s%s%d", i ? "," : "", i % 16 ? "" : "\n    ", values[i]);
+    fprintf(f, ",0};\n\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: gen-hand-tables <output>\n");
+        return 1;
+    }
+
+    for (int i = 0; i < NUM_RANKS; i++)
+        for (int sum = 0; sum <= max_cards; sum++)
+            for (int d = 0; d <= 4; d++)
+                offsets[i][sum][d] = d ? offsets[i][sum][d - 1] + count_sequences(NUM_RANKS - 1 - i, sum - d + 1) : 0;
+
+    // equivalence classes of five-card hands
+    std::vector<uint32_t> scores;
+    for_each_counts(5, [&](const int* counts) {
+        uint32_t masks[NUM_SUITS];
+        spread_suits(counts, masks);
+        scores.push_back(hand_score(masks));
+    });
+    for (uint32_t mask = 0; mask < 1 << NUM_RANKS; mask++) {
+        if (hand_score_bit_count(mask) != 5)
+            continue;
+        uint32_t masks[NUM_SUITS] = {mask, 0, 0, 0};
+        scores.push_back(hand_score(masks));
+    }
+    std::sort(scores.begin(), scores.end());
+    scores.erase(std::unique(scores.begin(), scores.end()), scores.end());
+    if (scores.size() != num_hand_ranks) {
+        fprintf(stderr, "gen-hand-tables: %zu classes, expected %d\n", scores.size(), num_hand_ranks);
+        return 1;
+    }
+    int category_first_rank[NUM_HAND_CATEGORIES + 1];
+    for (size_t i = 0; i < scores.size(); i++) {
+        class_of_score[scores[i]] = i + 1;
+        if (!i || scores[i] >> 20 != scores[i - 1] >> 20)
+            category_first_rank[scores[i] >> 20] = i + 1;
+    }
+    category_first_rank[NUM_HAND_CATEGORIES] = num_hand_ranks + 1;
+
+    std::vector<int> flush(1 << NUM_RANKS, 0);
+    for (uint32_t mask = 0; mask < flush.size(); mask++) {
+        auto bits = hand_score_bit_count(mask);
+        if (bits < 5 || bits > max_cards)
+            continue;
+        uint32_t masks[NUM_SUITS] = {mask, 0, 0, 0};
+        flush[mask] = rank_of(hand_score(masks));
+    }
+
+    std::vector<std::vector<int>> noflush(max_cards + 1);
+    for (int n = 5; n <= max_cards; n++) {
+        noflush[n].resize(count_sequences(NUM_RANKS, n));
+        for_each_counts(n, [&](const int* counts) {
+            uint32_t masks[NUM_SUITS];
+            spread_suits(counts, masks);
+            auto h = quinary_hash(counts, n);
+            if (h < 0 || h >= (long)noflush[n].size() || noflush[n][h]) {
+                fprintf(stderr, "gen-hand-tables: hash collision\n");
+                exit(1);
+            }
+            noflush[n][h] = rank_of(hand_score(masks));
+        });
+    }
+
+    FILE* f = fopen(argv[1], "w");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+    fprintf(f, "// Generated by gen-hand-tables, do not edit\n\n");
+    fprintf(f, "static const uint32_t quinary_offsets[%d][%d][5] = {", NUM_RANKS, max_cards + 1);
+    for (int i = 0; i < NUM_RANKS; i++) {
+        fprintf(f, "\n    {");
+        for (int sum = 0; sum <= max_cards; sum++)
+            fprintf(f, "%s{%ld,%ld,%ld,%ld,%ld}", sum ? "," : "", offsets[i][sum][0], offsets[i][sum][1],
+                    offsets[i][sum][2], offsets[i][sum][3], offsets[i][sum][4]);
+        fprintf(f, "},");
+    }
+    fprintf(f, "};\n\n");
+    fprintf(f, "static const uint16_t category_first_rank[%d] = {", NUM_HAND_CATEGORIES + 1);
+    for (int c = 0; c <= NUM_HAND_CATEGORIES; c++)
+        fprintf(f, "%s%d", c ? "," : "", category_first_rank[c]);
+    fprintf(f, "};\n\n");
+    write_table(f, "flush_ranks", flush);
+    write_table(f, "noflush5_ranks", noflush[5]);
+    write_table(f, "noflush6_ranks", noflush[6]);
+    write_table(f, "noflush7_ranks", noflush[7]);
+    return fclose(f) ? 1 : 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * Generates the preflop equity tables (preflop-equity.h):
+ * - the 169x169 starting hand class table, as C source
+ *   (preflop-classes.inc, checked in)
+ * - the 1326x1326 holding table, as a binary file to be mapped at runtime
+ *
+ * Pairs of holdings are reduced to their suit isomorphism classes (47008
+ * unordered pairs). Every board is ranked once for all holdings with the
+ * batch evaluator and the ranks of each class representative compared,
+ * which takes minutes instead of enumerating every pair separately.
+*/
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+#include "hand-eval.h"
+#include "preflop-equity.h"
+
+using namespace poker;
+
+struct holding {
+    card_t cards[NUM_PRIVATE_CARDS];
+    uint64_t mask;
+};
+
+// representative of an unordered pair of holdings and its board counts
+struct pair_class {
+    uint16_t first, second;
+    uint32_t first_wins, second_wins, ties;
+};
+
+static uint32_t holdings_key(const card_t cards[NUM_PLAYERS][NUM_PRIVATE_CARDS]) {
+    return cards[0][0] | cards[0][1] << 6 | cards[1][0] << 12 | cards[1][1] << 18;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: gen-preflop-equity <classes.inc> <table.bin>\n");
+        return 1;
+    }
+
+    holding holdings[NUM_HOLDINGS];
+    for (card_t c2 = 0; c2 < DECK_SIZE; c2++)
+        for (card_t c1 = 0; c1 < c2; c1++)
+            holdings[holding_index(c1, c2)] = {{c1, c2}, 1ull << c1 | 1ull << c2};
+
+    // class of every ordered pair, negative when ALICE holds the second
+    // holding of the representative
+    std::vector<int> pair_of(NUM_HOLDINGS * NUM_HOLDINGS, 0);
+    std::vector<pair_class> classes;
+    std::unordered_map<uint32_t, int> class_of_key;
+    for (int a = 0; a < NUM_HOLDINGS; a++) {
+        for (int b = 0; b < NUM_HOLDINGS; b++) {
+            if (holdings[a].mask & holdings[b].mask)
+                continue;
+            auto& ha = holdings[a].cards;
+            auto& hb = holdings[b].cards;
+            const card_t cards[NUM_PLAYERS][NUM_PRIVATE_CARDS] = {{ha[0], ha[1]}, {hb[0], hb[1]}};
+            const card_t reversed[NUM_PLAYERS][NUM_PRIVATE_CARDS] = {{hb[0], hb[1]}, {ha[0], ha[1]}};
+            card_t canonical[NUM_PLAYERS][NUM_PRIVATE_CARDS], swapped[NUM_PLAYERS][NUM_PRIVATE_CARDS];
+            canonical_holdings(cards, canonical);
+            canonical_holdings(reversed, swapped);
+            bool reverse = holdings_key(swapped) < holdings_key(canonical);
+            auto& rep = reverse ? swapped : canonical;
+            auto key = holdings_key(rep);
+            auto it = class_of_key.find(key);
+            int c;
+            if (it == class_of_key.end()) {
+                c = classes.size();
+                class_of_key[key] = c;
+                pair_class pc = {(uint16_t)holding_index(rep[0][0], rep[0][1]),
+                                 (uint16_t)holding_index(rep[1][0], rep[1][1]), 0, 0, 0};
+                classes.push_back(pc);
+            } else {
+                c = it->second;
+            }
+            pair_of[a * NUM_HOLDINGS + b] = reverse ? -(c + 1) : c + 1;
+        }
+    }
+    fprintf(stderr, "gen-preflop-equity: %zu isomorphism classes\n", classes.size());
+
+    std::vector<card_t> hands(NUM_HOLDINGS * HAND_SIZE);
+    std::vector<uint32_t> batch_ranks(NUM_HOLDINGS);
+    std::vector<int> batch_holdings(NUM_HOLDINGS);
+    uint16_t ranks[NUM_HOLDINGS];
+    card_t board[NUM_PUBLIC_CARDS];
+    for (board[0] = 0; board[0] < DECK_SIZE; board[0]++) {
+        fprintf(stderr, "gen-preflop-equity: boards from %d/%d\n", board[0] + 1, DECK_SIZE);
+        for (board[1] = board[0] + 1; board[1] < DECK_SIZE; board[1]++)
+        for (board[2] = board[1] + 1; board[2] < DECK_SIZE; board[2]++)
+        for (board[3] = board[2] + 1; board[3] < DECK_SIZE; board[3]++)
+        for (board[4] = board[3] + 1; board[4] < DECK_SIZE; board[4]++) {
+            uint64_t board_mask = 0;
+            for (int i = 0; i < NUM_PUBLIC_CARDS; i++)
+                board_mask |= 1ull << board[i];
+            size_t n = 0;
+            for (int h = 0; h < NUM_HOLDINGS; h++) {
+                ranks[h] = 0;
+                if (holdings[h].mask & board_mask)
+                    continue;
+                auto hand = hands.data() + n * HAND_SIZE;
+                std::copy(holdings[h].cards, holdings[h].cards + NUM_PRIVATE_CARDS, hand);
+                std::copy(board, board + NUM_PUBLIC_CARDS, hand + NUM_PRIVATE_CARDS);
+                batch_holdings[n++] = h;
+            }
+            rank_hands_unchecked(hands.data(), n, batch_ranks.data());
+            for (size_t i = 0; i < n; i++)
+                ranks[batch_holdings[i]] = batch_ranks[i];
+
+            // ranks are 0 for holdings that share a card with the board
+            for (auto& pc : classes) {
+                uint32_t r1 = ranks[pc.first], r2 = ranks[pc.second];
+                uint32_t valid = r1 && r2;
+                pc.first_wins += valid & (r1 > r2);
+                pc.second_wins += valid & (r1 < r2);
+                pc.ties += valid & (r1 == r2);
+            }
+        }
+    }
+
+    std::vector<float> table(NUM_HOLDINGS * NUM_HOLDINGS, -1);
+    std::vector<double> class_sums(NUM_PREFLOP_CLASSES * NUM_PREFLOP_CLASSES, 0);
+    std::vector<int> class_counts(NUM_PREFLOP_CLASSES * NUM_PREFLOP_CLASSES, 0);
+    for (int a = 0; a < NUM_HOLDINGS; a++) {
+        for (int b = 0; b < NUM_HOLDINGS; b++) {
+            auto c = pair_of[a * NUM_HOLDINGS + b];
+            if (!c)
+                continue;
+            auto& pc = classes[(c > 0 ? c : -c) - 1];
+            double equity = (pc.first_wins + pc.ties / 2.0) / (pc.first_wins + pc.second_wins + pc.ties);
+            if (c < 0)
+                equity = 1 - equity;
+            table[a * NUM_HOLDINGS + b] = equity;
+            auto k = preflop_class(holdings[a].cards[0], holdings[a].cards[1]) * NUM_PREFLOP_CLASSES +
+                     preflop_class(holdings[b].cards[0], holdings[b].cards[1]);
+            class_sums[k] += equity;
+            class_counts[k]++;
+        }
+    }
+
+    FILE* f = fopen(argv[1], "w");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+    fprintf(f, "// Generated by gen-preflop-equity, do not edit\n\n");
+    fprintf(f, "static const float preflop_class_equities[%d][%d] = {", NUM_PREFLOP_CLASSES, NUM_PREFLOP_CLASSES);
+    for (int c1 = 0; c1 < NUM_PREFLOP_CLASSES; c1++) {
+        fprintf(f, "\n    // %s\n    {", preflop_class_name(c1).c_str());
+        for (int c2 = 0; c2 < NUM_PREFLOP_CLASSES; c2++) {
+            auto k = c1 * NUM_PREFLOP_CLASSES + c2;
+            fprintf(f, "%s%s%.6f", c2 ? "," : "", c2 && c2 % NUM_RANKS == 0 ? "\n     " : "",
+                    class_sums[k] / class_counts[k]);
+        }
+        fprintf(f, "},");
+    }
+    fprintf(f, "};\n");
+    if (fclose(f))
+        return 1;
+
+    preflop_equity_header header = {PREFLOP_EQUITY_MAGIC, PREFLOP_EQUITY_VERSION, NUM_HOLDINGS, 0};
+    f = fopen(argv[2], "wb");
+    if (!f) {
+        perror(argv[2]);
+        return 1;
+    }
+    if (fwrite(&header, sizeof(header), 1, f) != 1 ||
+        fwrite(table.data(), sizeof(float), table.size(), f) != table.size()) {
+        perror(argv[2]);
+        return 1;
+    }
+    return fclose(f) ? 1 : 0;
+}
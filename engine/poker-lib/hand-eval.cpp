@@ -0,0 +1,229 @@
+#include "hand-eval.h"
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAND_EVAL_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace poker {
+
+#include "hand-tables.inc"
+
+const char* hand_category_names[NUM_HAND_CATEGORIES] = {
+    "NoPair", "OnePair", "TwoPair", "Trips", "Straight",
+    "Flush", "FlHouse", "Quads", "StFlush"};
+
+static const uint16_t* noflush_ranks[8] = {
+    NULL, NULL, NULL, NULL, NULL, noflush5_ranks, noflush6_ranks, noflush7_ranks};
+
+static uint16_t rank_masks(const uint32_t suit_masks[NUM_SUITS], const uint8_t counts[NUM_RANKS], int hand_size) {
+    // with at most 7 cards a flush beats anything but a straight
+    // flush, which flush_ranks covers
+    for (int s = 0; s < NUM_SUITS; s++)
+        if (hand_score_bit_count(suit_masks[s]) >= 5)
+            return flush_ranks[suit_masks[s]];
+
+    uint32_t hash = 0;
+    int left = hand_size;
+    for (int r = 0; r < NUM_RANKS && left; r++) {
+        hash += quinary_offsets[r][left][counts[r]];
+        left -= counts[r];
+    }
+    return noflush_ranks[hand_size][hash];
+}
+
+uint16_t rank_hand(const card_t* cards, int hand_size) {
+    uint32_t suit_masks[NUM_SUITS] = {0, 0, 0, 0};
+    uint8_t counts[NUM_RANKS] = {0};
+    for (int i = 0; i < hand_size; i++) {
+        int suit = cards[i] / NUM_RANKS;
+        int rank = cards[i] - suit * NUM_RANKS;
+        suit_masks[suit] |= 1 << rank;
+        counts[rank]++;
+    }
+    return rank_masks(suit_masks, counts, hand_size);
+}
+
+static void rank_hands_portable(const card_t* hands, size_t n, uint32_t* ranks) {
+    for (size_t i = 0; i < n; i++)
+        ranks[i] = rank_hand(hands + i * HAND_SIZE, HAND_SIZE);
+}
+
+#ifdef HAND_EVAL_AVX2
+
+// 16-bit table entries read with 32-bit gathers (tables are padded)
+__attribute__((target("avx2"))) static inline __m256i gather_u16(const uint16_t* table, __m256i index) {
+    return _mm256_and_si256(_mm256_i32gather_epi32((const int*)table, index, 2), _mm256_set1_epi32(0xffff));
+}
+
+// bits set in the low 16 bits of each lane
+__attribute__((target("avx2"))) static inline __m256i popcount_u16(__m256i v) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(v, nibble)),
+                                    _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+    return _mm256_and_si256(_mm256_add_epi32(bytes, _mm256_srli_epi32(bytes, 8)), _mm256_set1_epi32(0xff));
+}
+
+/*
+ * Eight hands at a time, one per 32-bit lane: suit masks are built from
+ * gathered cards, then the flush and rank count lookups of rank_hand are
+ * done with gathers
+*/
+__attribute__((target("avx2"))) static void rank_hands_avx2(const card_t* hands, size_t n, uint32_t* ranks) {
+    const __m256i lane_offsets = _mm256_setr_epi32(0, 1 * HAND_SIZE, 2 * HAND_SIZE, 3 * HAND_SIZE,
+                                                   4 * HAND_SIZE, 5 * HAND_SIZE, 6 * HAND_SIZE, 7 * HAND_SIZE);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i thirteen = _mm256_set1_epi32(NUM_RANKS);
+    const __m256i four = _mm256_set1_epi32(4);
+    const int rank_stride = sizeof(quinary_offsets[0]) / sizeof(quinary_offsets[0][0][0]);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const card_t* base = hands + i * HAND_SIZE;
+        __m256i masks[NUM_SUITS] = {zero, zero, zero, zero};
+        for (int c = 0; c < HAND_SIZE; c++) {
+            __m256i card = _mm256_i32gather_epi32(base + c, lane_offsets, 4);
+            // lanes with suit >= 1, >= 2 and >= 3
+            __m256i s1 = _mm256_cmpgt_epi32(card, _mm256_set1_epi32(NUM_RANKS - 1));
+            __m256i s2 = _mm256_cmpgt_epi32(card, _mm256_set1_epi32(2 * NUM_RANKS - 1));
+            __m256i s3 = _mm256_cmpgt_epi32(card, _mm256_set1_epi32(3 * NUM_RANKS - 1));
+            __m256i suit = _mm256_sub_epi32(zero, _mm256_add_epi32(_mm256_add_epi32(s1, s2), s3));
+            __m256i bit = _mm256_sllv_epi32(one, _mm256_sub_epi32(card, _mm256_mullo_epi32(suit, thirteen)));
+            masks[0] = _mm256_or_si256(masks[0], _mm256_andnot_si256(s1, bit));
+            masks[1] = _mm256_or_si256(masks[1], _mm256_and_si256(_mm256_andnot_si256(s2, s1), bit));
+            masks[2] = _mm256_or_si256(masks[2], _mm256_and_si256(_mm256_andnot_si256(s3, s2), bit));
+            masks[3] = _mm256_or_si256(masks[3], _mm256_and_si256(s3, bit));
+        }
+
+        __m256i flush_mask = zero;
+        for (int s = 0; s < NUM_SUITS; s++) {
+            __m256i is_flush = _mm256_cmpgt_epi32(popcount_u16(masks[s]), four);
+            flush_mask = _mm256_or_si256(flush_mask, _mm256_and_si256(is_flush, masks[s]));
+        }
+
+        __m256i hash = zero;
+        __m256i left = _mm256_set1_epi32(HAND_SIZE);
+        for (int r = 0; r < NUM_RANKS; r++) {
+            __m256i count = zero;
+            for (int s = 0; s < NUM_SUITS; s++)
+                count = _mm256_add_epi32(count, _mm256_and_si256(_mm256_srli_epi32(masks[s], r), one));
+            __m256i index = _mm256_add_epi32(_mm256_set1_epi32(r * rank_stride),
+                                             _mm256_add_epi32(_mm256_mullo_epi32(left, _mm256_set1_epi32(5)), count));
+            hash = _mm256_add_epi32(hash, _mm256_i32gather_epi32((const int*)&quinary_offsets[0][0][0], index, 4));
+            left = _mm256_sub_epi32(left, count);
+        }
+        __m256i rank = gather_u16(noflush7_ranks, hash);
+
+        if (!_mm256_testz_si256(flush_mask, flush_mask)) {
+            __m256i has_flush = _mm256_cmpgt_epi32(flush_mask, zero);
+            rank = _mm256_blendv_epi8(rank, gather_u16(flush_ranks, flush_mask), has_flush);
+        }
+        _mm256_storeu_si256((__m256i*)(ranks + i), rank);
+    }
+    rank_hands_portable(hands + i * HAND_SIZE, n - i, ranks + i);
+}
+
+#endif  // HAND_EVAL_AVX2
+
+void rank_hands_unchecked(const card_t* hands, size_t n, uint32_t* ranks) {
+#ifdef HAND_EVAL_AVX2
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2) {
+        rank_hands_avx2(hands, n, ranks);
+        return;
+    }
+#endif
+    rank_hands_portable(hands, n, ranks);
+}
+
+hand_category rank_category(uint16_t rank) {
+    int c = HAND_NO_PAIR;
+    while (c < HAND_STRAIGHT_FLUSH && rank >= category_first_rank[c + 1])
+        c++;
+    return (hand_category)c;
+}
+
+uint32_t hand_value(const card_t* cards, int hand_size) {
+    if (hand_size >= 5 && hand_size <= 7)
+        return rank_hand(cards, hand_size);
+
+    uint32_t suit_masks[NUM_SUITS] = {0, 0, 0, 0};
+    for (int i = 0; i < hand_size; i++)
+        suit_masks[cards[i] / NUM_RANKS] |= 1 << (cards[i] % NUM_RANKS);
+    return hand_score(suit_masks);
+}
+
+hand_category hand_value_category(uint32_t value, int hand_size) {
+    if (hand_size >= 5 && hand_size <= 7)
+        return rank_category(value);
+    return (hand_category)(value >> 20);
+}
+
+game_error check_hand(const card_t* cards, int hand_size) {
+    uint64_t seen = 0;
+    for (int i = 0; i < hand_size; i++) {
+        if (cards[i] < 0 || cards[i] >= NUM_RANKS * NUM_SUITS) {
+            logger_at(LOG_ERROR) << "unrecognized card " << cards[i];
+            return SRR_UNKNOWN_CARD;
+        }
+        if (seen >> cards[i] & 1) {
+            logger_at(LOG_ERROR) << "duplicated card " << cards[i];
+            return SRR_DUPLICATE_CARD;
+        }
+        seen |= 1ull << cards[i];
+    }
+    return SUCCESS;
+}
+
+void hand_strength::reset() {
+    num_cards = 0;
+    category = HAND_NO_PAIR;
+    rank = 0;
+    outs = 0;
+    seen = 0;
+    std::fill(suit_masks, suit_masks + NUM_SUITS, 0);
+    std::fill(counts, counts + NUM_RANKS, 0);
+}
+
+static hand_category category_of(const uint32_t suit_masks[NUM_SUITS], const uint8_t counts[NUM_RANKS],
+                                 int num_cards) {
+    if (num_cards >= 5 && num_cards <= HAND_SIZE)
+        return rank_category(rank_masks(suit_masks, counts, num_cards));
+    return (hand_category)(hand_score(suit_masks) >> 20);
+}
+
+void hand_strength::add_card(card_t card) {
+    if (card < 0 || card >= NUM_RANKS * NUM_SUITS || (seen >> card & 1) || num_cards == HAND_SIZE)
+        return;
+    int suit = card / NUM_RANKS, r = card % NUM_RANKS;
+    seen |= 1ull << card;
+    suit_masks[suit] |= 1 << r;
+    counts[r]++;
+    num_cards++;
+
+    rank = num_cards >= 5 ? rank_masks(suit_masks, counts, num_cards) : 0;
+    category = num_cards >= 5 ? rank_category(rank) : category_of(suit_masks, counts, num_cards);
+
+    // at most 47 single card lookups
+    outs = 0;
+    if (num_cards == 5 || num_cards == 6) {
+        for (card_t c = 0; c < NUM_RANKS * NUM_SUITS; c++) {
+            if (seen >> c & 1)
+                continue;
+            int s = c / NUM_RANKS, cr = c % NUM_RANKS;
+            suit_masks[s] |= 1 << cr;
+            counts[cr]++;
+            if (category_of(suit_masks, counts, num_cards + 1) > category)
+                outs++;
+            suit_masks[s] &= ~(1u << cr);
+            counts[cr]--;
+        }
+    }
+}
+
+}  // namespace poker
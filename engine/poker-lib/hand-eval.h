@@ -0,0 +1,67 @@
+#ifndef HAND_EVAL_H
+#define HAND_EVAL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common.h"
+#include "hand-score.h"
+
+namespace poker {
+
+/*
+ * Native hand evaluator.
+ * Ranks hands straight from card_t (0-51, suit * 13 + rank) with the
+ * lookup tables generated by gen-hand-tables at build time.
+*/
+
+const int NUM_HAND_RANKS = 7462;
+
+extern const char* hand_category_names[NUM_HAND_CATEGORIES];
+
+// Rank of the best five-card hand among 5 to 7 distinct, valid cards:
+// 1 (worst) .. NUM_HAND_RANKS (royal flush). Cards are not checked
+uint16_t rank_hand(const card_t* cards, int hand_size);
+
+hand_category rank_category(uint16_t rank);
+
+// rank_hand for n hands of HAND_SIZE cards stored one after another,
+// with an AVX2 kernel where the CPU supports it. Cards are not checked
+void rank_hands_unchecked(const card_t* hands, size_t n, uint32_t* ranks);
+
+// Value of a hand of any size; only comparable between hands of the
+// same size. Cards are not checked
+uint32_t hand_value(const card_t* cards, int hand_size);
+
+hand_category hand_value_category(uint32_t value, int hand_size);
+
+// Checks that cards are valid and distinct
+game_error check_hand(const card_t* cards, int hand_size);
+
+/*
+ * Strength of the cards a player can see, updated in constant time as
+ * each card is opened instead of ranking the whole hand on every read
+*/
+struct hand_strength {
+    hand_strength() { reset(); }
+
+    void reset();
+    // Unknown and already added cards are ignored
+    void add_card(card_t card);
+
+    int num_cards;
+    hand_category category;
+    // rank_hand of the cards, 0 with fewer than five
+    uint16_t rank;
+    // unseen cards that improve the category on the next street (with
+    // five or six cards, 0 otherwise)
+    int outs;
+
+    uint64_t seen;
+    uint32_t suit_masks[NUM_SUITS];
+    uint8_t counts[NUM_RANKS];
+};
+
+}  // namespace poker
+
+#endif
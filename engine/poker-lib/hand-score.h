@@ -0,0 +1,126 @@
+#ifndef HAND_SCORE_H
+#define HAND_SCORE_H
+
+#include <cstdint>
+
+namespace poker {
+
+/*
+ * Direct hand scoring from suit masks, for any number of cards.
+ * Used by gen-hand-tables to build the lookup tables and by the evaluator
+ * for hand sizes the tables do not cover. Same rules as poker-eval:
+ * straights and flushes need five cards, missing kickers count as lowest.
+ *
+ * A score is category << 20 followed by five 4-bit tie-break ranks
+ * (rank + 1, highest first, 0 when missing); higher scores win.
+*/
+
+const int NUM_RANKS = 13;
+const int NUM_SUITS = 4;
+
+enum hand_category {
+    HAND_NO_PAIR,
+    HAND_ONE_PAIR,
+    HAND_TWO_PAIR,
+    HAND_TRIPS,
+    HAND_STRAIGHT,
+    HAND_FLUSH,
+    HAND_FULL_HOUSE,
+    HAND_QUADS,
+    HAND_STRAIGHT_FLUSH,
+    NUM_HAND_CATEGORIES
+};
+
+inline int hand_score_bit_count(uint32_t mask) {
+    int n = 0;
+    for (; mask; mask &= mask - 1)
+        n++;
+    return n;
+}
+
+// Rank of the highest card of a straight in rank_mask, -1 if none
+inline int hand_score_straight(uint32_t rank_mask) {
+    for (int high = NUM_RANKS - 1; high >= 4; high--)
+        if (((rank_mask >> (high - 4)) & 0x1f) == 0x1f)
+            return high;
+    const uint32_t wheel = (1 << 12) | 0xf;  // A2345
+    return (rank_mask & wheel) == wheel ? 3 : -1;
+}
+
+inline uint32_t hand_score_make(int category, const int* ranks, int count) {
+    uint32_t score = category;
+    for (int i = 0; i < 5; i++)
+        score = (score << 4) | (i < count ? ranks[i] + 1 : 0);
+    return score;
+}
+
+// Appends the ranks in rank_mask from high to low, skipping `skip`, up to max
+inline int hand_score_kickers(uint32_t rank_mask, int skip1, int skip2, int* ranks, int count, int max) {
+    for (int r = NUM_RANKS - 1; r >= 0 && count < max; r--)
+        if ((rank_mask >> r & 1) && r != skip1 && r != skip2)
+            ranks[count++] = r;
+    return count;
+}
+
+inline uint32_t hand_score(const uint32_t suit_masks[NUM_SUITS]) {
+    int ranks[5];
+
+    uint32_t best_flush = 0;
+    for (int s = 0; s < NUM_SUITS; s++) {
+        if (hand_score_bit_count(suit_masks[s]) < 5)
+            continue;
+        uint32_t score;
+        int high = hand_score_straight(suit_masks[s]);
+        if (high >= 0) {
+            ranks[0] = high;
+            score = hand_score_make(HAND_STRAIGHT_FLUSH, ranks, 1);
+        } else {
+            score = hand_score_make(HAND_FLUSH, ranks, hand_score_kickers(suit_masks[s], -1, -1, ranks, 0, 5));
+        }
+        if (score > best_flush)
+            best_flush = score;
+    }
+    if (best_flush >> 20 == HAND_STRAIGHT_FLUSH)
+        return best_flush;
+
+    int count[NUM_RANKS];
+    uint32_t any = 0, pairs = 0, trips = 0, quads = 0;
+    for (int r = 0; r < NUM_RANKS; r++) {
+        count[r] = 0;
+        for (int s = 0; s < NUM_SUITS; s++)
+            count[r] += suit_masks[s] >> r & 1;
+        any |= (count[r] >= 1) << r;
+        pairs |= (count[r] >= 2) << r;
+        trips |= (count[r] >= 3) << r;
+        quads |= (count[r] >= 4) << r;
+    }
+
+    if (quads) {
+        hand_score_kickers(quads, -1, -1, ranks, 0, 1);
+        return hand_score_make(HAND_QUADS, ranks, hand_score_kickers(any, ranks[0], -1, ranks, 1, 2));
+    }
+    if (trips) {
+        hand_score_kickers(trips, -1, -1, ranks, 0, 1);
+        if (hand_score_kickers(pairs, ranks[0], -1, ranks, 1, 2) == 2)
+            return hand_score_make(HAND_FULL_HOUSE, ranks, 2);
+    }
+    if (best_flush)
+        return best_flush;
+    int high = hand_score_straight(any);
+    if (high >= 0) {
+        ranks[0] = high;
+        return hand_score_make(HAND_STRAIGHT, ranks, 1);
+    }
+    if (trips)
+        return hand_score_make(HAND_TRIPS, ranks, hand_score_kickers(any, ranks[0], -1, ranks, 1, 3));
+    int n = hand_score_kickers(pairs, -1, -1, ranks, 0, 2);
+    if (n == 2)
+        return hand_score_make(HAND_TWO_PAIR, ranks, hand_score_kickers(any, ranks[0], ranks[1], ranks, 2, 3));
+    if (n == 1)
+        return hand_score_make(HAND_ONE_PAIR, ranks, hand_score_kickers(any, ranks[0], -1, ranks, 1, 4));
+    return hand_score_make(HAND_NO_PAIR, ranks, hand_score_kickers(any, -1, -1, ranks, 0, 5));
+}
+
+}  // namespace poker
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef PARTICIPANT_H
 #define PARTICIPANT_H
 
+#include <iostream>
+
 #include "blob.h"
 #include "common.h"
 
@@ -19,7 +21,9 @@ class i_participant {
     virtual int num_participants() = 0;
     virtual bool predictable() = 0;
 
-    // initial group generation
+    // initial group generation.
+    // create_group, create_vsshe_group and prove_card_secret are only used
+    // by the players: the verify-only library returns VRF_VERIFY_ONLY
     virtual game_error create_group(blob& group) = 0;
     virtual game_error load_group(blob& group) = 0;
 
@@ -36,6 +40,9 @@ class i_participant {
     virtual game_error create_stack() = 0;
     virtual game_error shuffle_stack(blob& mixed_stack, blob& stack_proof) = 0;
     virtual game_error load_stack(blob& mixed_stack, blob& mixed_stack_proof) = 0;
+    // Loads the opponent's mixed stack and mixes it again.
+    // Same outcome as load_stack() followed by shuffle_stack()
+    virtual game_error load_and_shuffle_stack(blob& their_stack, blob& their_proof, blob& mixed_stack, blob& stack_proof) = 0;
 
     // Cards
     virtual game_error take_cards_from_stack(int count) = 0;
@@ -44,6 +51,11 @@ class i_participant {
     virtual game_error verify_card_secret(int card_index, blob& their_proof) = 0;
     virtual game_error open_card(int card_index) = 0;
     virtual size_t get_open_card(int card_index) = 0;
+
+    // Checkpoint of the protocol state (keys, stacks, secrets, opened cards).
+    // restore expects a participant initialized with the same init() arguments
+    virtual game_error save(std::ostream& os) = 0;
+    virtual game_error restore(std::istream& is) = 0;
 };
 
 }  // namespace poker
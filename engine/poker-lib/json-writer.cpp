@@ -0,0 +1,111 @@
+#include "json-writer.h"
+
+namespace poker {
+
+json_writer& json_writer::begin_object() {
+    separate();
+    _out += '{';
+    return *this;
+}
+
+json_writer& json_writer::end_object() {
+    _out += '}';
+    _need_comma = true;
+    return *this;
+}
+
+json_writer& json_writer::begin_array() {
+    separate();
+    _out += '[';
+    return *this;
+}
+
+json_writer& json_writer::end_array() {
+    _out += ']';
+    _need_comma = true;
+    return *this;
+}
+
+json_writer& json_writer::key(const char* name) {
+    value(name);
+    _out += ": ";
+    _need_comma = false;
+    return *this;
+}
+
+json_writer& json_writer::write_int(int64_t v) {
+    if (v >= 0)
+        return write_uint(v);
+    separate();
+    _out += '-';
+    // no overflow on INT64_MIN
+    write_uint(0 - (uint64_t)v);
+    return *this;
+}
+
+json_writer& json_writer::write_uint(uint64_t v) {
+    char digits[20];
+    char* p = digits + sizeof(digits);
+    do {
+        *--p = '0' + v % 10;
+        v /= 10;
+    } while (v);
+    separate();
+    _out.append(p, digits + sizeof(digits) - p);
+    _need_comma = true;
+    return *this;
+}
+
+json_writer& json_writer::value(bool v) {
+    separate();
+    _out += v ? "true" : "false";
+    _need_comma = true;
+    return *this;
+}
+
+json_writer& json_writer::value(const char* s) {
+    static const char hex[] = "0123456789abcdef";
+    separate();
+    _out += '"';
+    for (; *s; s++) {
+        unsigned char c = *s;
+        if (c == '"' || c == '\\') {
+            _out += '\\';
+            _out += c;
+        } else if (c < 0x20) {
+            _out += "\\u00";
+            _out += hex[c >> 4];
+            _out += hex[c & 0xf];
+        } else {
+            _out += c;
+        }
+    }
+    _out += '"';
+    _need_comma = true;
+    return *this;
+}
+
+json_writer& json_writer::value(const money_t& v) {
+    separate();
+    _out += '"';
+    v.append_string(_out);
+    _out += '"';
+    _need_comma = true;
+    return *this;
+}
+
+json_writer& json_writer::null_value() {
+    separate();
+    _out += "null";
+    _need_comma = true;
+    return *this;
+}
+
+json_writer& json_writer::raw(const char* json) {
+    separate();
+    _out += json;
+    _need_comma = true;
+    return *this;
+}
+
+}  // namespace poker
@@ -0,0 +1,59 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstdint>
+#include <string>
+
+#include "bignumber.h"
+
+namespace poker {
+
+/*
+ * Streaming JSON writer.
+ * Appends JSON to a caller-provided string; reusing the same string
+ * across calls keeps its capacity, so nothing is allocated once it has
+ * grown. Separators between members and elements are inserted by the
+ * writer. money_t values are written as decimal strings.
+*/
+class json_writer {
+    std::string& _out;
+    bool _need_comma;
+
+    void separate() {
+        if (_need_comma)
+            _out += ", ";
+        _need_comma = false;
+    }
+    json_writer& write_int(int64_t v);
+    json_writer& write_uint(uint64_t v);
+
+   public:
+    explicit json_writer(std::string& out) : _out(out), _need_comma(false) {}
+
+    std::string& buffer() { return _out; }
+
+    json_writer& begin_object();
+    json_writer& end_object();
+    json_writer& begin_array();
+    json_writer& end_array();
+    json_writer& key(const char* name);
+
+    json_writer& value(int v) { return write_int(v); }
+    json_writer& value(long v) { return write_int(v); }
+    json_writer& value(long long v) { return write_int(v); }
+    json_writer& value(unsigned v) { return write_uint(v); }
+    json_writer& value(unsigned long v) { return write_uint(v); }
+    json_writer& value(unsigned long long v) { return write_uint(v); }
+    json_writer& value(bool v);
+    json_writer& value(const char* s);
+    json_writer& value(const std::string& s) { return value(s.c_str()); }
+    json_writer& value(const money_t& v);
+    json_writer& null_value();
+
+    // Already serialized JSON: a value, or members when inside an object
+    json_writer& raw(const char* json);
+};
+
+}  // namespace poker
+
+#endif
@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef POKER_THREADS
+#include <thread>
+#endif
+
+#include "codec.h"
+#include "messages.h"
+#include "compression.h"
+#include "game-generator.h"
+#include "poker-lib.h"
+
+using namespace poker;
+
+/*
+ * Self-play load generator.
+ * Plays many hands concurrently through game_generator, with configurable
+ * betting strategies, and reports hands/sec, per-message latency
+ * histograms and bytes on the wire per message type as JSON on stdout.
+ *
+ * Usage: loadgen [-n <hands>] [-t <threads>] [-s <strategy>[,<strategy>]]
+ *                [--no-encryption] [--seed <n>]
+ *   strategies: random, aggressive, check-down,
+ *               fold-at-preflop, fold-at-flop, fold-at-turn, fold-at-river
+ *   a single strategy is used by both players; two are alice,bob
+*/
+
+enum strategy_kind {
+    STRAT_RANDOM,
+    STRAT_AGGRESSIVE,
+    STRAT_CHECK_DOWN,
+    STRAT_FOLD_AT,
+};
+
+struct strategy {
+    strategy_kind kind;
+    bet_phase fold_phase;
+
+    strategy() : kind(STRAT_CHECK_DOWN), fold_phase(PHS_PREFLOP) {}
+
+    bool parse(const std::string& s) {
+        if (s == "random") {
+            kind = STRAT_RANDOM;
+        } else if (s == "aggressive") {
+            kind = STRAT_AGGRESSIVE;
+        } else if (s == "check-down") {
+            kind = STRAT_CHECK_DOWN;
+        } else if (s.compare(0, 8, "fold-at-") == 0) {
+            kind = STRAT_FOLD_AT;
+            auto phase = s.substr(8);
+            if (phase == "preflop")
+                fold_phase = PHS_PREFLOP;
+            else if (phase == "flop")
+                fold_phase = PHS_FLOP;
+            else if (phase == "turn")
+                fold_phase = PHS_TURN;
+            else if (phase == "river")
+                fold_phase = PHS_RIVER;
+            else
+                return false;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    // picks a bet that is valid for player p in game g
+    void choose(std::mt19937& rng, int p, game_state& g, bet_type& type, money_t& amount) {
+        auto& me = g.players[p];
+        auto& opponent = g.players[opponent_id(p)];
+        money_t to_call = me.bets < opponent.bets ? opponent.bets - me.bets : money_t(0);
+        bet_type passive = to_call > money_t(0) ? BET_CALL : BET_CHECK;
+
+        // a raise must not exceed the opponent's funds nor ours
+        money_t max_raise = opponent.total_funds - opponent.bets;
+        money_t my_room = me.total_funds - me.bets - to_call;
+        if (my_room < max_raise)
+            max_raise = my_room;
+        bool can_raise = me.bets <= opponent.bets && max_raise >= g.big_blind;
+
+        amount = 0;
+        type = passive;
+        switch (kind) {
+            case STRAT_CHECK_DOWN:
+                break;
+            case STRAT_AGGRESSIVE:
+                if (can_raise) {
+                    type = BET_RAISE;
+                    amount = g.big_blind;
+                }
+                break;
+            case STRAT_FOLD_AT:
+                if (g.phase >= fold_phase)
+                    type = BET_FOLD;
+                break;
+            case STRAT_RANDOM: {
+                // weights: passive 6, raise 3, fold 1 (only when facing a bet)
+                auto r = std::uniform_int_distribution<int>(0, 9)(rng);
+                if (r < 3 && can_raise) {
+                    type = BET_RAISE;
+                    amount = g.big_blind * money_t(1 + r);
+                    if (amount > max_raise)
+                        amount = g.big_blind;
+                } else if (r == 9 && passive == BET_CALL) {
+                    type = BET_FOLD;
+                }
+                break;
+            }
+        }
+    }
+};
+
+/*
+ * Latency histogram with power of two buckets, in microseconds
+*/
+struct histogram {
+    static const int num_buckets = 40;
+    uint64_t buckets[num_buckets];
+    uint64_t count;
+    double sum_us;
+    double max_us;
+
+    histogram() : count(0), sum_us(0), max_us(0) {
+        std::fill(buckets, buckets + num_buckets, 0);
+    }
+
+    void add(double us) {
+        int b = us < 1 ? 0 : std::min(num_buckets - 1, 1 + (int)std::log2(us));
+        buckets[b]++;
+        count++;
+        sum_us += us;
+        max_us = std::max(max_us, us);
+    }
+
+    void merge(const histogram& other) {
+        for (int i = 0; i < num_buckets; i++)
+            buckets[i] += other.buckets[i];
+        count += other.count;
+        sum_us += other.sum_us;
+        max_us = std::max(max_us, other.max_us);
+    }
+
+    // upper bound of the bucket holding the p-th percentile
+    double percentile(double p) {
+        uint64_t rank = (uint64_t)std::ceil(p / 100.0 * count);
+        uint64_t seen = 0;
+        for (int i = 0; i < num_buckets; i++) {
+            seen += buckets[i];
+            if (seen >= rank && seen)
+                return std::min((double)(1ull << i), max_us);
+        }
+        return max_us;
+    }
+
+    void write_json(std::ostream& os) {
+        os << "{\"count\":" << count
+           << ",\"mean_us\":" << (count ? sum_us / count : 0)
+           << ",\"p50_us\":" << percentile(50)
+           << ",\"p90_us\":" << percentile(90)
+           << ",\"p99_us\":" << percentile(99)
+           << ",\"max_us\":" << max_us
+           << ",\"buckets\":[";
+        // bucket i counts latencies below 2^i us
+        int last = num_buckets - 1;
+        while (last > 0 && !buckets[last])
+            last--;
+        for (int i = 0; i <= last; i++)
+            os << (i ? "," : "") << buckets[i];
+        os << "]}";
+    }
+};
+
+// Statistics of one worker thread, merged at the end
+struct load_stats {
+    uint64_t hands;
+    uint64_t errors;
+    uint64_t winners[3];  // alice, bob, tie
+    histogram latency[num_message_types];
+    uint64_t bytes[num_message_types];
+
+    load_stats() : hands(0), errors(0), winners{0, 0, 0} {
+        std::fill(bytes, bytes + num_message_types, 0);
+    }
+
+    void merge(const load_stats& other) {
+        hands += other.hands;
+        errors += other.errors;
+        for (int i = 0; i < 3; i++)
+            winners[i] += other.winners[i];
+        for (int i = 0; i < num_message_types; i++) {
+            latency[i].merge(other.latency[i]);
+            bytes[i] += other.bytes[i];
+        }
+    }
+};
+
+static int num_hands = 100;
+static int num_threads = 1;
+static unsigned int seed = 1;
+static strategy strategies[NUM_PLAYERS];
+static std::atomic<int> next_hand(0);
+
+static game_error peek_message_type(const std::string& msg, message_type& type) {
+    game_error res;
+    std::string raw;
+    if ((res = unwrap_and_decompress(msg, raw)))
+        return res;
+    std::istringstream is(raw);
+    decoder in(is);
+    return in.read(type);
+}
+
+static void play_hands(load_stats* stats) {
+    int hand;
+    while ((hand = next_hand++) < num_hands) {
+        std::mt19937 rng(seed + hand);
+        game_generator gen;
+        gen.bet_strategy = [&](int p, game_state& g, bet_type& type, money_t& amount) {
+            strategies[p].choose(rng, p, g, type, amount);
+        };
+        gen.on_message = [&](int p, const std::string& msg, double elapsed_us) {
+            message_type type;
+            if (peek_message_type(msg, type) || type < 0 || type >= num_message_types)
+                return;
+            stats->latency[type].add(elapsed_us);
+            stats->bytes[type] += msg.size();
+        };
+
+        game_error res;
+        if ((res = gen.generate())) {
+            logger_at(LOG_ERROR) << "*** hand " << hand << " failed: " << res << std::endl;
+            stats->errors++;
+            continue;
+        }
+        stats->hands++;
+        auto w = gen.alice_game.winner;
+        stats->winners[w == ALICE ? 0 : w == BOB ? 1 : 2]++;
+    }
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [-n <hands>] [-t <threads>] [-s <strategy>[,<strategy>]] [--no-encryption] [--seed <n>]\n", prog);
+    exit(-1);
+}
+
+int main(int argc, char** argv) {
+    poker_lib_options opt;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            num_hands = std::stoi(argv[++i]);
+        } else if (arg == "-t" && i + 1 < argc) {
+            num_threads = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = std::stoul(argv[++i]);
+        } else if (arg == "--no-encryption") {
+            opt.encryption = false;
+        } else if (arg == "-s" && i + 1 < argc) {
+            std::string s = argv[++i];
+            auto comma = s.find(',');
+            auto alice = s.substr(0, comma);
+            auto bob = comma == std::string::npos ? alice : s.substr(comma + 1);
+            if (!strategies[ALICE].parse(alice) || !strategies[BOB].parse(bob))
+                usage(argv[0]);
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+#ifndef POKER_THREADS
+    num_threads = 1;
+#endif
+
+    init_poker_lib(&opt);
+
+    std::vector<load_stats> stats(num_threads);
+    auto t0 = std::chrono::steady_clock::now();
+#ifdef POKER_THREADS
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++)
+        threads.push_back(std::thread(play_hands, &stats[i]));
+    for (auto& t : threads)
+        t.join();
+#else
+    play_hands(&stats[0]);
+#endif
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    load_stats total;
+    for (auto& s : stats)
+        total.merge(s);
+
+    std::cout << "{\"hands\":" << total.hands
+              << ",\"errors\":" << total.errors
+              << ",\"threads\":" << num_threads
+              << ",\"encryption\":" << (opt.encryption ? "true" : "false")
+              << ",\"elapsed_s\":" << elapsed
+              << ",\"hands_per_sec\":" << (elapsed > 0 ? total.hands / elapsed : 0)
+              << ",\"winners\":{\"alice\":" << total.winners[0]
+              << ",\"bob\":" << total.winners[1]
+              << ",\"tie\":" << total.winners[2] << "}"
+              << ",\"messages\":{";
+    bool first = true;
+    for (int i = 0; i < num_message_types; i++) {
+        if (!total.latency[i].count)
+            continue;
+        std::cout << (first ? "" : ",") << "\"" << message_type_names[i] << "\":{"
+                  << "\"bytes\":" << total.bytes[i]
+                  << ",\"bytes_per_msg\":" << (double)total.bytes[i] / total.latency[i].count
+                  << ",\"latency\":";
+        total.latency[i].write_json(std::cout);
+        std::cout << "}";
+        first = false;
+    }
+    std::cout << "}}" << std::endl;
+
+    fprintf(stderr, "%llu hands (%llu errors) in %.2fs: %.2f hands/sec\n",
+            (unsigned long long)total.hands, (unsigned long long)total.errors,
+            elapsed, elapsed > 0 ? total.hands / elapsed : 0);
+    for (int i = 0; i < num_message_types; i++) {
+        auto& h = total.latency[i];
+        if (h.count)
+            fprintf(stderr, "%-18s %8llu msgs  %10.0f bytes/msg  p50 %10.0f us  p99 %10.0f us\n",
+                    message_type_names[i], (unsigned long long)h.count,
+                    (double)total.bytes[i] / h.count, h.percentile(50), h.percentile(99));
+    }
+
+    return total.errors ? 1 : 0;
+}
@@ -0,0 +1,378 @@
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#ifdef POKER_THREADS
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace poker {
+
+bool logging_enabled = false;
+
+namespace {
+
+const int max_modules = 64;
+const uint64_t queue_capacity = 4096;  // power of two
+const auto relaxed = std::memory_order_relaxed;
+
+const char* level_names[] = {"error", "warn", "info", "debug", "trace"};
+
+struct log_record {
+    uint64_t ts_us;
+    int level;
+    const char* module;
+    int thread;
+    std::string msg;
+};
+
+/*
+ * Module table. Entries are never removed, so call sites may keep
+ * references; lookups by name happen once per call site
+*/
+log_module modules[max_modules];
+std::atomic<int> num_modules(0);
+std::atomic<int> default_level(LOG_DEBUG);
+
+#ifdef POKER_THREADS
+std::mutex modules_mutex;
+#endif
+
+std::ostream* output = &std::cerr;
+
+const std::chrono::steady_clock::time_point log_epoch = std::chrono::steady_clock::now();
+
+uint64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - log_epoch).count();
+}
+
+int module_index(const char* name) {
+    auto n = num_modules.load(std::memory_order_acquire);
+    for (int i = 0; i < n; i++)
+        if (0 == strcmp(modules[i].name, name))
+            return i;
+    return -1;
+}
+
+// callers hold modules_mutex
+log_module& add_module(const char* name, size_t len) {
+    char key[sizeof(modules[0].name)];
+    len = std::min(len, sizeof(key) - 1);
+    memcpy(key, name, len);
+    key[len] = 0;
+
+    auto i = module_index(key);
+    if (i >= 0)
+        return modules[i];
+    auto n = num_modules.load(relaxed);
+    if (n == max_modules)
+        n--;  // out of slots: share the last one
+    else {
+        memcpy(modules[n].name, key, len + 1);
+        modules[n].level.store(default_level.load(relaxed), relaxed);
+        num_modules.store(n + 1, std::memory_order_release);
+    }
+    return modules[n];
+}
+
+bool parse_level(const char* s, size_t len, log_level& level) {
+    for (int i = LOG_ERROR; i <= LOG_TRACE; i++) {
+        if (strlen(level_names[i]) == len && 0 == strncmp(level_names[i], s, len)) {
+            level = (log_level)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// logfmt line: ts=... level=... module=... thread=... msg="..."
+void write_record(std::ostream& os, const log_record& r) {
+    std::string line;
+    line.reserve(r.msg.size() + 64);
+    line += "ts=" + std::to_string(r.ts_us / 1000000) + ".";
+    auto frac = std::to_string(r.ts_us % 1000000);
+    line.append(6 - frac.size(), '0');
+    line += frac;
+    line += " level=";
+    line += level_names[r.level];
+    line += " module=";
+    line += r.module;
+    line += " thread=" + std::to_string(r.thread) + " msg=\"";
+    auto begin = r.msg.find_first_not_of(" \n");
+    auto end = r.msg.find_last_not_of(" \n");
+    for (auto i = begin; end != std::string::npos && i <= end; i++) {
+        char c = r.msg[i];
+        switch (c) {
+            case '"': line += "\\\""; break;
+            case '\\': line += "\\\\"; break;
+            case '\n': line += "\\n"; break;
+            case '\t': line += "\\t"; break;
+            default: line += c;
+        }
+    }
+    line += "\"\n";
+    os << line;
+}
+
+#ifdef POKER_THREADS
+
+/*
+ * Bounded multi-producer queue (Vyukov). Producers never block: a push into
+ * a full queue fails and the line is counted as dropped. A single background
+ * thread pops and writes
+*/
+class log_queue {
+    struct cell {
+        std::atomic<uint64_t> seq;
+        log_record record;
+    };
+    cell _cells[queue_capacity];
+    char _pad0[64];
+    std::atomic<uint64_t> _enqueue_pos;
+    char _pad1[64];
+    std::atomic<uint64_t> _dequeue_pos;
+
+   public:
+    log_queue() : _enqueue_pos(0), _dequeue_pos(0) {
+        for (uint64_t i = 0; i < queue_capacity; i++)
+            _cells[i].seq.store(i, relaxed);
+    }
+
+    bool push(log_record& r) {
+        auto pos = _enqueue_pos.load(relaxed);
+        for (;;) {
+            auto& c = _cells[pos & (queue_capacity - 1)];
+            auto seq = c.seq.load(std::memory_order_acquire);
+            auto diff = (int64_t)seq - (int64_t)pos;
+            if (diff == 0) {
+                if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, relaxed)) {
+                    c.record = std::move(r);
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;  // full
+            } else {
+                pos = _enqueue_pos.load(relaxed);
+            }
+        }
+    }
+
+    // single consumer
+    bool pop(log_record& r) {
+        auto pos = _dequeue_pos.load(relaxed);
+        auto& c = _cells[pos & (queue_capacity - 1)];
+        if (c.seq.load(std::memory_order_acquire) != pos + 1)
+            return false;
+        r = std::move(c.record);
+        _dequeue_pos.store(pos + 1, relaxed);
+        c.seq.store(pos + queue_capacity, std::memory_order_release);
+        return true;
+    }
+};
+
+class log_writer {
+    log_queue _queue;
+    std::atomic<uint64_t> _pushed;
+    std::atomic<uint64_t> _written;
+    std::atomic<uint64_t> _dropped;
+    std::atomic<bool> _stop;
+    std::atomic<bool> _running;
+    std::mutex _mutex;  // only for the writer's sleep and output changes
+    std::condition_variable _cv;
+    std::once_flag _started;
+    std::thread _thread;
+
+    void run() {
+        log_record r;
+        uint64_t reported_dropped = 0;
+        for (;;) {
+            bool idle = true;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                while (_queue.pop(r)) {
+                    write_record(*output, r);
+                    _written.fetch_add(1, std::memory_order_release);
+                    idle = false;
+                }
+                auto dropped = _dropped.load(relaxed);
+                if (dropped != reported_dropped) {
+                    log_record d = {now_us(), LOG_WARN, "log", 0,
+                                    std::to_string(dropped - reported_dropped) + " lines dropped"};
+                    write_record(*output, d);
+                    reported_dropped = dropped;
+                }
+                output->flush();
+            }
+            if (_stop.load())
+                break;
+            if (!idle)
+                continue;
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+
+   public:
+    log_writer() : _pushed(0), _written(0), _dropped(0), _stop(false), _running(false) {}
+
+    ~log_writer() {
+        _stop.store(true);
+        _cv.notify_one();
+        if (_thread.joinable())
+            _thread.join();
+    }
+
+    void push(log_record& r) {
+        if (_stop.load(relaxed)) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            write_record(*output, r);
+            return;
+        }
+        std::call_once(_started, [this]() {
+            _thread = std::thread(&log_writer::run, this);
+            _running.store(true);
+        });
+        if (_queue.push(r))
+            _pushed.fetch_add(1, relaxed);
+        else
+            _dropped.fetch_add(1, relaxed);
+    }
+
+    void flush() {
+        auto target = _pushed.load();
+        if (!_running.load())
+            return;
+        while (_written.load(std::memory_order_acquire) < target) {
+            _cv.notify_one();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        output->flush();
+    }
+
+    void set_output(std::ostream* os) {
+        flush();
+        std::lock_guard<std::mutex> lock(_mutex);
+        output = os;
+    }
+
+    uint64_t dropped() { return _dropped.load(relaxed); }
+};
+
+log_writer& writer() {
+    static log_writer w;
+    return w;
+}
+
+int thread_number() {
+    static std::atomic<int> next_thread(1);
+    thread_local int n = next_thread.fetch_add(1, relaxed);
+    return n;
+}
+
+#else
+
+int thread_number() {
+    return 1;
+}
+
+#endif
+
+}  // namespace
+
+log_module& get_log_module(const char* file) {
+    auto base = strrchr(file, '/');
+    base = base ? base + 1 : file;
+    auto dot = strchr(base, '.');
+    auto len = dot ? dot - base : strlen(base);
+#ifdef POKER_THREADS
+    std::lock_guard<std::mutex> lock(modules_mutex);
+#endif
+    return add_module(base, len);
+}
+
+void set_log_level(log_level level) {
+#ifdef POKER_THREADS
+    std::lock_guard<std::mutex> lock(modules_mutex);
+#endif
+    default_level.store(level, relaxed);
+    auto n = num_modules.load(relaxed);
+    for (int i = 0; i < n; i++)
+        modules[i].level.store(level, relaxed);
+}
+
+void set_log_level(const char* module, log_level level) {
+#ifdef POKER_THREADS
+    std::lock_guard<std::mutex> lock(modules_mutex);
+#endif
+    add_module(module, strlen(module)).level.store(level, relaxed);
+}
+
+bool set_log_levels(const char* spec) {
+    if (!spec)
+        return true;
+    bool ok = true;
+    while (*spec) {
+        auto end = strchr(spec, ',');
+        auto len = end ? (size_t)(end - spec) : strlen(spec);
+        auto eq = (const char*)memchr(spec, '=', len);
+        log_level level;
+        if (!eq) {
+            if (parse_level(spec, len, level))
+                set_log_level(level);
+            else
+                ok = false;
+        } else if (parse_level(eq + 1, spec + len - eq - 1, level)) {
+            std::string module(spec, eq - spec);
+            set_log_level(module.c_str(), level);
+        } else {
+            ok = false;
+        }
+        spec += len;
+        if (*spec)
+            spec++;
+    }
+    return ok;
+}
+
+void set_log_output(std::ostream* os) {
+#ifdef POKER_THREADS
+    writer().set_output(os);
+#else
+    output = os;
+#endif
+}
+
+void flush_log() {
+#ifdef POKER_THREADS
+    writer().flush();
+#else
+    output->flush();
+#endif
+}
+
+uint64_t dropped_log_lines() {
+#ifdef POKER_THREADS
+    return writer().dropped();
+#else
+    return 0;
+#endif
+}
+
+log_line::~log_line() {
+    log_record r = {now_us(), _level, _module, thread_number(), _os.str()};
+#ifdef POKER_THREADS
+    writer().push(r);
+#else
+    write_record(*output, r);
+#endif
+}
+
+}  // namespace poker
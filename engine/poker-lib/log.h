@@ -0,0 +1,92 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+namespace poker {
+
+/*
+ * Structured logging.
+ * Each line carries a level and the module (source file) that wrote it.
+ * Lines are formatted by the caller, pushed into a bounded lock-free queue
+ * and written as logfmt by a background thread; when the queue is full
+ * lines are dropped and counted instead of blocking the caller.
+ * Without threads lines are written synchronously.
+*/
+
+extern bool logging_enabled;
+
+enum log_level {
+    LOG_ERROR,
+    LOG_WARN,
+    LOG_INFO,
+    LOG_DEBUG,
+    LOG_TRACE,
+};
+
+struct log_module {
+    char name[32];
+    std::atomic<int> level;
+};
+
+// Returns the module of a source file (basename without extension)
+log_module& get_log_module(const char* file);
+
+// Sets the level of all modules
+void set_log_level(log_level level);
+// Sets the level of one module
+void set_log_level(const char* module, log_level level);
+// Applies a spec like "info,participant=trace,referee=warn"; false on parse error
+bool set_log_levels(const char* spec);
+
+// Redirects output (default std::cerr); os must outlive the logger
+void set_log_output(std::ostream* os);
+// Waits until all queued lines are written
+void flush_log();
+// Lines dropped because the queue was full
+uint64_t dropped_log_lines();
+
+class log_line {
+    log_level _level;
+    const char* _module;
+    std::ostringstream _os;
+
+   public:
+    log_line(log_level level, const char* module) : _level(level), _module(module) {}
+    ~log_line();
+
+    template <typename T>
+    log_line& operator<<(const T& value) {
+        _os << value;
+        return *this;
+    }
+    log_line& operator<<(std::ostream& (*manip)(std::ostream&)) {
+        _os << manip;
+        return *this;
+    }
+    log_line& operator<<(std::ios_base& (*manip)(std::ios_base&)) {
+        _os << manip;
+        return *this;
+    }
+
+    log_line(const log_line&) = delete;
+    void operator=(const log_line&) = delete;
+};
+
+// The module of the calling file, looked up once per call site
+#define LOG_MODULE() ([]() -> poker::log_module& { static poker::log_module& m = poker::get_log_module(__FILE__); return m; }())
+
+// Logs at the given level, e.g. logger_at(LOG_TRACE) << "card " << i;
+// arguments are not evaluated when the level is disabled
+#define logger_at(lvl)                                                                              \
+    if (!poker::logging_enabled || LOG_MODULE().level.load(std::memory_order_relaxed) < (lvl)) {    \
+    } else                                                                                          \
+        poker::log_line((lvl), LOG_MODULE().name)
+
+}  // namespace poker
+
+#endif
@@ -1,13 +1,19 @@
 #include <sstream>
 #include "poker-lib.h"
 #include "messages.h"
+#include "trace.h"
 
 namespace poker {
 
-message::message(message_type t) : _version(poker_version), _msgtype(t), player_id(-1) {
+const char* message_type_names[num_message_types] = {
+    "vtmf", "vtmf_response", "vsshe", "vsshe_response",
+    "bob_private_cards", "bet_request", "card_proof"};
+
+message::message(message_type t) : _version(message_version()), _msgtype(t), player_id(-1) {
 }
 
 game_error message::decode(std::istream& is, message** msg) {
+    TRACE_FUNC("codec");
     game_error res;
 
     decoder in(is);
@@ -64,7 +70,10 @@ game_error message::read(std::istream& is)  {
     decoder in(is);
     // _msgtype has already been read by message::decode()
     if ((res=in.read(_version))) return res;
-    if (_version != poker_version) return COD_VERSION_MISMATCH;
+    // either backend: players check that it is theirs, playback that it
+    // stays the same throughout the game
+    participant_backend backend;
+    if ((res=backend_of_version(_version, backend))) return res;
     if ((res=in.read(player_id))) return res;
     return SUCCESS;
 }
@@ -73,6 +82,7 @@ msg_vtmf::msg_vtmf() : message(MSG_VTMF) {
 }
 
 game_error msg_vtmf::write(std::ostream& os)  {
+    TRACE_FUNC("codec");
     game_error res;
     if ((res=message::write(os))) return res;
 
@@ -106,6 +116,7 @@ msg_vtmf_response::msg_vtmf_response() : message(MSG_VTMF_RESPONSE) {
 }
 
 game_error msg_vtmf_response::write(std::ostream& os)  {
+    TRACE_FUNC("codec");
     game_error res;
     if ((res=message::write(os))) return res;
 
@@ -137,6 +148,7 @@ msg_vsshe::msg_vsshe() : message(MSG_VSSHE) {
 }
 
 game_error msg_vsshe::write(std::ostream& os)  {
+    TRACE_FUNC("codec");
     game_error res;
     if ((res=message::write(os))) return res;
 
@@ -166,6 +178,7 @@ msg_vsshe_response::msg_vsshe_response() : message(MSG_VSSHE_RESPONSE) {
 }
 
 game_error msg_vsshe_response::write(std::ostream& os)  {
+    TRACE_FUNC("codec");
     game_error res;
     if ((res=message::write(os))) return res;
 
@@ -195,6 +208,7 @@ msg_bob_private_cards::msg_bob_private_cards() : message(MSG_BOB_PRIVATE_CARDS)
 }
 
 game_error msg_bob_private_cards::write(std::ostream& os)  {
+    TRACE_FUNC("codec");
     game_error res;
     if ((res=message::write(os))) return res;
 
@@ -221,6 +235,7 @@ msg_bet_request::msg_bet_request() : message(MSG_BET_REQUEST) {
 }
 
 game_error msg_bet_request::write(std::ostream& os)  {
+    TRACE_FUNC("codec");
     game_error res;
     if ((res=message::write(os))) return res;
 
@@ -253,6 +268,7 @@ msg_card_proof::msg_card_proof() : message(MSG_CARD_PROOF), muck(false) {
 }
 
 game_error msg_card_proof::write(std::ostream& os)  {
+    TRACE_FUNC("codec");
     game_error res;
     if ((res=message::write(os))) return res;
 
@@ -6,6 +6,11 @@
 
 namespace poker {
 
+   const int num_message_types = MSG_CARD_PROOF + 1;
+
+   // names of message types, indexed by message_type
+   extern const char* message_type_names[num_message_types];
+
    /*
     *  Messages transfered during live game and result verification
    */
@@ -0,0 +1,163 @@
+#include "metrics.h"
+
+namespace poker {
+
+static const char* game_step_names[num_game_steps] = {
+    "init_game", "vtmf_group", "load_keys", "vsshe_group",
+    "alice_mix", "bob_mix", "final_mix", "take_cards_from_stack",
+    "open_private_cards", "preflop_bet", "open_flop", "flop_bet",
+    "open_turn", "turn_bet", "open_river", "river_bet",
+    "showdown", "game_over"};
+
+static const char* proof_kind_names[NUM_PROOF_KINDS] = {"stack", "card"};
+
+static const char* direction_names[2] = {"in", "out"};
+
+static const auto relaxed = std::memory_order_relaxed;
+
+void latency_histogram::add(uint64_t us) {
+    int b = 0;
+    while (b < num_buckets && us > bucket_bound_us(b))
+        b++;
+    buckets[b].fetch_add(1, relaxed);
+    count.fetch_add(1, relaxed);
+    sum_us.fetch_add(us, relaxed);
+}
+
+void latency_histogram::reset() {
+    for (auto& b : buckets)
+        b.store(0, relaxed);
+    count.store(0, relaxed);
+    sum_us.store(0, relaxed);
+}
+
+void metrics::record_step(game_step step, uint64_t us) {
+    if (step >= 0 && step < num_game_steps)
+        _steps[step].add(us);
+}
+
+void metrics::record_message(message_direction dir, message_type type, size_t raw_bytes, size_t wire_bytes) {
+    if (type < 0 || type >= num_message_types)
+        return;
+    auto& m = _messages[dir][type];
+    m.count.fetch_add(1, relaxed);
+    m.raw_bytes.fetch_add(raw_bytes, relaxed);
+    m.wire_bytes.fetch_add(wire_bytes, relaxed);
+}
+
+void metrics::record_proof(proof_kind kind, bool verified) {
+    _proofs[kind].fetch_add(1, relaxed);
+    if (!verified)
+        _proof_failures[kind].fetch_add(1, relaxed);
+}
+
+void metrics::reset() {
+    for (auto& h : _steps)
+        h.reset();
+    for (auto& dir : _messages) {
+        for (auto& m : dir) {
+            m.count.store(0, relaxed);
+            m.raw_bytes.store(0, relaxed);
+            m.wire_bytes.store(0, relaxed);
+        }
+    }
+    for (int i = 0; i < NUM_PROOF_KINDS; i++) {
+        _proofs[i].store(0, relaxed);
+        _proof_failures[i].store(0, relaxed);
+    }
+}
+
+void metrics::write_json(std::ostream& os) {
+    os << "{\"steps\":{";
+    bool first = true;
+    for (int s = 0; s < num_game_steps; s++) {
+        auto& h = _steps[s];
+        auto count = h.count.load(relaxed);
+        if (!count)
+            continue;
+        os << (first ? "" : ",") << "\"" << game_step_names[s] << "\":{"
+           << "\"count\":" << count
+           << ",\"sum_us\":" << h.sum_us.load(relaxed)
+           << ",\"buckets\":[";
+        // non-cumulative counts; bucket i holds durations <= 16us << i
+        for (int b = 0; b <= latency_histogram::num_buckets; b++)
+            os << (b ? "," : "") << h.buckets[b].load(relaxed);
+        os << "]}";
+        first = false;
+    }
+
+    os << "},\"messages\":{";
+    first = true;
+    for (int d = 0; d < 2; d++) {
+        for (int t = 0; t < num_message_types; t++) {
+            auto& m = _messages[d][t];
+            auto count = m.count.load(relaxed);
+            if (!count)
+                continue;
+            os << (first ? "" : ",") << "\"" << message_type_names[t] << "_" << direction_names[d] << "\":{"
+               << "\"count\":" << count
+               << ",\"raw_bytes\":" << m.raw_bytes.load(relaxed)
+               << ",\"wire_bytes\":" << m.wire_bytes.load(relaxed) << "}";
+            first = false;
+        }
+    }
+
+    os << "},\"proofs\":{";
+    for (int k = 0; k < NUM_PROOF_KINDS; k++) {
+        os << (k ? "," : "") << "\"" << proof_kind_names[k] << "\":{"
+           << "\"checked\":" << _proofs[k].load(relaxed)
+           << ",\"failed\":" << _proof_failures[k].load(relaxed) << "}";
+    }
+    os << "}}";
+}
+
+void metrics::write_prometheus(std::ostream& os) {
+    os << "# HELP poker_step_duration_seconds Duration of referee game steps\n"
+       << "# TYPE poker_step_duration_seconds histogram\n";
+    for (int s = 0; s < num_game_steps; s++) {
+        auto& h = _steps[s];
+        auto count = h.count.load(relaxed);
+        if (!count)
+            continue;
+        uint64_t cumulative = 0;
+        for (int b = 0; b < latency_histogram::num_buckets; b++) {
+            cumulative += h.buckets[b].load(relaxed);
+            os << "poker_step_duration_seconds_bucket{step=\"" << game_step_names[s]
+               << "\",le=\"" << latency_histogram::bucket_bound_us(b) / 1e6 << "\"} " << cumulative << "\n";
+        }
+        os << "poker_step_duration_seconds_bucket{step=\"" << game_step_names[s] << "\",le=\"+Inf\"} " << count << "\n"
+           << "poker_step_duration_seconds_sum{step=\"" << game_step_names[s] << "\"} " << h.sum_us.load(relaxed) / 1e6 << "\n"
+           << "poker_step_duration_seconds_count{step=\"" << game_step_names[s] << "\"} " << count << "\n";
+    }
+
+    os << "# HELP poker_messages_total Messages sent and received\n"
+       << "# TYPE poker_messages_total counter\n";
+    for (int d = 0; d < 2; d++)
+        for (int t = 0; t < num_message_types; t++)
+            os << "poker_messages_total{type=\"" << message_type_names[t] << "\",direction=\"" << direction_names[d] << "\"} "
+               << _messages[d][t].count.load(relaxed) << "\n";
+
+    os << "# HELP poker_message_bytes_total Message bytes before (raw) and after (wire) compression\n"
+       << "# TYPE poker_message_bytes_total counter\n";
+    for (int d = 0; d < 2; d++) {
+        for (int t = 0; t < num_message_types; t++) {
+            auto& m = _messages[d][t];
+            os << "poker_message_bytes_total{type=\"" << message_type_names[t] << "\",direction=\"" << direction_names[d]
+               << "\",encoding=\"raw\"} " << m.raw_bytes.load(relaxed) << "\n"
+               << "poker_message_bytes_total{type=\"" << message_type_names[t] << "\",direction=\"" << direction_names[d]
+               << "\",encoding=\"wire\"} " << m.wire_bytes.load(relaxed) << "\n";
+        }
+    }
+
+    os << "# HELP poker_proofs_checked_total Zero-knowledge proofs checked\n"
+       << "# TYPE poker_proofs_checked_total counter\n";
+    for (int k = 0; k < NUM_PROOF_KINDS; k++)
+        os << "poker_proofs_checked_total{kind=\"" << proof_kind_names[k] << "\"} " << _proofs[k].load(relaxed) << "\n";
+
+    os << "# HELP poker_proofs_failed_total Zero-knowledge proofs that failed verification\n"
+       << "# TYPE poker_proofs_failed_total counter\n";
+    for (int k = 0; k < NUM_PROOF_KINDS; k++)
+        os << "poker_proofs_failed_total{kind=\"" << proof_kind_names[k] << "\"} " << _proof_failures[k].load(relaxed) << "\n";
+}
+
+}  // namespace poker
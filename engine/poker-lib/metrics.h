@@ -0,0 +1,97 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#include "messages.h"
+#include "common.h"
+
+namespace poker {
+
+/*
+ * Always-on engine metrics.
+ * Process wide counters and latency histograms, updated with relaxed
+ * atomics and exported as JSON or Prometheus text.
+*/
+
+const int num_game_steps = GAME_OVER + 1;
+
+enum proof_kind {
+    PROOF_STACK,  // shuffle proof
+    PROOF_CARD,   // card secret proof
+    NUM_PROOF_KINDS
+};
+
+enum message_direction {
+    MSG_IN,
+    MSG_OUT,
+};
+
+// Latency histogram, buckets are powers of two microseconds
+class latency_histogram {
+   public:
+    static const int num_buckets = 24;  // 16us .. ~67s, then +Inf
+    static uint64_t bucket_bound_us(int i) { return 16ull << i; }
+
+    std::atomic<uint64_t> buckets[num_buckets + 1];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum_us;
+
+    latency_histogram() { reset(); }
+    void add(uint64_t us);
+    void reset();
+};
+
+struct message_metrics {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> raw_bytes;   // encoded message
+    std::atomic<uint64_t> wire_bytes;  // compressed and wrapped
+};
+
+class metrics {
+    latency_histogram _steps[num_game_steps];
+    message_metrics _messages[2][num_message_types];
+    std::atomic<uint64_t> _proofs[NUM_PROOF_KINDS];
+    std::atomic<uint64_t> _proof_failures[NUM_PROOF_KINDS];
+
+    metrics() { reset(); }
+
+   public:
+    metrics(metrics const&) = delete;
+    void operator=(metrics const&) = delete;
+
+    static metrics& instance() {
+        static metrics instance;
+        return instance;
+    }
+
+    void record_step(game_step step, uint64_t us);
+    void record_message(message_direction dir, message_type type, size_t raw_bytes, size_t wire_bytes);
+    void record_proof(proof_kind kind, bool verified);
+
+    void write_json(std::ostream& os);
+    void write_prometheus(std::ostream& os);
+    void reset();
+};
+
+/*
+ * Records the duration of a referee step
+*/
+class step_timer {
+    game_step _step;
+    std::chrono::steady_clock::time_point _t0;
+
+   public:
+    step_timer(game_step step) : _step(step), _t0(std::chrono::steady_clock::now()) {}
+    ~step_timer() {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _t0).count();
+        metrics::instance().record_step(_step, us);
+    }
+};
+
+}  // namespace poker
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+namespace poker {
+
+/*
+ * Unbounded lock-free queue with many producers and a single consumer.
+ * push never blocks; pop returns false when the queue is empty, or
+ * briefly while a concurrent push is linking its node.
+*/
+template <typename T>
+class mpsc_queue {
+    struct node {
+        std::atomic<node*> next;
+        T value;
+        node() : next(nullptr) {}
+    };
+
+    // producers append after _head, the consumer reads after _tail
+    std::atomic<node*> _head;
+    node* _tail;
+
+   public:
+    mpsc_queue() {
+        auto stub = new node();
+        _head.store(stub);
+        _tail = stub;
+    }
+
+    ~mpsc_queue() {
+        T v;
+        while (pop(v))
+            ;
+        delete _tail;
+    }
+
+    mpsc_queue(const mpsc_queue&) = delete;
+    mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+    void push(T v) {
+        auto n = new node();
+        n->value = std::move(v);
+        auto prev = _head.exchange(n, std::memory_order_acq_rel);
+        prev->next.store(n, std::memory_order_release);
+    }
+
+    bool pop(T& v) {
+        auto tail = _tail;
+        auto next = tail->next.load(std::memory_order_acquire);
+        if (!next)
+            return false;
+        // next becomes the new stub
+        v = std::move(next->value);
+        next->value = T();
+        _tail = next;
+        delete tail;
+        return true;
+    }
+};
+
+}  // namespace poker
+
+#endif
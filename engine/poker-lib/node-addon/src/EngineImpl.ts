@@ -1,9 +1,11 @@
 import { BigNumber } from "ethers";
-import { Engine, EngineBetType, EngineResult, EngineState, StatusCode } from "./Engine";
+import { Engine, EngineBetType, EngineEvents, EngineResult, EngineState, StatusCode } from "./Engine";
 
 export class EngineImpl implements Engine {
     private player: any;
     private lib: any;
+    // engine calls on a player must not overlap, so they run in call order
+    private pending: Promise<any> = Promise.resolve();
 
     constructor(private player_id: number, lib_path: string = null) {
         if (lib_path == null) lib_path = "../../assets/engine/pokerlib";
@@ -15,11 +17,12 @@ export class EngineImpl implements Engine {
         bob_funds: BigNumber,
         big_blind: BigNumber,
         encryption: boolean = true,
-        winner: number = -1
+        winner: number = -1,
+        tmcg_profile: string = null
     ): Promise<EngineResult> {
         return new Promise((resolve, reject) => {
             try {
-                this.lib.init(encryption, false, winner);
+                this.lib.init(encryption, false, winner, tmcg_profile);
                 this.player = this.lib.newPlayer(this.player_id);
                 this.lib.initPlayer(this.player, alice_funds.toString(), bob_funds.toString(), big_blind.toString());
                 resolve({ status: StatusCode.SUCCESS });
@@ -29,66 +32,39 @@ export class EngineImpl implements Engine {
         });
     }
 
+    // Crypto work runs on the libuv thread pool, keeping the event loop free
     create_handshake(): Promise<EngineResult> {
-        return new Promise((resolve, reject) => {
-            try {
-                const msg = this.lib.createHandshake(this.player);
-                resolve({
-                    status: StatusCode.CONTINUED,
-                    message_out: msg,
-                });
-            } catch (error) {
-                reject(error);
-            }
-        });
+        return this.enqueue(() => this.lib.createHandshakeAsync(this.player)).then((msg) => ({
+            status: StatusCode.CONTINUED,
+            message_out: msg,
+        }));
     }
 
     process_handshake(message_in: Uint8Array): Promise<EngineResult> {
-        return new Promise((resolve, reject) => {
-            try {
-                const result = this.lib.processHandshake(this.player, message_in);
-                resolve({
-                    status: result.continued ? StatusCode.CONTINUED : StatusCode.SUCCESS,
-                    message_out: result.response,
-                });
-            } catch (error) {
-                reject(error);
-            }
-        });
+        return this.enqueue(() => this.lib.processHandshakeAsync(this.player, message_in)).then((result) => ({
+            status: result.continued ? StatusCode.CONTINUED : StatusCode.SUCCESS,
+            message_out: result.response,
+        }));
     }
 
     create_bet(type: EngineBetType, amount: BigNumber): Promise<EngineResult> {
-        return new Promise((resolve, reject) => {
-            try {
-                const result = this.lib.createBet(this.player, type, amount.toString());
-                resolve({
-                    status: result.continued ? StatusCode.CONTINUED : StatusCode.SUCCESS,
-                    message_out: result.response,
-                });
-            } catch (error) {
-                reject(error);
-            }
-        });
+        return this.enqueue(() => this.lib.createBetAsync(this.player, type, amount.toString())).then((result) => ({
+            status: result.continued ? StatusCode.CONTINUED : StatusCode.SUCCESS,
+            message_out: result.response,
+        }));
     }
 
     process_bet(message_in: Uint8Array): Promise<EngineResult> {
-        return new Promise((resolve, reject) => {
-            try {
-                const result = this.lib.processBet(this.player, message_in);
-                resolve({
-                    status: result.continued ? StatusCode.CONTINUED : StatusCode.SUCCESS,
-                    message_out: result.response,
-                    betType: result.betType,
-                    amount: result.amount,
-                });
-            } catch (error) {
-                reject(error);
-            }
-        });
+        return this.enqueue(() => this.lib.processBetAsync(this.player, message_in)).then((result) => ({
+            status: result.continued ? StatusCode.CONTINUED : StatusCode.SUCCESS,
+            message_out: result.response,
+            betType: result.betType,
+            amount: result.amount,
+        }));
     }
 
     game_state(): Promise<EngineState> {
-        return new Promise((resolve, reject) => {
+        return this.enqueue(() => new Promise((resolve, reject) => {
             try {
                 const stateString = this.lib.getGameState(this.player);
                 const state = JSON.parse(stateString, (key, value) => {
@@ -109,10 +85,35 @@ export class EngineImpl implements Engine {
             } catch (error) {
                 reject(error);
             }
-        });
+        }));
+    }
+
+    events(since: number): Promise<EngineEvents> {
+        return this.enqueue(() => new Promise((resolve, reject) => {
+            try {
+                const eventsString = this.lib.getEvents(this.player, since);
+                resolve(JSON.parse(eventsString, (key, value) => {
+                    switch (key) {
+                        case "amount":
+                        case "bets":
+                            return BigNumber.from(value);
+                        default:
+                            return value;
+                    }
+                }));
+            } catch (error) {
+                reject(error);
+            }
+        }));
     }
 
     on_game_over(): void {
-        this.lib.deletePlayer(this.player);
+        this.pending.then(() => this.lib.deletePlayer(this.player));
+    }
+
+    private enqueue<T>(call: () => Promise<T>): Promise<T> {
+        const result = this.pending.then(call);
+        this.pending = result.catch(() => undefined);
+        return result;
     }
 }
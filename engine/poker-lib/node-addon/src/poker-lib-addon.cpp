@@ -13,12 +13,14 @@ static std::string to_string(int v) {
   return std::string(temp);
 }
 
-// init(encryption, logging, winner)
+static bool get_string(napi_env env, napi_value& src, std::string& dst);
+
+// init(encryption, logging, winner[, tmcg_profile])
 napi_value init(napi_env env, napi_callback_info info) {
   napi_status status;
 
-  napi_value argv[3];
-  size_t argc = 3;
+  napi_value argv[4];
+  size_t argc = 4;
   if (napi_ok != (status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL))) {
     napi_throw_type_error(env, to_string((int)status).c_str(), "Error parsing arguments");
     return NULL;
@@ -32,8 +34,17 @@ napi_value init(napi_env env, napi_callback_info info) {
       napi_throw_type_error(env, to_string((int)status).c_str(), "Error getting arguments");
       return NULL;
   }
+  // undefined or null for the default
+  napi_valuetype profile_type = napi_undefined;
+  std::string tmcg_profile;
+  if (argc > 3 && napi_ok != (status = napi_typeof(env, argv[3], &profile_type))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error getting arguments");
+    return NULL;
+  }
+  if (profile_type == napi_string && !get_string(env, argv[3], tmcg_profile))
+    return NULL;
 
-  auto res = papi_init(encryption, logging, winner);
+  auto res = papi_init_ex(encryption, logging, winner, profile_type == napi_string ? tmcg_profile.c_str() : NULL);
   if (res != PAPI_SUCCESS) {
     napi_throw_type_error(env, to_string((int)res).c_str(), "Error initializing library");
     return NULL;
@@ -97,8 +108,24 @@ static bool get_string(napi_env env, napi_value& src, std::string& dst) {
   return true;
 }
 
-static void finalize_msg(napi_env env, void* msg, void* finalize_hint) {
-  papi_delete_message((PAPI_MONEY)msg);
+static void finalize_buffer(napi_env env, void* data, void* finalize_hint) {
+  papi_delete_buffer((PAPI_BUFFER)finalize_hint);
+}
+
+// Hands the engine output buffer over to JS without copying it.
+// Takes ownership of buffer; empty output yields null
+static napi_status make_output_buffer(napi_env env, PAPI_BUFFER buffer, napi_value* result) {
+  PAPI_MESSAGE data;
+  PAPI_INT len;
+  papi_buffer_data(buffer, &data, &len);
+  if (!len) {
+    papi_delete_buffer(buffer);
+    return napi_get_null(env, result);
+  }
+  napi_status status = napi_create_external_buffer(env, len, (void*)data, finalize_buffer, buffer, result);
+  if (status != napi_ok)
+    papi_delete_buffer(buffer);
+  return status;
 }
 
 // deletePlayer(player)
@@ -179,19 +206,18 @@ napi_value createHandshake(napi_env env, napi_callback_info info) {
     return NULL;
   }
 
-  PAPI_MESSAGE msg_out;
-  PAPI_INT msg_out_len;
-  auto res =  papi_create_handshake((PAPI_PLAYER)player, &msg_out, &msg_out_len);
+  PAPI_BUFFER msg_out;
+  papi_new_buffer(&msg_out);
+  auto res =  papi_create_handshake_into((PAPI_PLAYER)player, msg_out);
   if (res != PAPI_SUCCESS && res != PAPI_CONTINUED) {
+    papi_delete_buffer(msg_out);
     napi_throw_type_error(env, to_string((int)res).c_str(), "Error deleting handshake");
     return NULL;
   }
 
   napi_value buffer = NULL;
-  if (msg_out_len) {
-    if (napi_ok != (status = napi_create_external_buffer(env,  msg_out_len, (void*)msg_out, finalize_msg, NULL, &buffer)))
-      napi_throw_type_error(env, to_string((int)status).c_str(), "Error Error alloating buffer");
-  }
+  if (napi_ok != (status = make_output_buffer(env, msg_out, &buffer)))
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error Error alloating buffer");
 
   return buffer;
 }
@@ -220,21 +246,19 @@ napi_value processHandshake(napi_env env, napi_callback_info info) {
     return NULL;
   }
 
-  PAPI_MESSAGE msg_out;
-  PAPI_INT msg_out_len;
-  auto res =  papi_process_handshake((PAPI_PLAYER)player, (PAPI_MESSAGE)msg_in, msg_in_len, &msg_out, &msg_out_len);
+  PAPI_BUFFER msg_out;
+  papi_new_buffer(&msg_out);
+  auto res =  papi_process_handshake_into((PAPI_PLAYER)player, (PAPI_MESSAGE)msg_in, msg_in_len, msg_out);
   if (res != PAPI_SUCCESS && res != PAPI_CONTINUED) {
+    papi_delete_buffer(msg_out);
     napi_throw_type_error(env, to_string((int)res).c_str(), "Error processing handshake");
     return NULL;
   }
 
   napi_value msg_out_buffer;
-  napi_get_null(env, &msg_out_buffer);
-  if (msg_out_len) {
-    if (napi_ok != (status = napi_create_external_buffer(env,  msg_out_len, (void*)msg_out, finalize_msg, NULL, &msg_out_buffer))) {
-      napi_throw_type_error(env, to_string((int)status).c_str(), "Error Error alloating msg_out buffer");
-      return NULL;
-    }
+  if (napi_ok != (status = make_output_buffer(env, msg_out, &msg_out_buffer))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error Error alloating msg_out buffer");
+    return NULL;
   }
 
   napi_value continued;
@@ -271,21 +295,19 @@ napi_value createBet(napi_env env, napi_callback_info info) {
   if (!get_string(env, argv[2], amt))
     return NULL;
 
-  PAPI_MESSAGE msg_out;
-  PAPI_INT msg_out_len;
-  auto res =  papi_create_bet((PAPI_PLAYER)player, bet_type, (PAPI_MONEY)amt.c_str(),  &msg_out, &msg_out_len);
+  PAPI_BUFFER msg_out;
+  papi_new_buffer(&msg_out);
+  auto res =  papi_create_bet_into((PAPI_PLAYER)player, bet_type, (PAPI_MONEY)amt.c_str(), msg_out);
   if (res != PAPI_SUCCESS && res != PAPI_CONTINUED) {
+    papi_delete_buffer(msg_out);
     napi_throw_type_error(env, to_string((int)res).c_str(), "Error deleting handshake");
     return NULL;
   }
 
   napi_value msg_out_buffer;
-  napi_get_null(env, &msg_out_buffer);
-  if (msg_out_len) {
-    if (napi_ok != (status = napi_create_external_buffer(env,  msg_out_len, (void*)msg_out, finalize_msg, NULL, &msg_out_buffer))) {
-      napi_throw_type_error(env, to_string((int)status).c_str(), "Error Error alloating msg_out buffer");
-      return NULL;
-    }
+  if (napi_ok != (status = make_output_buffer(env, msg_out, &msg_out_buffer))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error Error alloating msg_out buffer");
+    return NULL;
   }
 
   napi_value continued;
@@ -326,24 +348,22 @@ napi_value processBet(napi_env env, napi_callback_info info) {
     return NULL;
   }
 
-  PAPI_MESSAGE msg_out;
-  PAPI_INT msg_out_len;
+  PAPI_BUFFER msg_out;
+  papi_new_buffer(&msg_out);
   PAPI_INT bet_type;
   char amt[100] = { 0 };
   int amt_len = sizeof(amt);
-  auto res =  papi_process_bet((PAPI_PLAYER)player, (PAPI_MESSAGE)msg_in, msg_in_len, &msg_out, &msg_out_len, &bet_type, (PAPI_STR)amt, amt_len);
+  auto res =  papi_process_bet_into((PAPI_PLAYER)player, (PAPI_MESSAGE)msg_in, msg_in_len, msg_out, &bet_type, (PAPI_STR)amt, amt_len);
   if (res != PAPI_SUCCESS && res != PAPI_CONTINUED) {
+    papi_delete_buffer(msg_out);
     napi_throw_type_error(env, to_string((int)res).c_str(), "Error processing bet");
     return NULL;
   }
 
   napi_value msg_out_buffer;
-  napi_get_null(env, &msg_out_buffer);
-  if (msg_out_len) {
-    if (napi_ok != (status = napi_create_external_buffer(env,  msg_out_len, (void*)msg_out, finalize_msg, NULL, &msg_out_buffer))) {
-      napi_throw_type_error(env, to_string((int)status).c_str(), "Error Error alloating msg_out buffer");
-      return NULL;
-    }
+  if (napi_ok != (status = make_output_buffer(env, msg_out, &msg_out_buffer))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error Error alloating msg_out buffer");
+    return NULL;
   }
 
   napi_value continued, vbet_type, vamt, result;
@@ -380,22 +400,293 @@ napi_value getGameState(napi_env env, napi_callback_info info) {
     return NULL;
   }
   
-  char json[1024] = { 0 };
-  auto res =  papi_get_game_state((PAPI_PLAYER)player, (PAPI_STR)json, sizeof(json));
-  if (res != PAPI_SUCCESS && res != PAPI_CONTINUED) {
-    napi_throw_type_error(env, to_string((int)res).c_str(), "Error calling papi_get_game_state");
+  PAPI_BUFFER json;
+  PAPI_MESSAGE data;
+  PAPI_INT len;
+  papi_new_buffer(&json);
+  auto res = papi_get_game_state_into(player, json);
+  if (res != PAPI_SUCCESS) {
+    papi_delete_buffer(json);
+    napi_throw_type_error(env, to_string((int)res).c_str(), "Error calling papi_get_game_state_into");
+    return NULL;
+  }
+  papi_buffer_data(json, &data, &len);
+
+  napi_value result;
+  status = napi_create_string_utf8(env, data, len, &result);
+  papi_delete_buffer(json);
+  if (napi_ok != status) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error creating result string");
+    return NULL;
+  }
+
+  return result;
+}
+
+// getEvents(player, since:int) -> events:string
+napi_value getEvents(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_value argv[2];
+  size_t argc = 2;
+
+  if (napi_ok != (status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error parsing arguments");
     return NULL;
   }
 
+  PAPI_PLAYER player;
+  if (!get_player(env, argv[0], player)) {
+    napi_throw_type_error(env, "", "Error loading player");
+    return NULL;
+  }
+  PAPI_INT since;
+  if (napi_ok != (status = napi_get_value_int32(env, argv[1], &since))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error reading since");
+    return NULL;
+  }
+
+  PAPI_BUFFER json;
+  PAPI_MESSAGE data;
+  PAPI_INT len;
+  papi_new_buffer(&json);
+  auto res = papi_get_events(player, since, json);
+  if (res != PAPI_SUCCESS) {
+    papi_delete_buffer(json);
+    napi_throw_type_error(env, to_string((int)res).c_str(), "Error calling papi_get_events");
+    return NULL;
+  }
+  papi_buffer_data(json, &data, &len);
+
   napi_value result;
-  if (napi_ok != (status = napi_create_string_utf8(env, json, strlen(json), &result))) {
-    napi_throw_type_error(env, to_string((int)res).c_str(), "Error creating result string");
+  status = napi_create_string_utf8(env, data, len, &result);
+  papi_delete_buffer(json);
+  if (napi_ok != status) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error creating result string");
     return NULL;
   }
 
   return result;
 }
 
+//-------------------------------------------------------
+// Asynchronous calls
+// Engine work runs on the libuv thread pool and the returned
+// Promise resolves with the same shape as the synchronous call.
+// Calls on the same player must not overlap.
+//-------------------------------------------------------
+
+enum async_call {
+  CREATE_HANDSHAKE,
+  PROCESS_HANDSHAKE,
+  CREATE_BET,
+  PROCESS_BET
+};
+
+struct async_request {
+  async_call call;
+  napi_async_work work;
+  napi_deferred deferred;
+  PAPI_PLAYER player;
+  napi_ref msg_in_ref;  // keeps msg_in alive while the work runs
+  const char* msg_in;
+  size_t msg_in_len;
+  PAPI_INT bet_type;
+  std::string amount;
+  PAPI_ERR res;
+  PAPI_BUFFER msg_out;
+};
+
+static void execute_async(napi_env env, void* data) {
+  auto r = (async_request*)data;
+  char amt[100] = { 0 };
+  switch (r->call) {
+    case CREATE_HANDSHAKE:
+      r->res = papi_create_handshake_into(r->player, r->msg_out);
+      break;
+    case PROCESS_HANDSHAKE:
+      r->res = papi_process_handshake_into(r->player, (PAPI_MESSAGE)r->msg_in, r->msg_in_len, r->msg_out);
+      break;
+    case CREATE_BET:
+      r->res = papi_create_bet_into(r->player, r->bet_type, (PAPI_MONEY)r->amount.c_str(), r->msg_out);
+      break;
+    case PROCESS_BET:
+      r->res = papi_process_bet_into(r->player, (PAPI_MESSAGE)r->msg_in, r->msg_in_len, r->msg_out, &r->bet_type, (PAPI_STR)amt, sizeof(amt));
+      r->amount = amt;
+      break;
+  }
+}
+
+static napi_status make_async_result(napi_env env, async_request* r, napi_value* result) {
+  napi_status status;
+  napi_value msg_out_buffer;
+  auto msg_out = r->msg_out;
+  r->msg_out = NULL;
+  if (napi_ok != (status = make_output_buffer(env, msg_out, &msg_out_buffer)))
+    return status;
+
+  // createHandshake resolves with the message itself
+  if (r->call == CREATE_HANDSHAKE) {
+    *result = msg_out_buffer;
+    return napi_ok;
+  }
+
+  napi_value continued;
+  if (napi_ok != (status = napi_get_boolean(env, r->res == PAPI_CONTINUED, &continued)) ||
+      napi_ok != (status = napi_create_object(env, result)) ||
+      napi_ok != (status = napi_set_named_property(env, *result, "continued", continued)) ||
+      napi_ok != (status = napi_set_named_property(env, *result, "response", msg_out_buffer)))
+    return status;
+
+  if (r->call == PROCESS_BET) {
+    napi_value vbet_type, vamt;
+    if (napi_ok != (status = napi_create_string_utf8(env, r->amount.c_str(), r->amount.size(), &vamt)) ||
+        napi_ok != (status = napi_create_int32(env, r->bet_type, &vbet_type)) ||
+        napi_ok != (status = napi_set_named_property(env, *result, "amount", vamt)) ||
+        napi_ok != (status = napi_set_named_property(env, *result, "betType", vbet_type)))
+      return status;
+  }
+  return napi_ok;
+}
+
+static void reject_async(napi_env env, napi_deferred deferred, int code, const char* msg) {
+  napi_value vcode, vmsg, error;
+  napi_create_string_utf8(env, to_string(code).c_str(), NAPI_AUTO_LENGTH, &vcode);
+  napi_create_string_utf8(env, msg, NAPI_AUTO_LENGTH, &vmsg);
+  napi_create_type_error(env, vcode, vmsg, &error);
+  napi_reject_deferred(env, deferred, error);
+}
+
+static void complete_async(napi_env env, napi_status status, void* data) {
+  auto r = (async_request*)data;
+  napi_value result;
+  if (status != napi_ok) {
+    reject_async(env, r->deferred, (int)status, "Error running async work");
+  } else if (r->res != PAPI_SUCCESS && r->res != PAPI_CONTINUED) {
+    reject_async(env, r->deferred, (int)r->res, "Error calling engine");
+  } else if (napi_ok != (status = make_async_result(env, r, &result))) {
+    reject_async(env, r->deferred, (int)status, "Error creating result object");
+  } else {
+    napi_resolve_deferred(env, r->deferred, result);
+  }
+
+  if (r->msg_out)
+    papi_delete_buffer(r->msg_out);
+  if (r->msg_in_ref)
+    napi_delete_reference(env, r->msg_in_ref);
+  napi_delete_async_work(env, r->work);
+  delete r;
+}
+
+static napi_value queue_async(napi_env env, async_request* r, const char* name) {
+  napi_status status;
+  napi_value promise, resource_name;
+  r->res = PAPI_SUCCESS;
+  papi_new_buffer(&r->msg_out);
+  if (napi_ok != (status = napi_create_promise(env, &r->deferred, &promise)) ||
+      napi_ok != (status = napi_create_string_utf8(env, name, NAPI_AUTO_LENGTH, &resource_name)) ||
+      napi_ok != (status = napi_create_async_work(env, NULL, resource_name, execute_async, complete_async, r, &r->work)) ||
+      napi_ok != (status = napi_queue_async_work(env, r->work))) {
+    papi_delete_buffer(r->msg_out);
+    if (r->msg_in_ref)
+      napi_delete_reference(env, r->msg_in_ref);
+    delete r;
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error queueing async work");
+    return NULL;
+  }
+  return promise;
+}
+
+// Reads msg_in without copying; the buffer is referenced until the work completes
+static bool get_msg_in(napi_env env, napi_value& src, async_request* r) {
+  napi_status status;
+  void* data;
+  if (napi_ok != (status = napi_get_buffer_info(env, src, &data, &r->msg_in_len)) ||
+      napi_ok != (status = napi_create_reference(env, src, 1, &r->msg_in_ref))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error getting msg_in_len arguments");
+    return false;
+  }
+  r->msg_in = (const char*)data;
+  return true;
+}
+
+// createHandshakeAsync(player) -> Promise<arrayBuffer>
+napi_value createHandshakeAsync(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_value argv[1];
+  size_t argc = 1;
+  if (napi_ok != (status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error parsing arguments");
+    return NULL;
+  }
+
+  auto r = new async_request();
+  r->call = CREATE_HANDSHAKE;
+  if (!get_player(env, argv[0], r->player)) {
+    delete r;
+    return NULL;
+  }
+  return queue_async(env, r, "createHandshake");
+}
+
+// processHandshakeAsync(player, msg:arrayBuffer) -> Promise<{ continued: bool, response: arrayBuffer}>
+napi_value processHandshakeAsync(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_value argv[2];
+  size_t argc = 2;
+  if (napi_ok != (status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error parsing arguments");
+    return NULL;
+  }
+
+  auto r = new async_request();
+  r->call = PROCESS_HANDSHAKE;
+  if (!get_player(env, argv[0], r->player) || !get_msg_in(env, argv[1], r)) {
+    delete r;
+    return NULL;
+  }
+  return queue_async(env, r, "processHandshake");
+}
+
+// createBetAsync(player, betType, amount) -> Promise<{ continued: bool, response: arrayBuffer}>
+napi_value createBetAsync(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_value argv[3];
+  size_t argc = 3;
+  if (napi_ok != (status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error parsing arguments");
+    return NULL;
+  }
+
+  auto r = new async_request();
+  r->call = CREATE_BET;
+  if (!get_player(env, argv[0], r->player) ||
+      napi_ok != napi_get_value_int32(env, argv[1], &r->bet_type) ||
+      !get_string(env, argv[2], r->amount)) {
+    delete r;
+    return NULL;
+  }
+  return queue_async(env, r, "createBet");
+}
+
+// processBetAsync(player, msg:arrayBuffer) -> Promise<{ betType, amount, continued: bool, response: arrayBuffer}>
+napi_value processBetAsync(napi_env env, napi_callback_info info) {
+  napi_status status;
+  napi_value argv[2];
+  size_t argc = 2;
+  if (napi_ok != (status = napi_get_cb_info(env, info, &argc, argv, NULL, NULL))) {
+    napi_throw_type_error(env, to_string((int)status).c_str(), "Error parsing arguments");
+    return NULL;
+  }
+
+  auto r = new async_request();
+  r->call = PROCESS_BET;
+  if (!get_player(env, argv[0], r->player) || !get_msg_in(env, argv[1], r)) {
+    delete r;
+    return NULL;
+  }
+  return queue_async(env, r, "processBet");
+}
+
 //-------------------------------------------------------
 // Module registration and exports
 //-------------------------------------------------------
@@ -419,6 +710,11 @@ static callback callbacks[] = {
   def_callback(createBet),
   def_callback(processBet),
   def_callback(getGameState),
+  def_callback(getEvents),
+  def_callback(createHandshakeAsync),
+  def_callback(processHandshakeAsync),
+  def_callback(createBetAsync),
+  def_callback(processBetAsync),
   { NULL, NULL }
 };
 
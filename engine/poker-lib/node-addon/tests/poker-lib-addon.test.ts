@@ -105,4 +105,53 @@ describe('Poker Node.js add-on', function() {
 
     });
   });
+
+  describe('Async calls', function() {
+    it('should run handshakes of concurrent games off the main thread', async function() {
+      const lib = require('../build/Release/pokerlib.node');
+      lib.init(true, false, -1);
+
+      const handshake = async () => {
+        const alice = lib.newPlayer(0);
+        const bob = lib.newPlayer(1);
+        lib.initPlayer(alice, "100", "200", "10");
+        lib.initPlayer(bob, "100", "200", "10");
+
+        let r;
+        const msg = await lib.createHandshakeAsync(alice);
+        r = await lib.processHandshakeAsync(bob, msg);
+        assert.equal(r.continued, true);
+        r = await lib.processHandshakeAsync(alice, r.response);
+        r = await lib.processHandshakeAsync(bob, r.response);
+        r = await lib.processHandshakeAsync(alice, r.response);
+        r = await lib.processHandshakeAsync(bob, r.response);
+        assert.equal(r.continued, false);
+        assert.equal(r.response, undefined);
+
+        // Preflop: Alice calls
+        r = await lib.createBetAsync(alice, BET_CALL, "0");
+        r = await lib.processBetAsync(bob, r.response);
+        assert.equal(r.betType, BET_CALL);
+        assert.equal(r.amount, "0");
+
+        lib.deletePlayer(alice);
+        lib.deletePlayer(bob);
+      };
+
+      // the event loop keeps ticking while the engine works
+      let ticks = 0;
+      const timer = setInterval(() => ticks++, 1);
+      await Promise.all([handshake(), handshake()]);
+      clearInterval(timer);
+      assert.notEqual(ticks, 0);
+    });
+
+    it('should reject with the engine error code', async function() {
+      const lib = require('../build/Release/pokerlib.node');
+      const bob = lib.newPlayer(1);
+      lib.initPlayer(bob, "100", "200", "10");
+      await assert.rejects(lib.processHandshakeAsync(bob, Buffer.from("garbage")));
+      lib.deletePlayer(bob);
+    });
+  });
 });
@@ -1,24 +1,83 @@
 #include "participant.h"
 
+#include <gcrypt.h>
+
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
-void set_libtmcg_cartesi_predictable(int v);
+#include "codec.h"
+#include "metrics.h"
+#include "service_locator.h"
+#include "trace.h"
+
+typedef void (*libtmcg_cartesi_random_fn)(void* ctx, unsigned char* buf, size_t len, int level);
+void set_libtmcg_cartesi_random(libtmcg_cartesi_random_fn fn, void* ctx);
 
 namespace poker {
 
+static void generate_random(void* ctx, unsigned char* buf, size_t len, int level) {
+    ((random_source*)ctx)->generate(buf, len, level);
+}
+
+static void system_random(unsigned char* buf, size_t len, int level) {
+    gcry_randomize(buf, len, (gcry_random_level)level);
+}
+
+// random source installed on this thread, restored when guards nest
+static thread_local random_source* current_random = NULL;
+
+/*
+ * Installs the participant's random source in libTMCG for the calling
+ * thread: the transcript-seeded DRBG for predictable participants, the
+ * buffered system CSPRNG for the others
+*/
 class libtmcg_guard {
+    random_source* _previous;
+
+    static void install(random_source* r) {
+        current_random = r;
+        set_libtmcg_cartesi_random(r ? &generate_random : NULL, r);
+    }
+
    public:
-    libtmcg_guard(i_participant* p) {
-        //logger << "\n>>> patching libtmcg " << p->predictable() << std::endl;
-        set_libtmcg_cartesi_predictable(p->predictable());
+    libtmcg_guard(participant* p) : _previous(current_random) {
+        install(p->random());
     }
     ~libtmcg_guard() {
-        set_libtmcg_cartesi_predictable(0);
+        install(_previous);
     }
 };
 
-participant::participant() : _vtmf(NULL), _tmcg(NULL), _vsshe(NULL) {}
+const tmcg_profile tmcg_profiles[] = {
+    // CI and tests only
+    {"fast-test", 1, 16, 1024, 160},
+    // the libTMCG defaults
+    {"standard", 2, 64, 2048, 256},
+    // about 128-bit security
+    {"high", 3, 128, 3072, 256},
+};
+
+const int num_tmcg_profiles = sizeof(tmcg_profiles) / sizeof(tmcg_profiles[0]);
+
+const tmcg_profile* find_tmcg_profile(const std::string& name) {
+    for (auto& profile : tmcg_profiles)
+        if (name == profile.name)
+            return &profile;
+    return NULL;
+}
+
+const tmcg_profile* weakest_tmcg_profile() {
+    auto weakest = &tmcg_profiles[0];
+    for (auto& profile : tmcg_profiles)
+        if (profile.strength < weakest->strength)
+            weakest = &profile;
+    return weakest;
+}
+
+participant::participant(bool pipelined, const char* profile, const char* min_profile) : _pipelined(pipelined), _key_finalized(false), _profile(find_tmcg_profile(profile)), _min_profile(find_tmcg_profile(min_profile ? min_profile : profile)), _vtmf(NULL), _tmcg(NULL), _vsshe(NULL), _csprng(&system_random) {
+    memset(_transcript, 0, sizeof(_transcript));
+}
 
 participant::~participant() {
     delete _vtmf;
@@ -42,31 +101,73 @@ int participant::num_participants() { return _num_participants; }
 
 bool participant::predictable() { return _predictable; }
 
+// Predictable participants (the referee's) draw from a DRBG keyed by a hash
+// chain over the messages they receive, so every referee of a game and its
+// verifier draw the same bytes, and different games different ones
+void participant::absorb(blob& msg) {
+    if (!_predictable)
+        return;
+    auto& data = msg.str();
+    hash_chain(_transcript, data.data(), data.size());
+    _drbg.seed(_transcript);
+}
+
 game_error participant::create_group(blob& group) {
+#ifdef POKER_VERIFY_ONLY
+    return VRF_VERIFY_ONLY;
+#else
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
-    _tmcg = new SchindelhauerTMCG(64, _num_participants, 6 /* bits  for 52 cards*/);
-    _vtmf = new BarnettSmartVTMF_dlog();
+    game_error res;
+    if (!_profile) {
+        logger_at(LOG_ERROR) << "*** ERROR unknown TMCG profile\n";
+        return TMC_UNKNOWN_PROFILE;
+    }
+    _tmcg = new SchindelhauerTMCG(_profile->security_level, _num_participants, 6 /* bits  for 52 cards*/);
+    _vtmf = new BarnettSmartVTMF_dlog(_profile->fieldsize, _profile->subgroupsize);
     logger << _pfx << "BarnettSmartVTMF_dlog done " << std::endl;
     if (!_vtmf->CheckGroup()) {
-        logger << "*** ERROR BarnettSmartVTMF_dlog\n";
+        logger_at(LOG_ERROR) << "*** ERROR BarnettSmartVTMF_dlog\n";
         return TMC_CHECK_GROUP;
     }
+    encoder out(group.out());
+    if ((res = out.write(std::string(_profile->name))))
+        return res;
     _vtmf->PublishGroup(group.out());
     return SUCCESS;
+#endif
 }
 
 game_error participant::load_group(blob& group) {
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
-    _tmcg = new SchindelhauerTMCG(64, _num_participants, 6 /* bits for 52 cards*/);
-    _vtmf = new BarnettSmartVTMF_dlog(group.in());
-    if (!_vtmf->CheckGroup()) {
-        logger << "*** ERROR BarnettSmartVTMF_dlog\n";
+    absorb(group);
+    std::string name;
+    decoder in(group.in());
+    if (in.read(name))
+        return TMC_CHECK_GROUP;
+    auto profile = find_tmcg_profile(name);
+    if (!profile) {
+        logger_at(LOG_ERROR) << "*** ERROR unknown TMCG profile " << name << std::endl;
+        return TMC_UNKNOWN_PROFILE;
+    }
+    if (!_min_profile || profile->strength < _min_profile->strength) {
+        logger_at(LOG_ERROR) << "*** ERROR TMCG profile " << name << " is too weak" << std::endl;
+        return TMC_PROFILE_REJECTED;
+    }
+    _profile = profile;
+    _tmcg = new SchindelhauerTMCG(_profile->security_level, _num_participants, 6 /* bits for 52 cards*/);
+    _vtmf = new BarnettSmartVTMF_dlog(group.in(), _profile->fieldsize, _profile->subgroupsize);
+    // a group smaller than its profile claims is rejected too
+    if (!_vtmf->CheckGroup() || mpz_sizeinbase(_vtmf->p, 2) < _profile->fieldsize || mpz_sizeinbase(_vtmf->q, 2) < _profile->subgroupsize) {
+        logger_at(LOG_ERROR) << "*** ERROR BarnettSmartVTMF_dlog\n";
         return TMC_CHECK_GROUP;
     }
     return SUCCESS;
 }
 
 game_error participant::generate_key(blob& key) {
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
     logger << _pfx << "publishKey " << std::endl;
     _vtmf->KeyGenerationProtocol_GenerateKey();
@@ -75,40 +176,51 @@ game_error participant::generate_key(blob& key) {
 }
 
 game_error participant::load_their_key(blob& key) {
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
+    absorb(key);
     logger << _pfx << "load_their_key " << std::endl;
     if (!_vtmf->KeyGenerationProtocol_UpdateKey(key.in())) {
-        logger << "*** their public key was not correctly generated!" << std::endl;
+        logger_at(LOG_ERROR) << "*** their public key was not correctly generated!" << std::endl;
         return TMC_KEYGENERATIONPROTOCOL_UPDATEKEY;
     }
     return SUCCESS;
 }
 
 game_error participant::finalize_key_generation() {
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
     logger << _pfx << "finalize_key_generation " << std::endl;
     _vtmf->KeyGenerationProtocol_Finalize();
+    _key_finalized = true;
     return SUCCESS;
 }
 
 game_error participant::create_vsshe_group(blob& group) {
+#ifdef POKER_VERIFY_ONLY
+    return VRF_VERIFY_ONLY;
+#else
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
     logger << _pfx << "create_vsshe_group" << std::endl;
     _vsshe = new GrothVSSHE(DECK_SIZE, _vtmf->p, _vtmf->q, _vtmf->k, _vtmf->g, _vtmf->h);
     if (!_vsshe->CheckGroup()) {
-        logger << _pfx << "*** VRHE instance was not correctly generated!" << std::endl;
+        logger_at(LOG_ERROR) << _pfx << "*** VRHE instance was not correctly generated!" << std::endl;
         return TMC_VSSHE_CHECKGROUP;
     }
     _vsshe->PublishGroup(group.out());
     return SUCCESS;
+#endif
 }
 
 game_error participant::load_vsshe_group(blob& group) {
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
+    absorb(group);
     logger << _pfx << "load_vsshe_group" << std::endl;
     _vsshe = new GrothVSSHE(DECK_SIZE, group.in());
     if (!_vsshe->CheckGroup()) {
-        logger << _pfx << "*** VRHE instance was not correctly generated!" << std::endl;
+        logger_at(LOG_ERROR) << _pfx << "*** VRHE instance was not correctly generated!" << std::endl;
         return TMC_VSSHE_CHECKGROUP;
     }
 
@@ -133,6 +245,7 @@ game_error participant::load_vsshe_group(blob& group) {
 }
 
 game_error participant::create_stack() {
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
     logger << _pfx << "create_stack " << std::endl;
     TMCG_OpenStack<VTMF_Card> deck;
@@ -147,6 +260,7 @@ game_error participant::create_stack() {
 }
 
 game_error participant::shuffle_stack(blob& mixed_stack, blob& stack_proof) {
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
     logger << _pfx << "shuffle_stack" << std::endl;
     TMCG_Stack<VTMF_Card> mix;
@@ -158,7 +272,10 @@ game_error participant::shuffle_stack(blob& mixed_stack, blob& stack_proof) {
 }
 
 game_error participant::load_stack(blob& mixed_stack, blob& mixed_stack_proof) {
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
+    absorb(mixed_stack);
+    absorb(mixed_stack_proof);
     logger << _pfx << "load_stack " << std::endl;
     TMCG_Stack<VTMF_Card> s2;
     mixed_stack.in() >> s2;
@@ -167,15 +284,69 @@ game_error participant::load_stack(blob& mixed_stack, blob& mixed_stack_proof) {
         logger << "shuffle: read or parse error" << std::endl;
         return TMCG_READ_STACK;
     }
-    if (!_tmcg->TMCG_VerifyStackEquality_Groth_noninteractive(_stack, s2, _vtmf, _vsshe, mixed_stack_proof.in())) {
-        logger << "*** shuffle: verification failed" << std::endl;
+    bool verified = _tmcg->TMCG_VerifyStackEquality_Groth_noninteractive(_stack, s2, _vtmf, _vsshe, mixed_stack_proof.in());
+    metrics::instance().record_proof(PROOF_STACK, verified);
+    if (!verified) {
+        logger_at(LOG_ERROR) << "*** shuffle: verification failed" << std::endl;
         return TMC_VERIFYSTACKEQUALITY;
     }
     _stack = s2;
     return SUCCESS;
 }
 
+game_error participant::load_and_shuffle_stack(blob& their_stack, blob& their_proof, blob& mixed_stack, blob& stack_proof) {
+    TRACE_FUNC("participant");
+#if defined(POKER_THREADS) && !defined(POKER_VERIFY_ONLY)
+    if (_pipelined) {
+        logger << _pfx << "load_and_shuffle_stack (pipelined)" << std::endl;
+        absorb(their_stack);
+        absorb(their_proof);
+        TMCG_Stack<VTMF_Card> s2;
+        their_stack.in() >> s2;
+        if (!their_stack.in()) {
+            logger << "shuffle: read or parse error" << std::endl;
+            return TMCG_READ_STACK;
+        }
+
+        // Verify their shuffle while we mix on top of it.
+        // Our mix is discarded if the verification fails
+        bool verified = false;
+        task_group verifier(service_locator::instance().task_scheduler(), PRIORITY_INTERACTIVE);
+        verifier.run([&]() {
+            TRACE_SPAN("participant", "verify_their_stack");
+            libtmcg_guard patch_ltmcg(this);
+            verified = _tmcg->TMCG_VerifyStackEquality_Groth_noninteractive(_stack, s2, _vtmf, _vsshe, their_proof.in());
+        });
+
+        TMCG_Stack<VTMF_Card> mix;
+        std::ostringstream mix_proof;
+        {
+            libtmcg_guard patch_ltmcg(this);
+            _tmcg->TMCG_MixStack(s2, mix, _ss, _vtmf);
+            _tmcg->TMCG_ProveStackEquality_Groth_noninteractive(s2, mix, _ss, _vtmf, _vsshe, mix_proof);
+        }
+        // runs the verification here if no worker has picked it up yet
+        verifier.wait();
+        metrics::instance().record_proof(PROOF_STACK, verified);
+
+        if (!verified) {
+            logger_at(LOG_ERROR) << "*** shuffle: verification failed" << std::endl;
+            return TMC_VERIFYSTACKEQUALITY;
+        }
+        mixed_stack.out() << mix << std::endl;
+        stack_proof.out() << mix_proof.str();
+        _stack = mix;
+        return SUCCESS;
+    }
+#endif
+    game_error res;
+    if ((res = load_stack(their_stack, their_proof)))
+        return res;
+    return shuffle_stack(mixed_stack, stack_proof);
+}
+
 game_error participant::take_cards_from_stack(int count) {
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
     logger << _pfx << "take_cards_from_stack(" << count << ")" << std::endl;
     for (size_t i = 0; i < count; i++) {
@@ -187,6 +358,10 @@ game_error participant::take_cards_from_stack(int count) {
 }
 
 game_error participant::prove_card_secret(int card_index, blob& my_proof) {
+#ifdef POKER_VERIFY_ONLY
+    return VRF_VERIFY_ONLY;
+#else
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
     logger << _pfx << "prove_card_secret(" << card_index << ")" << std::endl;
     blob dummy;  // not used b/c this is non-interactive proof
@@ -194,9 +369,11 @@ game_error participant::prove_card_secret(int card_index, blob& my_proof) {
     _tmcg->TMCG_ProveCardSecret(_cards[card_index], _vtmf, dummy.in(), my_proof.out());
 
     return SUCCESS;
+#endif
 }
 
 game_error participant::self_card_secret(int card_index) {
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
     logger << _pfx << "self_card_secret(" << card_index << ")" << std::endl;
     _tmcg->TMCG_SelfCardSecret(_cards[card_index], _vtmf);
@@ -204,34 +381,212 @@ game_error participant::self_card_secret(int card_index) {
 }
 
 game_error participant::verify_card_secret(int card_index, blob& their_proof) {
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
+    absorb(their_proof);
     logger << _pfx << "verify_card_secret(" << card_index << ")" << std::endl;
     blob dummy;  // not used b/c this is non-interactive proof
-    if (!_tmcg->TMCG_VerifyCardSecret(_cards[card_index], _vtmf, their_proof.in(), dummy.out())) {
-        logger << "*** [verify_card_secret] Card " << card_index << " verification failed!" << std::endl;
+    bool verified = _tmcg->TMCG_VerifyCardSecret(_cards[card_index], _vtmf, their_proof.in(), dummy.out());
+    metrics::instance().record_proof(PROOF_CARD, verified);
+    if (!verified) {
+        logger_at(LOG_ERROR) << "*** [verify_card_secret] Card " << card_index << " verification failed!" << std::endl;
         return TMC_VERIFYCARDSECRET;
     }
     return SUCCESS;
 }
 
 game_error participant::open_card(int card_index) {
+    TRACE_FUNC("participant");
     libtmcg_guard patch_ltmcg(this);
-    logger << _pfx << "open_card(" << card_index << ")" << std::endl;
+    logger_at(LOG_TRACE) << _pfx << "open_card(" << card_index << ")" << std::endl;
     size_t card_type = _tmcg->TMCG_TypeOfCard(_cards[card_index], _vtmf);
     if (card_type >= DECK_SIZE) {
-        logger << _pfx << "failed to open_card(" << card_index << ") = " << std::endl;
+        logger_at(LOG_ERROR) << _pfx << "failed to open_card(" << card_index << ") = " << std::endl;
         return TMC_INVALID_CARD_INDEX;
     }
     _open_cards[card_index] = card_type;
-    logger << _pfx << "open_card(" << card_index << ") = " << (int)card_type << std::endl;
+    logger_at(LOG_TRACE) << _pfx << "open_card(" << card_index << ") = " << (int)card_type << std::endl;
     return SUCCESS;
 }
 
 size_t participant::get_open_card(int card_index) {
-    logger << _pfx << "get_open_card(" << card_index << ")" << std::endl;
+    logger_at(LOG_TRACE) << _pfx << "get_open_card(" << card_index << ")" << std::endl;
     auto card_type = _open_cards[card_index];
-    logger << _pfx << "get_open_card(" << card_index << ") = " << card_type << std::endl;
+    logger_at(LOG_TRACE) << _pfx << "get_open_card(" << card_index << ") = " << card_type << std::endl;
     return card_type;
 }
 
+static std::string mpz_hex(mpz_srcptr v) {
+    char* mem = mpz_get_str(NULL, 16, v);
+    std::string s = mem;
+    free(mem);
+    return s;
+}
+
+static game_error read_mpz(decoder& in, mpz_ptr v) {
+    game_error res;
+    std::string s;
+    if ((res = in.read(s)))
+        return res;
+    if (mpz_set_str(v, s.c_str(), 16))
+        return BIG_UNPARSEABLE;
+    return SUCCESS;
+}
+
+// Empty stacks are written as empty strings: libTMCG does not read them back
+template <typename T>
+static game_error write_tmcg(encoder& out, const T& v) {
+    std::ostringstream os;
+    if (v.size())
+        os << v;
+    return out.write(os.str());
+}
+
+template <typename T>
+static game_error read_tmcg(decoder& in, T& v) {
+    game_error res;
+    std::string s;
+    if ((res = in.read(s)))
+        return res;
+    v.clear();
+    if (s.empty())
+        return SUCCESS;
+    std::istringstream is(s);
+    is >> v;
+    return is.fail() ? TMCG_READ_STACK : SUCCESS;
+}
+
+// The group parameters and keys are written as published by libTMCG,
+// along with the private key and the other parties' keys it holds
+game_error participant::save(std::ostream& os) {
+    TRACE_FUNC("participant");
+    game_error res;
+    encoder out(os);
+    if ((res = out.write(_vtmf != NULL)))
+        return res;
+    if (_vtmf) {
+        std::ostringstream group;
+        _vtmf->PublishGroup(group);
+        if ((res = out.write(std::string(_profile->name))) || (res = out.write(group.str())))
+            return res;
+        for (auto v : {_vtmf->x_i, _vtmf->h_i, _vtmf->h, _vtmf->d, _vtmf->h_i_fp})
+            if ((res = out.write(mpz_hex(v))))
+                return res;
+        if ((res = out.write((int)_vtmf->h_j.size())))
+            return res;
+        for (auto& key : _vtmf->h_j) {
+            if ((res = out.write(key.first)) || (res = out.write(mpz_hex(key.second))))
+                return res;
+        }
+        if ((res = out.write(_key_finalized)))
+            return res;
+    }
+    if ((res = out.write(_vsshe != NULL)))
+        return res;
+    if (_vsshe) {
+        std::ostringstream group;
+        _vsshe->PublishGroup(group);
+        if ((res = out.write(group.str())))
+            return res;
+    }
+    if ((res = write_tmcg(out, _stack)) || (res = write_tmcg(out, _ss)) || (res = write_tmcg(out, _cards)))
+        return res;
+    if ((res = out.write((int)_open_cards.size())))
+        return res;
+    for (auto& card : _open_cards) {
+        if ((res = out.write(card.first)) || (res = out.write((int)card.second)))
+            return res;
+    }
+    // transcript hash and DRBG position, so a restored referee draws on
+    bignumber position;
+    position.set_uint64(_drbg.position());
+    if ((res = out.write(std::string((const char*)_transcript, sizeof(_transcript)))) || (res = out.write(position)))
+        return res;
+    return SUCCESS;
+}
+
+game_error participant::restore(std::istream& is) {
+    TRACE_FUNC("participant");
+    libtmcg_guard patch_ltmcg(this);
+    game_error res;
+    decoder in(is);
+    delete _vtmf;
+    delete _tmcg;
+    delete _vsshe;
+    _vtmf = NULL;
+    _tmcg = NULL;
+    _vsshe = NULL;
+    _key_finalized = false;
+
+    bool has_vtmf, has_vsshe;
+    std::string group;
+    if ((res = in.read(has_vtmf)))
+        return res;
+    if (has_vtmf) {
+        std::string name;
+        if ((res = in.read(name)) || (res = in.read(group)))
+            return res;
+        if (!(_profile = find_tmcg_profile(name)))
+            return TMC_UNKNOWN_PROFILE;
+        std::istringstream group_in(group);
+        _tmcg = new SchindelhauerTMCG(_profile->security_level, _num_participants, 6 /* bits for 52 cards*/);
+        _vtmf = new BarnettSmartVTMF_dlog(group_in, _profile->fieldsize, _profile->subgroupsize);
+        for (auto v : {_vtmf->x_i, _vtmf->h_i, _vtmf->h, _vtmf->d, _vtmf->h_i_fp})
+            if ((res = read_mpz(in, v)))
+                return res;
+        int num_keys;
+        if ((res = in.read(num_keys)))
+            return res;
+        if (num_keys < 0 || num_keys > _num_participants)
+            return COD_ERROR;
+        for (auto i = 0; i < num_keys; i++) {
+            std::string fp;
+            if ((res = in.read(fp)))
+                return res;
+            mpz_ptr key = new mpz_t();
+            mpz_init(key);
+            // owned by _vtmf, as the keys added by load_their_key
+            _vtmf->h_j[fp] = key;
+            if ((res = read_mpz(in, key)))
+                return res;
+        }
+        if ((res = in.read(_key_finalized)))
+            return res;
+        // precomputes the tables for the common key
+        if (_key_finalized)
+            _vtmf->KeyGenerationProtocol_Finalize();
+    }
+    if ((res = in.read(has_vsshe)))
+        return res;
+    if (has_vsshe) {
+        if ((res = in.read(group)))
+            return res;
+        std::istringstream group_in(group);
+        _vsshe = new GrothVSSHE(DECK_SIZE, group_in);
+    }
+    if ((res = read_tmcg(in, _stack)) || (res = read_tmcg(in, _ss)) || (res = read_tmcg(in, _cards)))
+        return res;
+    int num_open_cards;
+    if ((res = in.read(num_open_cards)))
+        return res;
+    _open_cards.clear();
+    for (auto i = 0; i < num_open_cards; i++) {
+        int card_index, card_type;
+        if ((res = in.read(card_index)) || (res = in.read(card_type)))
+            return res;
+        _open_cards[card_index] = card_type;
+    }
+    std::string transcript;
+    bignumber position;
+    uint64_t pos;
+    if ((res = in.read(transcript)) || (res = in.read(position)) || (res = position.get_uint64(pos)))
+        return res;
+    if (transcript.size() != sizeof(_transcript))
+        return COD_ERROR;
+    memcpy(_transcript, transcript.data(), sizeof(_transcript));
+    _drbg.seed(_transcript);
+    _drbg.seek(pos);
+    return SUCCESS;
+}
+
 }  // namespace poker
\ No newline at end of file
@@ -5,15 +5,46 @@
 #include <map>
 #include <string>
 
+#include "drbg.h"
 #include "i_participant.h"
 
 namespace poker {
 
+/*
+ * Named parameters of the libTMCG groups. The profile proposed by Alice
+ * travels with the group in msg_vtmf; a participant accepts it if it is
+ * not weaker than its floor
+*/
+struct tmcg_profile {
+    const char* name;
+    // profiles are ordered by it, the higher the stronger; floors compare it
+    int strength;
+    // security parameter of SchindelhauerTMCG
+    unsigned long security_level;
+    // bits of the modulus p and of the subgroup order q of the VTMF group
+    unsigned long fieldsize;
+    unsigned long subgroupsize;
+};
+
+extern const tmcg_profile tmcg_profiles[];
+extern const int num_tmcg_profiles;
+
+// NULL if unknown
+const tmcg_profile* find_tmcg_profile(const std::string& name);
+// the profile of the lowest strength
+const tmcg_profile* weakest_tmcg_profile();
+
 class participant : public i_participant {
     int _id;
     int _num_participants;
     bool _predictable;
+    bool _pipelined;
+    bool _key_finalized;
     std::string _pfx;
+    // the profile proposed, then the one of the group
+    const tmcg_profile* _profile;
+    // the weakest accepted from Alice
+    const tmcg_profile* _min_profile;
     SchindelhauerTMCG* _tmcg;
     BarnettSmartVTMF_dlog* _vtmf;
     GrothVSSHE* _vsshe;
@@ -22,14 +53,23 @@ class participant : public i_participant {
     TMCG_Stack<VTMF_Card> _cards;
     std::map<int, size_t> _open_cards;
 
+    // hash chain over the messages received, seeding _drbg
+    unsigned char _transcript[DRBG_SEED_SIZE];
+    chacha20_drbg _drbg;
+    buffered_csprng _csprng;
+
+    void absorb(blob& msg);
+
    public:
-    participant();
+    // min_profile is the weakest profile accepted, NULL for profile itself
+    participant(bool pipelined = false, const char* profile = "standard", const char* min_profile = NULL);
     virtual ~participant();
 
     void init(int id, int num_participants, bool predictable) override;
     int id() override;
     int num_participants() override;
     bool predictable() override;
+    random_source* random() { return _predictable ? (random_source*)&_drbg : &_csprng; }
 
     game_error create_group(blob& group) override;
     game_error load_group(blob& group) override;
@@ -47,6 +87,7 @@ class participant : public i_participant {
     game_error create_stack() override;
     game_error shuffle_stack(blob& mixed_stack, blob& stack_proof) override;
     game_error load_stack(blob& mixed_stack, blob& mixed_stack_proof) override;
+    game_error load_and_shuffle_stack(blob& their_stack, blob& their_proof, blob& mixed_stack, blob& stack_proof) override;
 
     // Cards
     game_error take_cards_from_stack(int count) override;
@@ -55,6 +96,9 @@ class participant : public i_participant {
     game_error verify_card_secret(int card_index, blob& their_proof) override;
     game_error open_card(int card_index) override;
     size_t get_open_card(int card_index) override;
+
+    game_error save(std::ostream& os) override;
+    game_error restore(std::istream& is) override;
 };
 
 }  // namespace poker
@@ -1,13 +1,17 @@
 #include "player.h"
+#include "codec.h"
 #include "compression.h"
+#include "metrics.h"
 #include "service_locator.h"
+#include "trace.h"
 
 namespace poker {
 
 player::player(int id)
     : _id(id), _opponent_id(opponent_id(_id)),
+      _backend(service_locator::instance().options().backend),
       _alice_money(0), _bob_money(0), _big_blind(0),
-      _p(service_locator::instance().new_participant())
+      _p(service_locator::instance().new_participant(_backend))
 {
     _p->init(id, 3, false);
     _r.game().next_msg_author = id == ALICE ? _id : _opponent_id;
@@ -18,6 +22,7 @@ player::~player() {
 }
 
 game_error player::init(money_t alice_money, money_t bob_money, money_t big_blind) {
+    TRACE_FUNC("player");
     game_error res;
     if ((res=_r.step_init_game(alice_money, bob_money, big_blind)))
         return res;
@@ -33,7 +38,71 @@ game_error player::init(money_t alice_money, money_t bob_money, money_t big_blin
     return SUCCESS;
 }
 
+game_error player::save(std::ostream& os) {
+    TRACE_FUNC("player");
+    game_error res;
+    encoder out(os);
+    if ((res = out.write(player_save_version)) || (res = out.write(_id)))
+        return res;
+    if ((res = out.write((int)_backend)))
+        return res;
+    if ((res = out.write(_alice_money)) || (res = out.write(_bob_money)) || (res = out.write(_big_blind)))
+        return res;
+    if ((res = out.write(_my_key)) || (res = out.write(_proof_of_their_cards)))
+        return res;
+    if ((res = out.write((int)_public_proofs.size())))
+        return res;
+    for (auto& proof : _public_proofs) {
+        if ((res = out.write((int)proof.first)) || (res = out.write(proof.second)))
+            return res;
+    }
+    if ((res = _p->save(os)))
+        return res;
+    return _r.save(os);
+}
+
+game_error player::restore(std::istream& is) {
+    TRACE_FUNC("player");
+    game_error res;
+    decoder in(is);
+    int version, id, backend;
+    if ((res = in.read(version)))
+        return res;
+    if (version != player_save_version)
+        return PRR_SAVE_VERSION_MISMATCH;
+    if ((res = in.read(id)))
+        return res;
+    if (id != ALICE && id != BOB)
+        return PRR_INVALID_PLAYER;
+    if ((res = in.read(backend)))
+        return res;
+    if (backend != _backend)
+        return PRR_SAVE_BACKEND_MISMATCH;
+    _id = id;
+    _opponent_id = opponent_id(_id);
+    _p->init(_id, 3, false);
+    if ((res = in.read(_alice_money)) || (res = in.read(_bob_money)) || (res = in.read(_big_blind)))
+        return res;
+    if ((res = in.read(_my_key)) || (res = in.read(_proof_of_their_cards)))
+        return res;
+    int num_proofs;
+    if ((res = in.read(num_proofs)))
+        return res;
+    _public_proofs.clear();
+    for (auto i = 0; i < num_proofs; i++) {
+        int step;
+        blob proof;
+        if ((res = in.read(step)) || (res = in.read(proof)))
+            return res;
+        _public_proofs[(game_step)step] = proof;
+    }
+    if ((res = _p->restore(is)))
+        return res;
+    return _r.restore(is);
+}
+
 game_error player::create_handshake(std::string&msg_out) {
+    TRACE_FUNC("player");
     game_error res;
     if (_id != ALICE)
         return PRR_INVALID_PLAYER;
@@ -46,7 +115,7 @@ game_error player::create_handshake(std::string&msg_out) {
 
     if ((res=_p->create_group(msgout.vtmf)))
         return res;
-    if ((res=_r.step_vtmf_group(msgout.vtmf)))
+    if ((res=_r.step_vtmf_group(msgout.vtmf, _backend)))
         return res;
 
     if ((res=_p->generate_key(_my_key)))
@@ -57,20 +126,30 @@ game_error player::create_handshake(std::string&msg_out) {
 
     std::ostringstream os;
     msgout.write(os);
-    return compress_and_wrap(os.str(), msg_out);
+    return send(MSG_VTMF, os.str(), msg_out);
 }
 
 game_error player::process_handshake(std::string& msg_in, std::string& msg_out) {
+    return process_handshake(msg_in.data(), msg_in.size(), msg_out);
+}
+
+game_error player::process_handshake(const char* msg_in, size_t msg_in_len, std::string& msg_out) {
+    TRACE_FUNC("player");
     game_error res;
 
     std::string decompressed;
-    if ((res=unwrap_and_decompress(msg_in, decompressed)))
+    if ((res=unwrap_and_decompress(msg_in, msg_in_len, decompressed)))
         return res;
     
-    auto is = std::istringstream(decompressed);
+    memory_istream is(decompressed.data(), decompressed.size());
     message* msgin = NULL;
     if ((res=message::decode(is, &msgin)))
         return res;
+    if (msgin->version() != message_version()) {
+        delete msgin;
+        return COD_VERSION_MISMATCH;
+    }
+    metrics::instance().record_message(MSG_IN, msgin->type(), decompressed.size(), msg_in_len);
 
     if (msgin->player_id != opponent_id(_id))
         return PRR_INVALID_OPPONNENT;
@@ -110,13 +189,14 @@ game_error player::process_handshake(std::string& msg_in, std::string& msg_out)
             msgout->write(os);
     }
 
+    auto out_type = msgout ? msgout->type() : msgin->type();
     delete msgin;
     delete msgout;
 
-    msg_out = "";
+    msg_out.clear();
     auto ostr = os.str();
     if (ostr.size()) {
-        game_error r = compress_and_wrap(ostr, msg_out);
+        game_error r = send(out_type, ostr, msg_out);
         if (r)
             return r;
     }
@@ -147,7 +227,7 @@ game_error player::handle_vtmf(msg_vtmf* msgin, message** out) {
 
     if (_p->load_group(msgin->vtmf))
         return PRR_CREATE_VTMF;
-    if ((res=_r.step_vtmf_group(msgin->vtmf)))
+    if ((res=_r.step_vtmf_group(msgin->vtmf, _backend)))
         return res;
 
     if ((res=_p->generate_key(_my_key)))
@@ -214,13 +294,11 @@ game_error player::handle_vsshe(msg_vsshe* msgin, message** out) {
     if (_p->create_stack())
         return PRR_CREATE_STACK;
 
-    if (_p->load_stack(msgin->stack, msgin->stack_proof))
-        return PRR_LOAD_STACK;
+    // Alice's mix is verified while Bob mixes on top of it
+    if ((res=_p->load_and_shuffle_stack(msgin->stack, msgin->stack_proof, msgout->stack, msgout->stack_proof)))
+        return (res == TMCG_READ_STACK || res == TMC_VERIFYSTACKEQUALITY) ? PRR_LOAD_STACK : PRR_SHUFFLE_STACK;
     if ((res=_r.step_alice_mix(msgin->stack, msgin->stack_proof)))
         return res;
-
-    if (_p->shuffle_stack(msgout->stack, msgout->stack_proof))
-        return PRR_SHUFFLE_STACK;
     if ((res=_r.step_bob_mix(msgout->stack, msgout->stack_proof)))
         return res;
 
@@ -289,6 +367,7 @@ game_error player::handle_bob_private_cards(msg_bob_private_cards* msgin) {
 }
 
 game_error player::create_bet(bet_type type, money_t amt, std::string& msg_out) {
+    TRACE_FUNC("player");
     logger << _id << ": create_bet...\n";
     game_error res;
     msg_bet_request msgout;
@@ -305,7 +384,7 @@ game_error player::create_bet(bet_type type, money_t amt, std::string& msg_out)
     if (step_changed) {
         if (type == BET_FOLD && _r.step() == game_step::GAME_OVER) {
             msgout.write(os);
-            return compress_and_wrap(os.str(), msg_out);
+            return send(MSG_BET_REQUEST, os.str(), msg_out);
         }
 
         if ((_r.step() != game_step::SHOWDOWN)) {
@@ -321,7 +400,7 @@ game_error player::create_bet(bet_type type, money_t amt, std::string& msg_out)
         }
     }
     msgout.write(os);
-    if ((res=compress_and_wrap(os.str(), msg_out)))
+    if ((res=send(MSG_BET_REQUEST, os.str(), msg_out)))
         return res;
 
     _r.game().next_msg_author = step_changed ? _opponent_id : _r.game().current_player;
@@ -330,17 +409,27 @@ game_error player::create_bet(bet_type type, money_t amt, std::string& msg_out)
 }
 
 game_error player::process_bet(std::string& msg_in, std::string& out, bet_type* out_type, money_t* out_amt) {
+    return process_bet(msg_in.data(), msg_in.size(), out, out_type, out_amt);
+}
+
+game_error player::process_bet(const char* msg_in, size_t msg_in_len, std::string& out, bet_type* out_type, money_t* out_amt) {
+    TRACE_FUNC("player");
     logger << _id << ": process_bet...\n";
     game_error res;
 
     std::string decompressed;
-    if ((res=unwrap_and_decompress(msg_in, decompressed)))
+    if ((res=unwrap_and_decompress(msg_in, msg_in_len, decompressed)))
         return res;
 
-    auto is = std::istringstream(decompressed);
+    memory_istream is(decompressed.data(), decompressed.size());
     message* msgin = NULL;
     if ((res=message::decode(is, &msgin)))
         return res;
+    if (msgin->version() != message_version()) {
+        delete msgin;
+        return COD_VERSION_MISMATCH;
+    }
+    metrics::instance().record_message(MSG_IN, msgin->type(), decompressed.size(), msg_in_len);
 
     if (msgin->player_id != opponent_id(_id))
         return PRR_INVALID_OPPONNENT;
@@ -373,14 +462,15 @@ game_error player::process_bet(std::string& msg_in, std::string& out, bet_type*
             msgout->write(os);
     }
 
+    auto out_type = msgout ? msgout->type() : msgin->type();
     delete msgin;
     delete msgout;
 
-    out = "";
+    out.clear();
     auto ostr = os.str();
     auto compression = SUCCESS;
     if (ostr.size())
-        compression = compress_and_wrap(ostr, out);
+        compression = send(out_type, ostr, out);
 
     return compression == SUCCESS ? res : compression;
 }
@@ -459,6 +549,15 @@ game_error player::handle_card_proof(msg_card_proof* msgin, message** out) {
     return SUCCESS;
 }
 
+// Compresses and wraps an outgoing message
+game_error player::send(message_type type, const std::string& msg, std::string& msg_out) {
+    game_error res;
+    if ((res=compress_and_wrap(msg, msg_out)))
+        return res;
+    metrics::instance().record_message(MSG_OUT, type, msg.size(), msg_out.size());
+    return SUCCESS;
+}
+
 game_error player::make_card_proof(blob& dst, int start_card_ix, int count) {
     for(auto i=start_card_ix; i < start_card_ix+count; i++) {
         if (_p->prove_card_secret(i, dst))
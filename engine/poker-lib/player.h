@@ -8,6 +8,8 @@
 
 namespace poker {
 
+const int player_save_version = 4;
+
 /*
 * A player of the game
 */
@@ -15,6 +17,7 @@ class player {
    protected:
     int _id;
     int _opponent_id;
+    participant_backend _backend;
     i_participant* _p;
     referee _r;
 
@@ -32,6 +35,7 @@ class player {
     virtual ~player();
 
     game_state& game() { return _r.game(); }
+    const game_event_log& events() const { return _r.events(); }
 
     /// Game initialization.
     /// alice is assumed to be the small blind
@@ -52,6 +56,7 @@ class player {
     /// Upon successful return, checl msg_out.empty() to determine
     /// if it must be sent to the opponent
     game_error process_handshake(std::string& msg_in, std::string& msg_out);
+    game_error process_handshake(const char* msg_in, size_t msg_in_len, std::string& msg_out);
 
     /// Creates a bet request message (msg_out)
     /// Returns:
@@ -72,6 +77,14 @@ class player {
     /// if it must be sent to the opponent.
     /// The bet type and amount will be copied to out_type and out_amt, if they are not null
     game_error process_bet(std::string& msg_in, std::string& msg_out, bet_type* out_type = NULL, money_t* out_amt = NULL);
+    game_error process_bet(const char* msg_in, size_t msg_in_len, std::string& msg_out, bet_type* out_type = NULL, money_t* out_amt = NULL);
+
+    /// Checkpoint of the player (game, protocol state and saved proofs),
+    /// small enough to write after every message.
+    /// restore replaces the whole state, player id included. On failure
+    /// the player must be discarded
+    game_error save(std::ostream& os);
+    game_error restore(std::istream& is);
 
     /// Property accessors
     game_step step() { return _r.step(); }
@@ -98,6 +111,7 @@ class player {
     game_error load_opponent_key(blob& key);
     game_error make_card_proof(blob& proof, int start_card_ix, int count);
     game_error showdown(blob& their_proof, bool muck = false);
+    game_error send(message_type type, const std::string& msg, std::string& msg_out);
     game_error deal_cards();
     game_error prove_opponent_cards(blob& proofs);
     game_error open_public_cards(game_step step, blob& my_proof, blob& their_proof);
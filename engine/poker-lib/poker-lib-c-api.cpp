@@ -1,8 +1,22 @@
+#include <atomic>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <sstream>
 #include <stdio.h>
+#ifdef POKER_THREADS
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#endif
 #include "i_participant.h"
+#include "metrics.h"
 #include "poker-lib.h"
 #include "player.h"
+#include "preflop-equity.h"
+#include "service_locator.h"
+#include "table-manager.h"
+#include "trace.h"
 
 #ifdef WINDOWS
   #define PAPI __declspec(dllexport)
@@ -10,10 +24,22 @@
 #include "poker-lib-c-api.h"
 
 extern "C" PAPI PAPI_ERR papi_init(PAPI_BOOL encryption, PAPI_BOOL logging, PAPI_INT winner) {
+  return papi_init_ex(encryption, logging, winner, NULL);
+}
+
+extern "C" PAPI PAPI_ERR papi_init_ex(PAPI_BOOL encryption, PAPI_BOOL logging, PAPI_INT winner, const char* tmcg_profile) {
+  // the options keep a pointer to it
+  static std::string profile;
   poker::poker_lib_options options;
   options.encryption = encryption;
   options.logging = logging;
   options.winner = winner;
+  if (tmcg_profile) {
+    if (!poker::find_tmcg_profile(tmcg_profile))
+      return (PAPI_ERR)poker::TMC_UNKNOWN_PROFILE;
+    profile = tmcg_profile;
+    options.tmcg_profile = profile.c_str();
+  }
   poker::init_poker_lib(&options);
   return PAPI_SUCCESS;
 }
@@ -28,6 +54,29 @@ extern "C" PAPI PAPI_ERR papi_delete_player(PAPI_PLAYER player) {
   return PAPI_SUCCESS;
 }
 
+extern "C" PAPI PAPI_ERR papi_save_player(PAPI_PLAYER player, PAPI_BUFFER state) {
+  poker::player* p = (poker::player*)player;
+  std::ostringstream os;
+  auto res = p->save(os);
+  if (res)
+    return (PAPI_ERR)res;
+  *(std::string*)state = os.str();
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_restore_player(PAPI_MESSAGE state, PAPI_INT state_len, PAPI_PLAYER* player) {
+  *player = NULL;
+  auto p = new poker::player(poker::ALICE);
+  poker::memory_istream is(state, state_len);
+  auto res = p->restore(is);
+  if (res) {
+    delete p;
+    return (PAPI_ERR)res;
+  }
+  *player = p;
+  return PAPI_SUCCESS;
+}
+
 extern "C" PAPI PAPI_ERR papi_init_player(PAPI_PLAYER player, PAPI_MONEY alice_money, PAPI_MONEY bob_money, PAPI_MONEY big_blind) {
   poker::player* p = (poker::player*)player;
   poker::money_t am, bm, bb;
@@ -67,8 +116,7 @@ extern "C" PAPI PAPI_ERR papi_process_handshake(PAPI_PLAYER player, PAPI_MESSAGE
   *msg_out = NULL;
 
   poker::player* p = (poker::player*)player;
-  std::string mi = std::string(msg_in, msg_in_len);
-  auto res = p->process_handshake(mi, tmp);
+  auto res = p->process_handshake(msg_in, msg_in_len, tmp);
   if (res && res != poker::CONTINUED)
     return (PAPI_ERR)res;
 
@@ -109,8 +157,7 @@ extern "C" PAPI PAPI_ERR papi_process_bet(PAPI_PLAYER player, PAPI_MESSAGE msg_i
   *msg_out_len = 0;
   *msg_out = NULL;
   poker::player* p = (poker::player*)player;
-  std::string mi = std::string(msg_in, msg_in_len);
-  auto res = p->process_bet(mi, tmp, &tp, &am);
+  auto res = p->process_bet(msg_in, msg_in_len, tmp, &tp, &am);
   if (res && res != poker::CONTINUED)
     return (PAPI_ERR)res;
 
@@ -131,13 +178,409 @@ extern "C" PAPI PAPI_ERR papi_process_bet(PAPI_PLAYER player, PAPI_MESSAGE msg_i
   return (PAPI_ERR)res;
 }
 
+static void write_game_state(poker::player* p, std::string& json) {
+  poker::json_writer w(json);
+  w.begin_object();
+  p->game().write_json_fields(w, true);
+  w.key("step").value((int)p->step());
+  w.end_object();
+}
+
 extern "C" PAPI PAPI_ERR papi_get_game_state(PAPI_PLAYER player, PAPI_STR json, PAPI_INT json_len) {
+  std::string tmp;
+  write_game_state((poker::player*)player, tmp);
+  if (json_len <= 0 || tmp.size() >= (size_t)json_len)
+    return poker::API_BUFFER_TOO_SMALL;
+  memcpy(json, tmp.c_str(), tmp.size() + 1);
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_get_game_state_into(PAPI_PLAYER player, PAPI_BUFFER json) {
+  auto& out = *(std::string*)json;
+  out.clear();
+  write_game_state((poker::player*)player, out);
+  return PAPI_SUCCESS;
+}
+
+
+extern "C" PAPI PAPI_ERR papi_get_events(PAPI_PLAYER player, PAPI_INT since, PAPI_BUFFER json) {
+  poker::player* p = (poker::player*)player;
+  auto& out = *(std::string*)json;
+  out.clear();
+  poker::json_writer w(out);
+  p->events().write_json(since < 0 ? 0 : since, w);
+  return PAPI_SUCCESS;
+}
+
+
+/*
+* Reusable output buffers
+*/
+
+extern "C" PAPI PAPI_ERR papi_new_buffer(PAPI_BUFFER* buffer) {
+  *buffer = new std::string();
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_delete_buffer(PAPI_BUFFER buffer) {
+  delete (std::string*)buffer;
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_buffer_data(PAPI_BUFFER buffer, PAPI_MESSAGE* data, PAPI_INT* len) {
+  auto b = (std::string*)buffer;
+  *data = (PAPI_MESSAGE)b->data();
+  *len = (PAPI_INT)b->size();
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_create_handshake_into(PAPI_PLAYER player, PAPI_BUFFER msg_out) {
+  auto out = (std::string*)msg_out;
+  out->clear();
+  return (PAPI_ERR)((poker::player*)player)->create_handshake(*out);
+}
+
+extern "C" PAPI PAPI_ERR papi_process_handshake_into(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_BUFFER msg_out) {
+  auto out = (std::string*)msg_out;
+  out->clear();
+  return (PAPI_ERR)((poker::player*)player)->process_handshake(msg_in, msg_in_len, *out);
+}
+
+extern "C" PAPI PAPI_ERR papi_create_bet_into(PAPI_PLAYER player, PAPI_INT bet_type, PAPI_MONEY amt, PAPI_BUFFER msg_out) {
+  poker::money_t a;
+  a.parse_string(amt);
+  auto out = (std::string*)msg_out;
+  out->clear();
+  return (PAPI_ERR)((poker::player*)player)->create_bet((poker::bet_type)bet_type, a, *out);
+}
+
+extern "C" PAPI PAPI_ERR papi_process_bet_into(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_BUFFER msg_out, PAPI_INT* type, PAPI_STR amt, int amt_len) {
+  poker::money_t am;
+  poker::bet_type tp;
+  auto out = (std::string*)msg_out;
+  out->clear();
+  auto res = ((poker::player*)player)->process_bet(msg_in, msg_in_len, *out, &tp, &am);
+  if (res && res != poker::CONTINUED)
+    return (PAPI_ERR)res;
+
+  if (type)
+    *type = (PAPI_INT)tp;
+
+  if (amt && amt_len) {
+    auto tmp2 = am.to_string();
+    strncpy(amt, tmp2.c_str(), amt_len);
+  }
+
+  return (PAPI_ERR)res;
+}
+
+/*
+* Asynchronous API
+*/
+
+static std::atomic<PAPI_REQUEST> next_request(1);
+static std::deque<PAPI_COMPLETION> completion_queue;
+#ifdef POKER_THREADS
+static std::mutex completion_mutex;
+static std::condition_variable completion_cv;
+#endif
+
+static PAPI_MESSAGE copy_to_message(const std::string& s) {
+  auto msg = new char[s.size() + 1];
+  memcpy(msg, s.data(), s.size());
+  msg[s.size()] = 0;
+  return msg;
+}
+
+static void complete(PAPI_CALLBACK callback, PAPI_COMPLETION& c) {
+  if (callback) {
+    callback(&c);
+    return;
+  }
+  {
+#ifdef POKER_THREADS
+    std::unique_lock<std::mutex> lock(completion_mutex);
+#endif
+    completion_queue.push_back(c);
+  }
+#ifdef POKER_THREADS
+  completion_cv.notify_all();
+#endif
+}
+
+typedef std::function<poker::game_error(poker::player* p, PAPI_COMPLETION& c)> async_work;
+
+static PAPI_ERR submit(PAPI_PLAYER player, PAPI_CALLBACK callback, void* user_data, PAPI_REQUEST* request, async_work work) {
+  PAPI_COMPLETION c;
+  memset(&c, 0, sizeof(c));
+  c.request = next_request++;
+  c.user_data = user_data;
+  if (request)
+    *request = c.request;
+
   poker::player* p = (poker::player*)player;
-  auto g = p->game();
-  char extra_fields[100];
-  sprintf(extra_fields, "\"step\": %d", (int)p->step());
-  auto tmp = g.to_json(extra_fields);
-  strncpy(json, tmp.c_str(), json_len);
+  poker::service_locator::instance().task_scheduler().submit(p, [p, c, callback, work]() mutable {
+    c.status = (PAPI_ERR)work(p, c);
+    complete(callback, c);
+  }, poker::PRIORITY_INTERACTIVE);
   return PAPI_SUCCESS;
 }
 
+static poker::game_error set_message_out(poker::game_error res, const std::string& out, PAPI_COMPLETION& c) {
+  if (res && res != poker::CONTINUED)
+    return res;
+  c.msg_out_len = (PAPI_INT)out.size();
+  if (out.size())
+    c.msg_out = copy_to_message(out);
+  return res;
+}
+
+extern "C" PAPI PAPI_ERR papi_create_handshake_async(PAPI_PLAYER player, PAPI_CALLBACK callback, void* user_data, PAPI_REQUEST* request) {
+  return submit(player, callback, user_data, request, [](poker::player* p, PAPI_COMPLETION& c) {
+    std::string out;
+    return set_message_out(p->create_handshake(out), out, c);
+  });
+}
+
+extern "C" PAPI PAPI_ERR papi_process_handshake_async(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_CALLBACK callback, void* user_data, PAPI_REQUEST* request) {
+  std::string mi = std::string(msg_in, msg_in_len);
+  return submit(player, callback, user_data, request, [mi](poker::player* p, PAPI_COMPLETION& c) mutable {
+    std::string out;
+    return set_message_out(p->process_handshake(mi, out), out, c);
+  });
+}
+
+extern "C" PAPI PAPI_ERR papi_create_bet_async(PAPI_PLAYER player, PAPI_INT bet_type, PAPI_MONEY amt, PAPI_CALLBACK callback, void* user_data, PAPI_REQUEST* request) {
+  poker::money_t a;
+  a.parse_string(amt);
+  return submit(player, callback, user_data, request, [bet_type, a](poker::player* p, PAPI_COMPLETION& c) {
+    std::string out;
+    return set_message_out(p->create_bet((poker::bet_type)bet_type, a, out), out, c);
+  });
+}
+
+extern "C" PAPI PAPI_ERR papi_process_bet_async(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_CALLBACK callback, void* user_data, PAPI_REQUEST* request) {
+  std::string mi = std::string(msg_in, msg_in_len);
+  return submit(player, callback, user_data, request, [mi](poker::player* p, PAPI_COMPLETION& c) mutable {
+    std::string out;
+    poker::bet_type tp;
+    poker::money_t am;
+    auto res = set_message_out(p->process_bet(mi, out, &tp, &am), out, c);
+    if (res && res != poker::CONTINUED)
+      return res;
+    c.bet_type = (PAPI_INT)tp;
+    c.bet_amount = copy_to_message(am.to_string());
+    return res;
+  });
+}
+
+static PAPI_INT take_completions(PAPI_COMPLETION* completions, PAPI_INT max_completions) {
+  PAPI_INT n = 0;
+  while (n < max_completions && !completion_queue.empty()) {
+    completions[n++] = completion_queue.front();
+    completion_queue.pop_front();
+  }
+  return n;
+}
+
+extern "C" PAPI PAPI_ERR papi_poll(PAPI_COMPLETION* completions, PAPI_INT max_completions, PAPI_INT* count) {
+#ifdef POKER_THREADS
+  std::unique_lock<std::mutex> lock(completion_mutex);
+#endif
+  *count = take_completions(completions, max_completions);
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_wait(PAPI_COMPLETION* completions, PAPI_INT max_completions, PAPI_INT timeout_ms, PAPI_INT* count) {
+#ifdef POKER_THREADS
+  std::unique_lock<std::mutex> lock(completion_mutex);
+  auto ready = [] { return !completion_queue.empty(); };
+  if (timeout_ms < 0)
+    completion_cv.wait(lock, ready);
+  else
+    completion_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+#endif
+  *count = take_completions(completions, max_completions);
+  return PAPI_SUCCESS;
+}
+
+
+/*
+* Table manager
+*/
+
+extern "C" PAPI PAPI_ERR papi_tm_new(PAPI_TABLE_MANAGER* manager) {
+  *manager = new poker::table_manager(poker::service_locator::instance().task_scheduler());
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_tm_delete(PAPI_TABLE_MANAGER manager) {
+  delete ((poker::table_manager*)manager);
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_tm_create_table(PAPI_TABLE_MANAGER manager, PAPI_INT player_id, PAPI_MONEY alice_money, PAPI_MONEY bob_money, PAPI_MONEY big_blind, PAPI_TABLE* table) {
+  poker::money_t am, bm, bb;
+  am.parse_string(alice_money);
+  bm.parse_string(bob_money);
+  bb.parse_string(big_blind);
+  poker::table_id id;
+  auto res = ((poker::table_manager*)manager)->create_table(player_id, am, bm, bb, id);
+  if (res)
+    return (PAPI_ERR)res;
+  *table = id;
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_tm_restore_table(PAPI_TABLE_MANAGER manager, PAPI_MESSAGE state, PAPI_INT state_len, PAPI_TABLE* table) {
+  poker::table_id id;
+  auto res = ((poker::table_manager*)manager)->restore_table(state, state_len, id);
+  if (res)
+    return (PAPI_ERR)res;
+  *table = id;
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_tm_close_table(PAPI_TABLE_MANAGER manager, PAPI_TABLE table) {
+  return (PAPI_ERR)((poker::table_manager*)manager)->close_table(table);
+}
+
+static PAPI_ERR set_request(poker::game_error res, uint64_t r, PAPI_REQUEST* request) {
+  if (!res && request)
+    *request = (PAPI_REQUEST)r;
+  return (PAPI_ERR)res;
+}
+
+extern "C" PAPI PAPI_ERR papi_tm_create_handshake(PAPI_TABLE_MANAGER manager, PAPI_TABLE table, PAPI_REQUEST* request) {
+  uint64_t r;
+  return set_request(((poker::table_manager*)manager)->create_handshake(table, r), r, request);
+}
+
+extern "C" PAPI PAPI_ERR papi_tm_post_message(PAPI_TABLE_MANAGER manager, PAPI_TABLE table, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_REQUEST* request) {
+  uint64_t r;
+  return set_request(((poker::table_manager*)manager)->post_message(table, msg_in, msg_in_len, r), r, request);
+}
+
+extern "C" PAPI PAPI_ERR papi_tm_create_bet(PAPI_TABLE_MANAGER manager, PAPI_TABLE table, PAPI_INT bet_type, PAPI_MONEY amt, PAPI_REQUEST* request) {
+  poker::money_t a;
+  a.parse_string(amt);
+  uint64_t r;
+  return set_request(((poker::table_manager*)manager)->create_bet(table, (poker::bet_type)bet_type, a, r), r, request);
+}
+
+static PAPI_INT copy_table_completions(std::vector<poker::table_completion>& in, PAPI_TABLE_COMPLETION* completions) {
+  for (size_t i = 0; i < in.size(); i++) {
+    auto& t = in[i];
+    auto& c = completions[i];
+    memset(&c, 0, sizeof(c));
+    c.table = t.table;
+    c.request = (PAPI_REQUEST)t.request;
+    c.status = (PAPI_ERR)t.status;
+    c.step = (PAPI_INT)t.step;
+    c.msg_out_len = (PAPI_INT)t.msg_out.size();
+    if (t.msg_out.size())
+      c.msg_out = copy_to_message(t.msg_out);
+    c.bet_type = (PAPI_INT)t.bet;
+    if (t.bet != poker::BET_NONE)
+      c.bet_amount = copy_to_message(t.amount.to_string());
+  }
+  return (PAPI_INT)in.size();
+}
+
+extern "C" PAPI PAPI_ERR papi_tm_poll(PAPI_TABLE_MANAGER manager, PAPI_TABLE_COMPLETION* completions, PAPI_INT max_completions, PAPI_INT* count) {
+  std::vector<poker::table_completion> out;
+  ((poker::table_manager*)manager)->poll(out, max_completions);
+  *count = copy_table_completions(out, completions);
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_tm_wait(PAPI_TABLE_MANAGER manager, PAPI_TABLE_COMPLETION* completions, PAPI_INT max_completions, PAPI_INT timeout_ms, PAPI_INT* count) {
+  std::vector<poker::table_completion> out;
+  ((poker::table_manager*)manager)->wait(out, max_completions, timeout_ms);
+  *count = copy_table_completions(out, completions);
+  return PAPI_SUCCESS;
+}
+
+
+/*
+* Tracing
+*/
+
+extern "C" PAPI PAPI_ERR papi_set_tracing(PAPI_BOOL enabled) {
+  poker::enable_tracing(enabled);
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_dump_trace(PAPI_BUFFER json, PAPI_BOOL clear) {
+  std::ostringstream os;
+  poker::write_trace(os);
+  *(std::string*)json = os.str();
+  if (clear)
+    poker::clear_trace();
+  return PAPI_SUCCESS;
+}
+
+
+/*
+* Logging
+*/
+
+extern "C" PAPI PAPI_ERR papi_set_log_levels(const char* spec) {
+  if (!poker::set_log_levels(spec))
+    return (PAPI_ERR)poker::CFG_INVALID_LOG_LEVEL;
+  return PAPI_SUCCESS;
+}
+
+
+/*
+* Metrics
+*/
+
+extern "C" PAPI PAPI_ERR papi_get_metrics(PAPI_BUFFER json) {
+  std::ostringstream os;
+  poker::metrics::instance().write_json(os);
+  *(std::string*)json = os.str();
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_get_metrics_prometheus(PAPI_BUFFER text) {
+  std::ostringstream os;
+  poker::metrics::instance().write_prometheus(os);
+  *(std::string*)text = os.str();
+  return PAPI_SUCCESS;
+}
+
+extern "C" PAPI PAPI_ERR papi_get_scheduler_stats(PAPI_BUFFER json) {
+  std::string* out = (std::string*)json;
+  out->clear();
+  poker::json_writer w(*out);
+  poker::service_locator::instance().task_scheduler().write_json(w);
+  return PAPI_SUCCESS;
+}
+
+
+/*
+* Preflop equity
+*/
+
+static poker::preflop_equity_table preflop_table;
+#ifdef POKER_THREADS
+// a load unmaps the table lookups may be reading
+static std::mutex preflop_table_mutex;
+#endif
+
+extern "C" PAPI PAPI_ERR papi_load_preflop_equity(const char* path) {
+#ifdef POKER_THREADS
+  std::unique_lock<std::mutex> lock(preflop_table_mutex);
+#endif
+  return (PAPI_ERR)preflop_table.load(path);
+}
+
+extern "C" PAPI PAPI_ERR papi_preflop_equity(const PAPI_INT* alice_cards, const PAPI_INT* bob_cards, double* alice_equity) {
+  const poker::card_t cards[poker::NUM_PLAYERS][poker::NUM_PRIVATE_CARDS] = {
+    {alice_cards[0], alice_cards[1]}, {bob_cards[0], bob_cards[1]}};
+#ifdef POKER_THREADS
+  std::unique_lock<std::mutex> lock(preflop_table_mutex);
+#endif
+  return (PAPI_ERR)poker::preflop_equity(preflop_table, cards, *alice_equity);
+}
@@ -16,6 +16,49 @@ typedef void* PAPI_PLAYER;
 typedef char* PAPI_MESSAGE;
 typedef char* PAPI_STR;
 typedef char* PAPI_MONEY;
+typedef int64_t PAPI_REQUEST;
+typedef void* PAPI_BUFFER;
+
+/*
+* Result of an asynchronous call.
+* msg_out and bet_amount are owned by the caller and must be released
+* with papi_delete_message
+*/
+typedef struct {
+  PAPI_REQUEST request;
+  PAPI_ERR status;
+  PAPI_MESSAGE msg_out;
+  PAPI_INT msg_out_len;
+  PAPI_INT bet_type;      /* papi_process_bet_async only */
+  PAPI_MONEY bet_amount;  /* papi_process_bet_async only */
+  void* user_data;
+} PAPI_COMPLETION;
+
+typedef void* PAPI_TABLE_MANAGER;
+typedef uint64_t PAPI_TABLE;
+
+/*
+* Result of a table manager call.
+* msg_out must be sent to the opponent's table when msg_out_len > 0.
+* msg_out and bet_amount are owned by the caller and must be released
+* with papi_delete_message
+*/
+typedef struct {
+  PAPI_TABLE table;
+  PAPI_REQUEST request;
+  PAPI_ERR status;
+  PAPI_INT step;
+  PAPI_MESSAGE msg_out;
+  PAPI_INT msg_out_len;
+  PAPI_INT bet_type;      /* messages processed as bets only */
+  PAPI_MONEY bet_amount;  /* messages processed as bets only */
+} PAPI_TABLE_COMPLETION;
+
+/*
+* Completion callback. Runs on a worker thread; when NULL, the completion
+* is queued for papi_poll/papi_wait instead
+*/
+typedef void (*PAPI_CALLBACK)(PAPI_COMPLETION* completion);
 
 #ifndef PAPI
   #define PAPI
@@ -24,6 +67,13 @@ typedef char* PAPI_MONEY;
 extern "C" {
   
 PAPI_ERR PAPI papi_init(PAPI_BOOL encryption, PAPI_BOOL logging, PAPI_INT winner);
+/*
+* papi_init with a TMCG profile.
+* tmcg_profile: libTMCG group parameters proposed by Alice and the weakest
+* accepted by Bob, "fast-test", "standard" or "high"; NULL for the default
+* (POKER_TMCG_PROFILE or "standard")
+*/
+PAPI_ERR PAPI papi_init_ex(PAPI_BOOL encryption, PAPI_BOOL logging, PAPI_INT winner, const char* tmcg_profile);
 PAPI_ERR PAPI papi_new_player(PAPI_INT player_id, PAPI_PLAYER* player);
 PAPI_ERR PAPI papi_delete_player(PAPI_PLAYER player);
 PAPI_ERR PAPI papi_init_player(PAPI_PLAYER player, PAPI_MONEY alice_money, PAPI_MONEY bob_money, PAPI_MONEY big_blind);
@@ -32,7 +82,120 @@ PAPI_ERR PAPI papi_delete_message(PAPI_MESSAGE msg);
 PAPI_ERR PAPI papi_process_handshake(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_MESSAGE* msg_out, PAPI_INT* msg_out_len);
 PAPI_ERR PAPI papi_create_bet(PAPI_PLAYER player, PAPI_INT bet_type, PAPI_MONEY amt, PAPI_MESSAGE* msg_out, PAPI_INT* msg_out_len);
 PAPI_ERR PAPI papi_process_bet(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_MESSAGE* msg_out, PAPI_INT* msg_out_len, PAPI_INT* type, PAPI_STR amt, int amt_len);
+
+/*
+* Player checkpoints, to resume a hand after a restart or on another node.
+* papi_restore_player creates a new player from the state written by
+* papi_save_player
+*/
+PAPI_ERR PAPI papi_save_player(PAPI_PLAYER player, PAPI_BUFFER state);
+PAPI_ERR PAPI papi_restore_player(PAPI_MESSAGE state, PAPI_INT state_len, PAPI_PLAYER* player);
+
+/*
+* Game state as JSON. papi_get_game_state fails with API_BUFFER_TOO_SMALL
+* instead of truncating when json_len is too small; the *_into variant
+* grows the buffer as needed
+*/
 PAPI_ERR PAPI papi_get_game_state(PAPI_PLAYER player, PAPI_STR json, PAPI_INT json_len);
+PAPI_ERR PAPI papi_get_game_state_into(PAPI_PLAYER player, PAPI_BUFFER json);
+
+/*
+* Game state changes (cards opened, bets, phase changes, winner) after
+* sequence number since, as {"last_seq": n, "events": [...]}. Pass the
+* last_seq of the previous call to get only new events
+*/
+PAPI_ERR PAPI papi_get_events(PAPI_PLAYER player, PAPI_INT since, PAPI_BUFFER json);
+
+/*
+* Reusable output buffers.
+* The *_into variants write the engine output straight into a buffer
+* owned by the engine; its storage is reused by later calls. Data returned
+* by papi_buffer_data stays valid until the buffer is reused or deleted
+*/
+PAPI_ERR PAPI papi_new_buffer(PAPI_BUFFER* buffer);
+PAPI_ERR PAPI papi_delete_buffer(PAPI_BUFFER buffer);
+PAPI_ERR PAPI papi_buffer_data(PAPI_BUFFER buffer, PAPI_MESSAGE* data, PAPI_INT* len);
+PAPI_ERR PAPI papi_create_handshake_into(PAPI_PLAYER player, PAPI_BUFFER msg_out);
+PAPI_ERR PAPI papi_process_handshake_into(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_BUFFER msg_out);
+PAPI_ERR PAPI papi_create_bet_into(PAPI_PLAYER player, PAPI_INT bet_type, PAPI_MONEY amt, PAPI_BUFFER msg_out);
+PAPI_ERR PAPI papi_process_bet_into(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_BUFFER msg_out, PAPI_INT* type, PAPI_STR amt, int amt_len);
+
+/*
+* Asynchronous variants.
+* Work is queued on the library scheduler at interactive priority and
+* calls on the same player run in submission order. Input messages are copied before returning.
+* A player must not be deleted while it has calls in flight.
+* Without thread support the work runs before the call returns.
+*/
+PAPI_ERR PAPI papi_create_handshake_async(PAPI_PLAYER player, PAPI_CALLBACK callback, void* user_data, PAPI_REQUEST* request);
+PAPI_ERR PAPI papi_process_handshake_async(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_CALLBACK callback, void* user_data, PAPI_REQUEST* request);
+PAPI_ERR PAPI papi_create_bet_async(PAPI_PLAYER player, PAPI_INT bet_type, PAPI_MONEY amt, PAPI_CALLBACK callback, void* user_data, PAPI_REQUEST* request);
+PAPI_ERR PAPI papi_process_bet_async(PAPI_PLAYER player, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_CALLBACK callback, void* user_data, PAPI_REQUEST* request);
+
+/*
+* Completion queue for calls made without a callback.
+* papi_poll returns immediately; papi_wait blocks up to timeout_ms
+* (negative waits forever) for at least one completion
+*/
+PAPI_ERR PAPI papi_poll(PAPI_COMPLETION* completions, PAPI_INT max_completions, PAPI_INT* count);
+PAPI_ERR PAPI papi_wait(PAPI_COMPLETION* completions, PAPI_INT max_completions, PAPI_INT timeout_ms, PAPI_INT* count);
+
+/*
+* Table manager: owns the players of many tables, addressed by handles.
+* Calls queue work and return at once; each table runs its calls in order
+* on the library scheduler and results are read with papi_tm_poll or
+* papi_tm_wait. papi_tm_post_message processes a message from the
+* opponent as a handshake or a bet message depending on the game step.
+* Calls on a closed or unknown table fail with TBL_UNKNOWN_TABLE; a call
+* that throws completes with TBL_CALL_FAILED
+*/
+PAPI_ERR PAPI papi_tm_new(PAPI_TABLE_MANAGER* manager);
+PAPI_ERR PAPI papi_tm_delete(PAPI_TABLE_MANAGER manager);
+PAPI_ERR PAPI papi_tm_create_table(PAPI_TABLE_MANAGER manager, PAPI_INT player_id, PAPI_MONEY alice_money, PAPI_MONEY bob_money, PAPI_MONEY big_blind, PAPI_TABLE* table);
+PAPI_ERR PAPI papi_tm_restore_table(PAPI_TABLE_MANAGER manager, PAPI_MESSAGE state, PAPI_INT state_len, PAPI_TABLE* table);
+PAPI_ERR PAPI papi_tm_close_table(PAPI_TABLE_MANAGER manager, PAPI_TABLE table);
+PAPI_ERR PAPI papi_tm_create_handshake(PAPI_TABLE_MANAGER manager, PAPI_TABLE table, PAPI_REQUEST* request);
+PAPI_ERR PAPI papi_tm_post_message(PAPI_TABLE_MANAGER manager, PAPI_TABLE table, PAPI_MESSAGE msg_in, PAPI_INT msg_in_len, PAPI_REQUEST* request);
+PAPI_ERR PAPI papi_tm_create_bet(PAPI_TABLE_MANAGER manager, PAPI_TABLE table, PAPI_INT bet_type, PAPI_MONEY amt, PAPI_REQUEST* request);
+PAPI_ERR PAPI papi_tm_poll(PAPI_TABLE_MANAGER manager, PAPI_TABLE_COMPLETION* completions, PAPI_INT max_completions, PAPI_INT* count);
+PAPI_ERR PAPI papi_tm_wait(PAPI_TABLE_MANAGER manager, PAPI_TABLE_COMPLETION* completions, PAPI_INT max_completions, PAPI_INT timeout_ms, PAPI_INT* count);
+
+/*
+* Tracing.
+* Spans recorded while tracing is enabled (or POKER_TRACING=1) are written
+* to json as Chrome/Perfetto trace-event JSON; clear drops them afterwards
+*/
+PAPI_ERR PAPI papi_set_tracing(PAPI_BOOL enabled);
+PAPI_ERR PAPI papi_dump_trace(PAPI_BUFFER json, PAPI_BOOL clear);
+
+/*
+* Log levels, e.g. "info,participant=trace,referee=warn" (or POKER_LOG_LEVEL).
+* Levels: error, warn, info, debug (default), trace
+*/
+PAPI_ERR PAPI papi_set_log_levels(const char* spec);
+
+/*
+* Engine metrics: per-step latency histograms, message sizes before and
+* after compression and proof verification counts, as JSON or in the
+* Prometheus text exposition format
+*/
+PAPI_ERR PAPI papi_get_metrics(PAPI_BUFFER json);
+PAPI_ERR PAPI papi_get_metrics_prometheus(PAPI_BUFFER text);
+
+/*
+* Engine scheduler workers: tasks run per priority, tasks stolen from
+* other workers, busy and idle time and utilization, as JSON
+*/
+PAPI_ERR PAPI papi_get_scheduler_stats(PAPI_BUFFER json);
+
+/*
+* Heads-up preflop equity of alice_cards against bob_cards (two cards
+* each). Exact once the 1326x1326 table (make preflop-equity.bin) is
+* loaded, otherwise the equity of their starting hand classes.
+* Loading may run concurrently with lookups, which wait for it
+*/
+PAPI_ERR PAPI papi_load_preflop_equity(const char* path);
+PAPI_ERR PAPI papi_preflop_equity(const PAPI_INT* alice_cards, const PAPI_INT* bob_cards, double* alice_equity);
 
 } // extern "C"
 
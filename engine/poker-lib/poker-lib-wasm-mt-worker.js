@@ -0,0 +1,83 @@
+/*
+* Worker host for the threaded WebAssembly module (poker-lib-wasm-mt.js).
+*
+* Emscripten's BUILD_AS_WORKER mode cannot be combined with pthreads, so
+* this script implements the same message protocol on top of the regular
+* module: requests are {funcName, callbackId, data} and every response is
+* posted as {callbackId, data, finalResponse}.
+*
+* Runs as a browser Web Worker (requires cross-origin isolation for
+* SharedArrayBuffer) or as a node worker_threads Worker.
+*/
+
+(function () {
+    const isNode = typeof process === "object" && typeof require === "function" && typeof importScripts !== "function";
+    const scriptName = "poker-lib-wasm-mt.js";
+
+    let parentPort = null;
+    let scriptPath = scriptName;
+    if (isNode) {
+        parentPort = require("worker_threads").parentPort;
+        scriptPath = require("path").join(__dirname, scriptName);
+    }
+
+    function post(msg) {
+        if (isNode) parentPort.postMessage(msg);
+        else postMessage(msg);
+    }
+
+    let ready = false;
+    let pending = [];
+    let currentCallback = null;
+
+    // Called from the module (see worker_respond in poker-lib-wasm.cpp)
+    globalThis.pokerWorkerRespond = function (data, final) {
+        post({ callbackId: currentCallback, data: data, finalResponse: final });
+    };
+
+    function dispatch(msg) {
+        const func = Module["_" + msg.funcName];
+        if (!func) throw new Error("*** Unknown function " + msg.funcName);
+        let data = msg.data;
+        let ptr = 0;
+        if (data) {
+            if (!data.byteLength) data = new Uint8Array(data);
+            ptr = Module._malloc(data.length);
+            Module.HEAPU8.set(data, ptr);
+        }
+        currentCallback = msg.callbackId;
+        try {
+            func(ptr, data ? data.length : 0);
+        } finally {
+            if (ptr) Module._free(ptr);
+        }
+    }
+
+    function onRequest(msg) {
+        if (!ready) {
+            pending.push(msg);
+            return;
+        }
+        dispatch(msg);
+    }
+
+    globalThis.Module = {
+        mainScriptUrlOrBlob: scriptPath,
+        onRuntimeInitialized: function () {
+            ready = true;
+            const calls = pending;
+            pending = [];
+            calls.forEach(dispatch);
+        },
+    };
+
+    if (isNode) {
+        parentPort.on("message", onRequest);
+        require(scriptPath);
+    } else {
+        self.onmessage = function (e) {
+            onRequest(e.data);
+        };
+        importScripts(scriptName);
+    }
+})();
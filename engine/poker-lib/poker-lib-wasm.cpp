@@ -39,14 +39,34 @@ static inline INT read_int(char*& p) {
     return res;
 }
 
+// Reads a NUL-terminated string from memory and advances pointer
+static inline std::string read_string(char*& p) {
+    std::string res(p);
+    p += 1+res.size();
+    return res;
+}
+
 // helper functions for sending data back to webworker
 
+#ifdef POKER_WASM_MT
+// The threaded module is not built with BUILD_AS_WORKER; responses go
+// through the host script (poker-lib-wasm-mt-worker.js) instead.
+// The data is copied out of the shared heap before it is posted.
+EM_JS(void, mt_worker_respond, (char* data, int size, bool final), {
+    pokerWorkerRespond(HEAPU8.slice(data, data + size), final);
+});
+
+static inline void worker_respond(char* data, int size, bool final) {
+    mt_worker_respond(data, size, final);
+}
+#else
 static inline void worker_respond(char* data, int size, bool final) {
     if (final)
         emscripten_worker_respond(data, size);
     else
         emscripten_worker_respond_provisionally(data, size);
 }
+#endif
 
 static inline void worker_respond(INT p, bool final=true) {
     char* data = reinterpret_cast<char*>(&p);
@@ -76,6 +96,10 @@ static inline void worker_respond(poker::money_t& p, bool final=true) {
     worker_respond((char*)tmp.c_str(), tmp.size(), final);
 }
 
+// Output message storage, reused across calls so large handshake
+// messages do not reallocate. The worker runs one call at a time.
+static std::string msg_out;
+
 //
 // WASM Module exported functions
 //
@@ -92,6 +116,27 @@ void API poker_init(char* msg) {
     worker_respond(res);
 }
 
+// poker_init followed by tmcg_profile, empty for the default
+void API poker_init_ex(char* msg) {
+    // the options keep a pointer to it
+    static std::string tmcg_profile;
+    poker::poker_lib_options options;
+    options.encryption = read_int(msg);
+    options.logging = read_int(msg);
+    options.winner = read_int(msg);
+    tmcg_profile = read_string(msg);
+    auto res = poker::game_error::SUCCESS;
+    if (!tmcg_profile.empty()) {
+        if (poker::find_tmcg_profile(tmcg_profile))
+            options.tmcg_profile = tmcg_profile.c_str();
+        else
+            res = poker::TMC_UNKNOWN_PROFILE;
+    }
+    if (res == poker::game_error::SUCCESS)
+        poker::init_poker_lib(&options);
+    worker_respond(res);
+}
+
 void API poker_new_player(char* msg) {
     auto player_id = read_int(msg);
     auto player = new poker::player(player_id);
@@ -113,7 +158,7 @@ void API player_init(char* msg) {
 
 void API player_create_handshake(char* msg) {
     auto player = read_player(msg);
-    std::string msg_out;
+    msg_out.clear();
     auto res = player->create_handshake(msg_out);
     worker_respond(res, false);
     worker_respond(msg_out, true);
@@ -122,9 +167,8 @@ void API player_create_handshake(char* msg) {
 void API player_process_handshake(char* msg) {
     auto player = read_player(msg);
     auto msglen = read_int(msg);
-    std::string msg_in(msg, msglen);
-    std::string msg_out;
-    auto res = player->process_handshake(msg_in, msg_out);
+    msg_out.clear();
+    auto res = player->process_handshake(msg, msglen, msg_out);
     worker_respond(res, false);
     worker_respond(msg_out, true);
 }
@@ -133,7 +177,7 @@ void API player_create_bet(char* msg) {
     auto player = read_player(msg);
     auto type = read_int(msg);
     auto amt = read_money(msg);
-    std::string msg_out;
+    msg_out.clear();
     auto res = player->create_bet((poker::bet_type)type, amt, msg_out);
     worker_respond(res, false);
     worker_respond(msg_out, true);
@@ -144,22 +188,35 @@ void API player_process_bet(char* msg) {
     poker::money_t amt=0;
     auto player = read_player(msg);
     auto msglen = read_int(msg);
-    std::string msg_in(msg, msglen);
-    std::string msg_out;
-    auto res = player->process_bet(msg_in, msg_out, &type, &amt);
+    msg_out.clear();
+    auto res = player->process_bet(msg, msglen, msg_out, &type, &amt);
     worker_respond(res, false);
     worker_respond((INT)type, false);
     worker_respond(amt, false);
     worker_respond(msg_out, true);
 }
 
+// reused across calls so that its storage is kept
+static std::string json_buffer;
+
 void API player_game_state(char* msg) {
     auto player = read_player(msg);
-    auto g = player->game();
-    char extra_fields[100];
-    sprintf(extra_fields, "\"step\": %d", (int)player->step());
-    auto json = g.to_json(extra_fields);
-    worker_respond(json.c_str());
+    json_buffer.clear();
+    poker::json_writer w(json_buffer);
+    w.begin_object();
+    player->game().write_json_fields(w, true);
+    w.key("step").value((int)player->step());
+    w.end_object();
+    worker_respond(json_buffer.c_str());
+}
+
+void API player_events(char* msg) {
+    auto player = read_player(msg);
+    auto since = read_int(msg);
+    json_buffer.clear();
+    poker::json_writer w(json_buffer);
+    player->events().write_json(since < 0 ? 0 : since, w);
+    worker_respond(json_buffer.c_str());
 }
 
 } // extern "C"
@@ -4,6 +4,7 @@
 
 #include "game-state.h"
 #include "service_locator.h"
+#include "trace.h"
 
 namespace poker {
 
@@ -15,9 +16,26 @@ int init_poker_lib(poker_lib_options* opts) {
 
     init_libTMCG();
     logging_enabled = opts->logging;
+    set_log_levels(opts->log_levels);
+    enable_tracing(opts->tracing);
     service_locator::load(opts);
 
     return 0;
 }
 
+int message_version() {
+    auto& opts = service_locator::instance().options();
+    return opts.encryption && opts.backend == BACKEND_EC ? poker_ec_version : poker_version;
+}
+
+game_error backend_of_version(int version, participant_backend& backend) {
+    if (version == poker_version)
+        backend = BACKEND_DLOG;
+    else if (version == poker_ec_version)
+        backend = BACKEND_EC;
+    else
+        return COD_VERSION_MISMATCH;
+    return SUCCESS;
+}
+
 }  // namespace poker
@@ -12,20 +12,69 @@
 
 namespace poker {
 
-const int poker_version = 0x010000;
+// 0x010001: msg_vtmf carries the TMCG profile ahead of the group
+const int poker_version = 0x010001;
+// messages of the elliptic curve backend, not readable by the other
+const int poker_ec_version = 0x010200;
+
+enum participant_backend {
+    // libTMCG, discrete logarithms modulo a 2048-bit prime
+    BACKEND_DLOG,
+    // Ed25519, see ec_participant.h
+    BACKEND_EC,
+};
+
+#ifdef POKER_THREADS
+const bool poker_threads_available = true;
+#else
+const bool poker_threads_available = false;
+#endif
 
 struct poker_lib_options {
-    poker_lib_options() : encryption(true), logging(false), winner(-1) {
+    poker_lib_options() : encryption(true), logging(false), winner(-1), pipelined(poker_threads_available), tracing(false), backend(BACKEND_DLOG), tmcg_profile("standard"), tmcg_min_profile(NULL), referee_tmcg_min_profile(NULL) {
+        log_levels = getenv("POKER_LOG_LEVEL");
         auto env_logging = getenv("POKER_LOGGING");
         logging = env_logging && 0 == strcmp(env_logging, "1");
+        auto env_tracing = getenv("POKER_TRACING");
+        tracing = env_tracing && 0 == strcmp(env_tracing, "1");
+        auto env_backend = getenv("POKER_BACKEND");
+        if (env_backend && 0 == strcmp(env_backend, "ec"))
+            backend = BACKEND_EC;
+        if (getenv("POKER_TMCG_PROFILE"))
+            tmcg_profile = getenv("POKER_TMCG_PROFILE");
+        tmcg_min_profile = getenv("POKER_TMCG_MIN_PROFILE");
+        referee_tmcg_min_profile = getenv("POKER_REFEREE_TMCG_MIN_PROFILE");
     }
     bool encryption;
     bool logging;
     int winner;
+    // Overlap verification of the opponent's shuffle with our own mix
+    bool pipelined;
+    // Record trace spans (see trace.h)
+    bool tracing;
+    // Log levels, e.g. "info,participant=trace" (see log.h)
+    const char* log_levels;
+    // Group of the encrypted participants (POKER_BACKEND=ec for BACKEND_EC)
+    participant_backend backend;
+    // Parameters of the libTMCG groups proposed by Alice: "fast-test",
+    // "standard" or "high" (see participant.h)
+    const char* tmcg_profile;
+    // Weakest profile Bob accepts from Alice, NULL for tmcg_profile
+    const char* tmcg_min_profile;
+    // Weakest profile referees and the verifier accept, NULL for any known
+    const char* referee_tmcg_min_profile;
 };
 
 int init_poker_lib(poker_lib_options* opts = NULL);
 
+// Version of the messages written by the configured backend, the only
+// one players accept
+int message_version();
+
+// Backend of the games whose messages have the given version; a referee
+// replaying a game takes it from the game's first message
+game_error backend_of_version(int version, participant_backend& backend);
+
 }  // namespace poker
 
 #endif
\ No newline at end of file
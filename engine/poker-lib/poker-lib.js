@@ -71,6 +71,12 @@ class Player {
         });
     }
 
+    async events(since) {
+        return this.callWorker('player_events', makeMessage(this._p, since), (results) => {
+            return JSON.parse(parseString(results[0]));
+        });
+    }
+
     registerCallback(fn) {
         const callbackId = ++this.ctr;
         this.cbks[callbackId] = { fn, results:[] };
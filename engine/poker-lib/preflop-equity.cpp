@@ -0,0 +1,174 @@
+#include "preflop-equity.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "hand-eval.h"
+
+namespace poker {
+
+#include "preflop-classes.inc"
+
+static const char rank_chars[] = "23456789TJQKA";
+
+int preflop_class(card_t c1, card_t c2) {
+    int r1 = c1 % NUM_RANKS, r2 = c2 % NUM_RANKS;
+    int high = std::max(r1, r2), low = std::min(r1, r2);
+    if (c1 / NUM_RANKS == c2 / NUM_RANKS)
+        return high * NUM_RANKS + low;
+    return low * NUM_RANKS + high;
+}
+
+std::string preflop_class_name(int preflop_class) {
+    int row = preflop_class / NUM_RANKS, col = preflop_class % NUM_RANKS;
+    std::string name;
+    name += rank_chars[std::max(row, col)];
+    name += rank_chars[std::min(row, col)];
+    if (row != col)
+        name += row > col ? 's' : 'o';
+    return name;
+}
+
+int holding_index(card_t c1, card_t c2) {
+    int high = std::max(c1, c2), low = std::min(c1, c2);
+    return high * (high - 1) / 2 + low;
+}
+
+void canonical_holdings(const card_t private_cards[NUM_PLAYERS][NUM_PRIVATE_CARDS],
+                        card_t canonical[NUM_PLAYERS][NUM_PRIVATE_CARDS]) {
+    // smallest relabeling over all 24 suit permutations, with the cards
+    // of each holding in descending order
+    int perm[NUM_SUITS] = {0, 1, 2, 3};
+    bool first = true;
+    do {
+        card_t c[NUM_PLAYERS][NUM_PRIVATE_CARDS];
+        for (int p = 0; p < NUM_PLAYERS; p++) {
+            for (int i = 0; i < NUM_PRIVATE_CARDS; i++) {
+                auto card = private_cards[p][i];
+                c[p][i] = perm[card / NUM_RANKS] * NUM_RANKS + card % NUM_RANKS;
+            }
+            std::sort(c[p], c[p] + NUM_PRIVATE_CARDS, [](card_t a, card_t b) { return a > b; });
+        }
+        if (first || std::lexicographical_compare(&c[0][0], &c[0][0] + NUM_PLAYERS * NUM_PRIVATE_CARDS,
+                                                  &canonical[0][0],
+                                                  &canonical[0][0] + NUM_PLAYERS * NUM_PRIVATE_CARDS))
+            std::copy(&c[0][0], &c[0][0] + NUM_PLAYERS * NUM_PRIVATE_CARDS, &canonical[0][0]);
+        first = false;
+    } while (std::next_permutation(perm, perm + NUM_SUITS));
+}
+
+double preflop_class_equity(int c1, int c2) {
+    return preflop_class_equities[c1][c2];
+}
+
+preflop_equity_table::preflop_equity_table() : _data(NULL), _size(0), _table(NULL) {}
+
+preflop_equity_table::~preflop_equity_table() {
+    unload();
+}
+
+void preflop_equity_table::unload() {
+    if (!_data)
+        return;
+#ifdef _WIN32
+    delete[](const char*) _data;
+#else
+    munmap((void*)_data, _size);
+#endif
+    _data = NULL;
+    _size = 0;
+    _table = NULL;
+}
+
+game_error preflop_equity_table::load(const char* path) {
+    unload();
+    const size_t expected_size = sizeof(preflop_equity_header) + sizeof(float) * NUM_HOLDINGS * NUM_HOLDINGS;
+#ifdef _WIN32
+    std::ifstream is(path, std::ios::binary | std::ios::ate);
+    if (!is) {
+        logger_at(LOG_ERROR) << "cannot open preflop equity table " << path;
+        return PEQ_OPEN_TABLE;
+    }
+    size_t size = is.tellg();
+    if (size != expected_size) {
+        logger_at(LOG_ERROR) << "invalid preflop equity table size " << size;
+        return PEQ_INVALID_TABLE;
+    }
+    char* data = new char[size];
+    is.seekg(0);
+    if (!is.read(data, size)) {
+        delete[] data;
+        return PEQ_OPEN_TABLE;
+    }
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        logger_at(LOG_ERROR) << "cannot open preflop equity table " << path;
+        return PEQ_OPEN_TABLE;
+    }
+    struct stat st;
+    if (fstat(fd, &st)) {
+        close(fd);
+        return PEQ_OPEN_TABLE;
+    }
+    if ((size_t)st.st_size != expected_size) {
+        logger_at(LOG_ERROR) << "invalid preflop equity table size " << st.st_size;
+        close(fd);
+        return PEQ_INVALID_TABLE;
+    }
+    size_t size = st.st_size;
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        logger_at(LOG_ERROR) << "cannot map preflop equity table " << path;
+        return PEQ_OPEN_TABLE;
+    }
+#endif
+    _data = data;
+    _size = size;
+
+    auto header = (const preflop_equity_header*)_data;
+    if (header->magic != PREFLOP_EQUITY_MAGIC || header->version != PREFLOP_EQUITY_VERSION ||
+        header->num_holdings != NUM_HOLDINGS) {
+        logger_at(LOG_ERROR) << "invalid preflop equity table header";
+        unload();
+        return PEQ_INVALID_TABLE;
+    }
+    _table = (const float*)(header + 1);
+    return SUCCESS;
+}
+
+game_error preflop_equity_table::equity(const card_t private_cards[NUM_PLAYERS][NUM_PRIVATE_CARDS],
+                                        double& alice_equity) const {
+    game_error res;
+    if (!_table)
+        return PEQ_TABLE_NOT_LOADED;
+    if ((res = check_hand(&private_cards[0][0], NUM_PLAYERS * NUM_PRIVATE_CARDS)))
+        return res;
+    auto alice = holding_index(private_cards[ALICE][0], private_cards[ALICE][1]);
+    auto bob = holding_index(private_cards[BOB][0], private_cards[BOB][1]);
+    alice_equity = _table[alice * NUM_HOLDINGS + bob];
+    return SUCCESS;
+}
+
+game_error preflop_equity(const preflop_equity_table& table,
+                          const card_t private_cards[NUM_PLAYERS][NUM_PRIVATE_CARDS], double& alice_equity) {
+    game_error res;
+    if (table.loaded())
+        return table.equity(private_cards, alice_equity);
+    if ((res = check_hand(&private_cards[0][0], NUM_PLAYERS * NUM_PRIVATE_CARDS)))
+        return res;
+    alice_equity = preflop_class_equity(preflop_class(private_cards[ALICE][0], private_cards[ALICE][1]),
+                                        preflop_class(private_cards[BOB][0], private_cards[BOB][1]));
+    return SUCCESS;
+}
+
+}  // namespace poker
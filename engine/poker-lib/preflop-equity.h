@@ -0,0 +1,85 @@
+#ifndef PREFLOP_EQUITY_H
+#define PREFLOP_EQUITY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "common.h"
+
+namespace poker {
+
+/*
+ * Precomputed heads-up preflop equity.
+ * The 169x169 table of starting hand classes is compiled in
+ * (preflop-classes.inc); the exact 1326x1326 table of holdings is a file
+ * written by gen-preflop-equity and mapped into memory. gen-preflop-equity
+ * writes both, ranking every board once for all holdings with the batch
+ * evaluator rather than running compute_equity for each pair.
+*/
+
+const int NUM_PREFLOP_CLASSES = 169;
+const int NUM_HOLDINGS = 1326;
+
+// Starting hand class of two distinct cards, laid out as a 13x13 grid:
+// pairs on the diagonal (rank * 13 + rank), suited hands above it
+// (high * 13 + low) and offsuit hands below it (low * 13 + high)
+int preflop_class(card_t c1, card_t c2);
+
+// "AA", "AKs", "T9o"...
+std::string preflop_class_name(int preflop_class);
+
+// Index of two distinct cards among all 1326 holdings, in either order
+int holding_index(card_t c1, card_t c2);
+
+// Relabels suits so that all holdings isomorphic under a permutation of
+// the suits map to the same cards. Cards are not checked
+void canonical_holdings(const card_t private_cards[NUM_PLAYERS][NUM_PRIVATE_CARDS],
+                        card_t canonical[NUM_PLAYERS][NUM_PRIVATE_CARDS]);
+
+// ALICE's equity with class c1 against BOB's class c2, averaged over all
+// pairs of holdings that do not share a card
+double preflop_class_equity(int c1, int c2);
+
+/*
+ * 1326x1326 table of ALICE's equity, indexed by holding_index. The file
+ * is a preflop_equity_header followed by the table, in host byte order;
+ * entries of holdings that share a card are -1
+*/
+struct preflop_equity_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_holdings;
+    uint32_t reserved;
+};
+
+const uint32_t PREFLOP_EQUITY_MAGIC = 0x51455050;  // "PPEQ"
+const uint32_t PREFLOP_EQUITY_VERSION = 1;
+
+class preflop_equity_table {
+    const void* _data;
+    size_t _size;
+    const float* _table;
+
+    preflop_equity_table(const preflop_equity_table&);
+    preflop_equity_table& operator=(const preflop_equity_table&);
+
+   public:
+    preflop_equity_table();
+    virtual ~preflop_equity_table();
+
+    game_error load(const char* path);
+    void unload();
+    bool loaded() const { return _table != NULL; }
+
+    // ALICE's equity; PEQ_TABLE_NOT_LOADED when no table is loaded
+    game_error equity(const card_t private_cards[NUM_PLAYERS][NUM_PRIVATE_CARDS], double& alice_equity) const;
+};
+
+// Exact equity from table when it is loaded, otherwise the class equity
+game_error preflop_equity(const preflop_equity_table& table,
+                          const card_t private_cards[NUM_PLAYERS][NUM_PRIVATE_CARDS], double& alice_equity);
+
+}  // namespace poker
+
+#endif
@@ -1,11 +1,20 @@
 #include "referee.h"
 
+#include "codec.h"
 #include "validator.h"
 #include "service_locator.h"
+#include "metrics.h"
+#include "trace.h"
 
 namespace poker {
 
-referee::referee() : _step(game_step::INIT_GAME), _eve(service_locator::instance().new_participant()) {
+referee::referee() : _step(game_step::INIT_GAME), _eve(NULL), _backend(BACKEND_DLOG) {
+}
+
+void referee::create_eve(participant_backend backend) {
+    delete _eve;
+    _backend = backend;
+    _eve = service_locator::instance().new_referee_participant(backend);
     _eve->init(1 + NUM_PLAYERS, NUM_PLAYERS, true);
 }
 
@@ -13,7 +22,49 @@ referee::~referee() {
     delete _eve;
 }
 
+game_error referee::save(std::ostream& os) {
+    TRACE_FUNC("referee");
+    game_error res;
+    encoder out(os);
+    if ((res = out.write((int)_step)))
+        return res;
+    if ((res = _g.write(os)) || (res = _events.write(os)))
+        return res;
+    if ((res = out.write(_eve != NULL)) || (res = out.write((int)_backend)))
+        return res;
+    return _eve ? _eve->save(os) : SUCCESS;
+}
+
+game_error referee::restore(std::istream& is) {
+    TRACE_FUNC("referee");
+    game_error res;
+    decoder in(is);
+    int step;
+    if ((res = in.read(step)))
+        return res;
+    if (step < INIT_GAME || step > GAME_OVER)
+        return COD_ERROR;
+    _step = (game_step)step;
+    if ((res = _g.read(is)) || (res = _events.read(is)))
+        return res;
+    bool has_eve;
+    int backend;
+    if ((res = in.read(has_eve)) || (res = in.read(backend)))
+        return res;
+    if (backend != BACKEND_DLOG && backend != BACKEND_EC)
+        return COD_ERROR;
+    delete _eve;
+    _eve = NULL;
+    _backend = (participant_backend)backend;
+    if (!has_eve)
+        return SUCCESS;
+    create_eve(_backend);
+    return _eve->restore(is);
+}
+
 game_error referee::step_init_game(money_t alice_money, money_t bob_money, money_t big_blind) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::INIT_GAME);
     if (_g.error)
         return ERR_GAME_OVER;
     if (_step != game_step::INIT_GAME)
@@ -30,12 +81,15 @@ game_error referee::step_init_game(money_t alice_money, money_t bob_money, money
 
 }
 
-game_error referee::step_vtmf_group(blob& g) {
+game_error referee::step_vtmf_group(blob& g, participant_backend backend) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::VTMF_GROUP);
     logger << "step_vtmf_group..." << std::endl;
     if (_g.error) return ERR_GAME_OVER;
     if (_step != game_step::VTMF_GROUP)
         return (_g.error = ERR_INVALID_MOVE);
 
+    create_eve(backend);
     if (_eve->load_group(g))
         return (_g.error = ERR_VTMF_LOAD_FAILED);
 
@@ -44,6 +98,8 @@ game_error referee::step_vtmf_group(blob& g) {
 }
 
 game_error referee::step_load_keys(blob& bob_key, blob& alice_key, /* out */ blob& eve_key) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::LOAD_KEYS);
     logger << "step_load_keys..." << std::endl;
     if (_g.error) return ERR_GAME_OVER;
     if (_step != game_step::LOAD_KEYS)
@@ -63,6 +119,8 @@ game_error referee::step_load_keys(blob& bob_key, blob& alice_key, /* out */ blo
 }
 
 game_error referee::step_vsshe_group(blob& vsshe) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::VSSHE_GROUP);
     logger << "step_vsshe_group..." << std::endl;
     if (_g.error) return ERR_GAME_OVER;
     if (_step != game_step::VSSHE_GROUP)
@@ -78,6 +136,8 @@ game_error referee::step_vsshe_group(blob& vsshe) {
 }
 
 game_error referee::step_alice_mix(blob& mix, blob& proof) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::ALICE_MIX);
     logger << "step_alice_mix..." << std::endl;
     if (_g.error) return ERR_GAME_OVER;
     if (_step != game_step::ALICE_MIX)
@@ -91,6 +151,8 @@ game_error referee::step_alice_mix(blob& mix, blob& proof) {
 }
 
 game_error referee::step_bob_mix(blob& mix, blob& proof) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::BOB_MIX);
     logger << "step_bob_mix..." << std::endl;
     if (_g.error) return ERR_GAME_OVER;
     if (_step != game_step::BOB_MIX)
@@ -104,6 +166,8 @@ game_error referee::step_bob_mix(blob& mix, blob& proof) {
 }
 
 game_error referee::step_final_mix(blob& mix, blob& proof) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::FINAL_MIX);
     logger << "step_final_mix..." << std::endl;
     if (_g.error) return ERR_GAME_OVER;
     if (_step != game_step::FINAL_MIX)
@@ -117,6 +181,8 @@ game_error referee::step_final_mix(blob& mix, blob& proof) {
 }
 
 game_error referee::step_take_cards_from_stack() {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::TAKE_CARDS_FROM_STACK);
     logger << "step_take_cards_from_stack..." << std::endl;
     if (_g.error) return ERR_GAME_OVER;
     if (_step != game_step::TAKE_CARDS_FROM_STACK)
@@ -130,6 +196,8 @@ game_error referee::step_take_cards_from_stack() {
 }
 
 game_error referee::step_open_private_cards(int player_id, blob& alice_proofs, blob& bob_proofs) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::OPEN_PRIVATE_CARDS);
     logger << "step_open_private_cards..." << std::endl;
     game_error res;
     if (_g.error) return ERR_GAME_OVER;
@@ -146,6 +214,8 @@ game_error referee::step_open_private_cards(int player_id, blob& alice_proofs, b
 }
 
 game_error referee::step_preflop_bet(int player_id, bet_type type, money_t amt) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::PREFLOP_BET);
     logger << "step_preflop_bet..." << std::endl;
     game_error res;
     if (_g.error) return ERR_GAME_OVER;
@@ -163,6 +233,8 @@ game_error referee::step_preflop_bet(int player_id, bet_type type, money_t amt)
 }
 
 game_error referee::step_open_flop(blob& alice_proofs, blob& bob_proofs) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::OPEN_FLOP);
     logger << "step_open_flop..." << std::endl;
     game_error res;
     if (_g.error) return ERR_GAME_OVER;
@@ -177,6 +249,8 @@ game_error referee::step_open_flop(blob& alice_proofs, blob& bob_proofs) {
 }
 
 game_error referee::step_flop_bet(int player_id, bet_type type, money_t amt) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::FLOP_BET);
     logger << "step_flop_bet..." << std::endl;
     game_error res;
     if (_g.error) return ERR_GAME_OVER;
@@ -194,6 +268,8 @@ game_error referee::step_flop_bet(int player_id, bet_type type, money_t amt) {
 }
 
 game_error referee::step_open_turn(blob& alice_proofs, blob& bob_proofs) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::OPEN_TURN);
     logger << "step_open_turn..." << std::endl;
     game_error res;
     if (_g.error) return ERR_GAME_OVER;
@@ -208,6 +284,8 @@ game_error referee::step_open_turn(blob& alice_proofs, blob& bob_proofs) {
 }
 
 game_error referee::step_turn_bet(int player_id, bet_type type, money_t amt) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::TURN_BET);
     logger << "step_turn_bet..." << std::endl;
     game_error res;
     if (_g.error) return ERR_GAME_OVER;
@@ -225,6 +303,8 @@ game_error referee::step_turn_bet(int player_id, bet_type type, money_t amt) {
 }
 
 game_error referee::step_open_river(blob& alice_proofs, blob& bob_proofs) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::OPEN_RIVER);
     logger << "step_open_river..." << std::endl;
     game_error res;
     if (_g.error) return ERR_GAME_OVER;
@@ -239,6 +319,8 @@ game_error referee::step_open_river(blob& alice_proofs, blob& bob_proofs) {
 }
 
 game_error referee::step_river_bet(int player_id, bet_type type, money_t amt) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::RIVER_BET);
     logger << "step_river_bet..." << std::endl;
     game_error res;
     if (_g.error) return ERR_GAME_OVER;
@@ -275,9 +357,12 @@ game_error referee::bet(int player_id, bet_type type, money_t amt) {
 game_error referee::compute_bet(bet_type type, money_t& amt, game_step next_step) {
     game_error res;
     auto phs = _g.phase;
+    auto player_id = _g.current_player;
 
     if ((res = place_bet(_g, type, amt)))
         return res;
+    _events.bet_placed(player_id, type, amt, _g.players[player_id].bets);
+    record_phase_change(phs);
 
     if (_g.phase == PHS_GAME_OVER) {
         _step = game_step::GAME_OVER;
@@ -290,6 +375,8 @@ game_error referee::compute_bet(bet_type type, money_t& amt, game_step next_step
 }
 
 game_error referee::step_showdown(int player_id, blob& alice_proofs, blob& bob_proofs, bool muck) {
+    TRACE_FUNC("referee");
+    step_timer _step_timer(game_step::SHOWDOWN);
     logger << "step_showdown..." << std::endl;
     game_error res;
     
@@ -298,6 +385,7 @@ game_error referee::step_showdown(int player_id, blob& alice_proofs, blob& bob_p
     if (_step != game_step::SHOWDOWN)
         return (_g.error = ERR_INVALID_MOVE);
 
+    auto phs = _g.phase;
     if (muck) {
         _g.muck = true;
         _g.winner = opponent_id(player_id);
@@ -311,6 +399,7 @@ game_error referee::step_showdown(int player_id, blob& alice_proofs, blob& bob_p
         if ((res = decide_winner()))
             return res;
     }
+    record_phase_change(phs);
 
     _step = game_step::GAME_OVER;
 
@@ -335,7 +424,8 @@ game_error referee::open_public_cards(blob& alice_proofs, blob& bob_proofs, int
         if (_eve->open_card(card_index))
             return (_g.error = ERR_OPEN_PUBLIC_OPEN_CARD);
         
-        _g.public_cards[card_index - first_pc] = _eve->get_open_card(card_index);
+        _g.open_public_card(card_index - first_pc, _eve->get_open_card(card_index));
+        _events.card_opened(NONE, card_index - first_pc, _g.public_cards[card_index - first_pc]);
     }
     return SUCCESS;
 }
@@ -367,7 +457,6 @@ game_error referee::open_private_cards(int player_id, blob& alice_proofs, blob&
     bob_proofs.set_auto_rewind(false);    
     alice_proofs.rewind();
     bob_proofs.rewind();
-    auto& player = _g.players[player_id];
     for(auto i=0; i<NUM_PRIVATE_CARDS; i++) {
         auto card_index = private_card_index(player_id, i);
         if (_eve->self_card_secret(card_index))
@@ -378,7 +467,8 @@ game_error referee::open_private_cards(int player_id, blob& alice_proofs, blob&
             return (_g.error = ERR_OPEN_PRIVATE_VERIFY_BOB_SECRET);
         if (_eve->open_card(card_index))
             return (_g.error = ERR_OPEN_PRIVATE_OPEN_CARD);
-        player.cards[i] = _eve->get_open_card(card_index);
+        _g.open_private_card(player_id, i, _eve->get_open_card(card_index));
+        _events.card_opened(player_id, i, _g.players[player_id].cards[i]);
     }
     return SUCCESS;
 }
@@ -387,5 +477,13 @@ game_error referee::decide_winner() {
     return poker::decide_winner(_g);
 }
 
+void referee::record_phase_change(bet_phase previous) {
+    if (_g.phase == previous)
+        return;
+    _events.phase_changed(_g.phase);
+    if (_g.phase == PHS_GAME_OVER)
+        _events.winner_decided(_g.winner);
+}
+
 
 } // namespace poker
\ No newline at end of file
@@ -2,7 +2,9 @@
 #define REFEREE_H
 
 #include "participant.h"
+#include "poker-lib.h"
 #include "game-state.h"
+#include "game-events.h"
 
 namespace poker {
 
@@ -12,8 +14,11 @@ namespace poker {
 */
 class referee {
     game_state  _g;
+    // created with the group, of the backend of the game
     i_participant* _eve;
+    participant_backend _backend;
     game_step   _step;
+    game_event_log _events;
 public:    
     referee();
     virtual ~referee();
@@ -22,8 +27,10 @@ public:
 
     game_state& game() { return _g; }
 
+    const game_event_log& events() const { return _events; }
+
     game_error step_init_game(money_t alice_money, money_t bob_money, money_t big_blind);
-    game_error step_vtmf_group(blob& g);
+    game_error step_vtmf_group(blob& g, participant_backend backend);
     game_error step_load_keys(blob& bob_key, blob& alice_key, /* out */ blob& eve_key);
     game_error step_vsshe_group(blob& vsshe);
     game_error step_alice_mix(blob& mix, blob& proof);
@@ -45,10 +52,16 @@ public:
     game_error open_public_cards(game_step step, blob& alice_proof, blob bob_proof);
     game_error open_private_cards(int player_id, blob& alice_proofs, blob& bob_proofs);
 
+    // Checkpoint of the step, the game state, the events and eve
+    game_error save(std::ostream& os);
+    game_error restore(std::istream& is);
+
 private:
+    void create_eve(participant_backend backend);
     game_error compute_bet(bet_type type, money_t& amt, game_step next_step);
     game_error open_public_cards(blob& alice_proofs, blob& bob_proofs, int first_card_index, int card_count);
     game_error decide_winner();
+    void record_phase_change(bet_phase previous);
 };
 
 } // namespace poker
@@ -0,0 +1,363 @@
+#include "scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace poker {
+
+#ifdef POKER_THREADS
+
+// worker running on this thread, used to queue tasks submitted from tasks locally
+static thread_local scheduler* current_scheduler = NULL;
+static thread_local int current_worker = -1;
+
+static uint64_t elapsed_us(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since).count();
+}
+
+scheduler::worker::worker() : stolen(0), busy_us(0), idle_us(0) {
+    for (int p = 0; p < NUM_PRIORITIES; p++)
+        num_tasks[p] = 0;
+}
+
+scheduler::scheduler(int num_threads) : _num_threads(num_threads), _stopping(false), _queued(0), _next_worker(0) {
+    if (_num_threads <= 0)
+        _num_threads = std::thread::hardware_concurrency();
+    if (_num_threads <= 0)
+        _num_threads = 2;
+    for (int i = 0; i < _num_threads; i++)
+        _workers.emplace_back(new worker());
+}
+
+scheduler::~scheduler() {
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _ready_cv.notify_all();
+    for (auto& t : _threads)
+        t.join();
+}
+
+int scheduler::num_threads() {
+    return _num_threads;
+}
+
+void scheduler::start() {
+    for (int i = 0; i < _num_threads; i++)
+        _threads.push_back(std::thread(&scheduler::run, this, i));
+}
+
+void scheduler::submit(task t, task_priority priority) {
+    int index = current_worker;
+    if (current_scheduler != this)
+        index = _next_worker++ % _num_threads;
+    {
+        auto& w = *_workers[index];
+        std::unique_lock<std::mutex> lock(w.mutex);
+        w.tasks[priority].push_back(t);
+    }
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_threads.empty())
+            start();
+        _queued++;
+    }
+    _ready_cv.notify_one();
+}
+
+void scheduler::submit(const void* key, task t, task_priority priority) {
+    {
+        std::unique_lock<std::mutex> lock(_lanes_mutex);
+        auto it = _lanes.find(key);
+        if (it != _lanes.end()) {
+            // key is either queued or running; its next task is submitted when the current one ends
+            it->second.push_back(t);
+            return;
+        }
+        _lanes[key].push_back(t);
+    }
+    submit([this, key, priority]() { run_lane(key, priority); }, priority);
+}
+
+void scheduler::run_lane(const void* key, task_priority priority) {
+    task t;
+    {
+        std::unique_lock<std::mutex> lock(_lanes_mutex);
+        t = _lanes[key].front();
+    }
+    try {
+        t();
+    } catch (std::exception& e) {
+        logger_at(LOG_ERROR) << "*** scheduler: task failed: " << e.what() << std::endl;
+    } catch (...) {
+        logger_at(LOG_ERROR) << "*** scheduler: task failed" << std::endl;
+    }
+    {
+        std::unique_lock<std::mutex> lock(_lanes_mutex);
+        auto it = _lanes.find(key);
+        it->second.pop_front();
+        if (it->second.empty()) {
+            _lanes.erase(it);
+            return;
+        }
+    }
+    submit([this, key, priority]() { run_lane(key, priority); }, priority);
+}
+
+bool scheduler::take(int index, task& t, int& priority) {
+    for (priority = 0; priority < NUM_PRIORITIES; priority++) {
+        // own newest task first
+        {
+            auto& w = *_workers[index];
+            std::unique_lock<std::mutex> lock(w.mutex);
+            auto& q = w.tasks[priority];
+            if (!q.empty()) {
+                t = std::move(q.back());
+                q.pop_back();
+                return true;
+            }
+        }
+        // then the oldest task of another worker
+        for (int i = 1; i < _num_threads; i++) {
+            auto& w = *_workers[(index + i) % _num_threads];
+            std::unique_lock<std::mutex> lock(w.mutex);
+            auto& q = w.tasks[priority];
+            if (!q.empty()) {
+                t = std::move(q.front());
+                q.pop_front();
+                _workers[index]->stolen++;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void scheduler::run(int index) {
+    current_scheduler = this;
+    current_worker = index;
+    auto& w = *_workers[index];
+    while (true) {
+        task t;
+        int priority;
+        if (take(index, t, priority)) {
+            _queued--;
+            auto start = std::chrono::steady_clock::now();
+            try {
+                t();
+            } catch (std::exception& e) {
+                logger_at(LOG_ERROR) << "*** scheduler: task failed: " << e.what() << std::endl;
+            } catch (...) {
+                logger_at(LOG_ERROR) << "*** scheduler: task failed" << std::endl;
+            }
+            w.busy_us += elapsed_us(start);
+            w.num_tasks[priority]++;
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(_mutex);
+        _ready_cv.wait(lock, [this] { return _stopping || _queued > 0; });
+        w.idle_us += elapsed_us(start);
+        if (_stopping && _queued == 0)
+            return;
+    }
+}
+
+void scheduler::get_stats(std::vector<worker_stats>& stats) {
+    stats.clear();
+    for (auto& w : _workers) {
+        worker_stats s;
+        for (int p = 0; p < NUM_PRIORITIES; p++)
+            s.tasks[p] = w->num_tasks[p];
+        s.stolen = w->stolen;
+        s.busy_us = w->busy_us;
+        s.idle_us = w->idle_us;
+        stats.push_back(s);
+    }
+}
+
+#else
+
+scheduler::scheduler(int num_threads) {}
+
+scheduler::~scheduler() {}
+
+int scheduler::num_threads() {
+    return 0;
+}
+
+void scheduler::submit(task t, task_priority priority) {
+    t();
+}
+
+void scheduler::submit(const void* key, task t, task_priority priority) {
+    t();
+}
+
+void scheduler::get_stats(std::vector<worker_stats>& stats) {
+    stats.clear();
+}
+
+#endif
+
+game_error scheduler::parallel_for(size_t n, size_t grain, range_task f, task_priority priority) {
+    if (grain == 0)
+        grain = 1;
+    size_t num_chunks = (n + grain - 1) / grain;
+#ifdef POKER_THREADS
+    if (num_chunks > 1) {
+        // chunks are claimed by the caller and by up to num_threads helpers
+        struct job {
+            range_task f;
+            size_t n, grain, num_chunks;
+            std::atomic<size_t> next;
+            std::atomic<int> error;
+            std::mutex mutex;
+            std::condition_variable done_cv;
+            size_t done;
+
+            void chunk_done() {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (++done == num_chunks)
+                    done_cv.notify_all();
+            }
+
+            void run() {
+                size_t c;
+                while ((c = next++) < num_chunks) {
+                    // counted even if f throws, so the caller is not left waiting
+                    struct counter {
+                        job* j;
+                        ~counter() { j->chunk_done(); }
+                    } count{this};
+                    if (error)
+                        continue;
+                    game_error res = f(c * grain, std::min(n, (c + 1) * grain));
+                    if (res) {
+                        int none = SUCCESS;
+                        error.compare_exchange_strong(none, res);
+                    }
+                }
+            }
+        };
+        auto j = std::make_shared<job>();
+        j->f = f;
+        j->n = n;
+        j->grain = grain;
+        j->num_chunks = num_chunks;
+        j->next = 0;
+        j->error = SUCCESS;
+        j->done = 0;
+
+        size_t num_helpers = std::min<size_t>(_num_threads, num_chunks - 1);
+        for (size_t i = 0; i < num_helpers; i++)
+            submit([j]() { j->run(); }, priority);
+        j->run();
+
+        std::unique_lock<std::mutex> lock(j->mutex);
+        j->done_cv.wait(lock, [&j] { return j->done == j->num_chunks; });
+        return (game_error)j->error.load();
+    }
+#endif
+    game_error res;
+    for (size_t c = 0; c < num_chunks; c++)
+        if ((res = f(c * grain, std::min(n, (c + 1) * grain))))
+            return res;
+    return SUCCESS;
+}
+
+void scheduler::write_json(json_writer& w) {
+    std::vector<worker_stats> stats;
+    get_stats(stats);
+    w.begin_object();
+    w.key("workers").begin_array();
+    for (auto& s : stats) {
+        uint64_t total_us = s.busy_us + s.idle_us;
+        w.begin_object();
+        w.key("interactive_tasks").value((unsigned long long)s.tasks[PRIORITY_INTERACTIVE]);
+        w.key("background_tasks").value((unsigned long long)s.tasks[PRIORITY_BACKGROUND]);
+        w.key("stolen_tasks").value((unsigned long long)s.stolen);
+        w.key("busy_us").value((unsigned long long)s.busy_us);
+        w.key("idle_us").value((unsigned long long)s.idle_us);
+        w.key("utilization_pct").value(total_us ? (int)(s.busy_us * 100 / total_us) : 0);
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+}
+
+/*
+ * task_group
+*/
+
+struct task_group::state {
+    struct item {
+        std::atomic<bool> claimed;
+        scheduler::task t;
+        item(scheduler::task t) : claimed(false), t(t) {}
+    };
+
+    std::vector<std::shared_ptr<item>> items;
+    int running;
+#ifdef POKER_THREADS
+    std::mutex mutex;
+    std::condition_variable done_cv;
+#endif
+
+    state() : running(0) {}
+
+    void finish() {
+#ifdef POKER_THREADS
+        std::unique_lock<std::mutex> lock(mutex);
+        if (--running == 0)
+            done_cv.notify_all();
+#else
+        running--;
+#endif
+    }
+
+    // runs it unless another thread already did
+    void run(std::shared_ptr<item> it) {
+        bool claimed = false;
+        if (!it->claimed.compare_exchange_strong(claimed, true))
+            return;
+        struct finisher {
+            state* s;
+            ~finisher() { s->finish(); }
+        } f{this};
+        it->t();
+    }
+};
+
+task_group::task_group(scheduler& s, task_priority priority) : _scheduler(s), _priority(priority), _state(std::make_shared<state>()) {}
+
+task_group::~task_group() {
+    wait();
+}
+
+void task_group::run(scheduler::task t) {
+    auto it = std::make_shared<state::item>(t);
+    auto st = _state;
+    _state->items.push_back(it);
+    {
+#ifdef POKER_THREADS
+        std::unique_lock<std::mutex> lock(_state->mutex);
+#endif
+        _state->running++;
+    }
+    _scheduler.submit([st, it]() { st->run(it); }, _priority);
+}
+
+void task_group::wait() {
+    for (auto& it : _state->items)
+        _state->run(it);
+    _state->items.clear();
+#ifdef POKER_THREADS
+    std::unique_lock<std::mutex> lock(_state->mutex);
+    _state->done_cv.wait(lock, [this] { return _state->running == 0; });
+#endif
+}
+
+}  // namespace poker
@@ -0,0 +1,127 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#ifdef POKER_THREADS
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#endif
+
+#include "common.h"
+#include "json-writer.h"
+
+namespace poker {
+
+enum task_priority {
+    // latency critical work (verification of an incoming message)
+    PRIORITY_INTERACTIVE = 0,
+    // precomputation and bulk work
+    PRIORITY_BACKGROUND = 1,
+};
+
+const int NUM_PRIORITIES = 2;
+
+struct worker_stats {
+    uint64_t tasks[NUM_PRIORITIES];
+    // tasks taken from another worker's queue
+    uint64_t stolen;
+    uint64_t busy_us;
+    uint64_t idle_us;
+};
+
+/*
+ * Work-stealing task scheduler.
+ * Each worker has a queue per priority; it runs its own newest task
+ * first and, when out of work, steals the oldest task of another worker.
+ * Interactive tasks of any worker are taken before background ones, so
+ * background work split into small tasks (see parallel_for) gives way to
+ * interactive work between tasks.
+ * Tasks submitted with a key run one at a time, in submission order, like
+ * the calls on one player; tasks with different keys run concurrently.
+ * Threads are started on first use. Without thread support (POKER_THREADS
+ * undefined) tasks run inline on the submitting thread.
+*/
+class scheduler {
+   public:
+    typedef std::function<void()> task;
+    typedef std::function<game_error(size_t begin, size_t end)> range_task;
+
+    scheduler(int num_threads = 0);
+    virtual ~scheduler();
+
+    void submit(task t, task_priority priority = PRIORITY_BACKGROUND);
+    void submit(const void* key, task t, task_priority priority = PRIORITY_BACKGROUND);
+
+    // Runs f over chunks of at least grain elements of [0, n) and waits for
+    // all of them. The calling thread runs chunks too, so this may be called
+    // from a task. Returns the first error; chunks not yet started are skipped
+    game_error parallel_for(size_t n, size_t grain, range_task f, task_priority priority = PRIORITY_BACKGROUND);
+
+    int num_threads();
+    void get_stats(std::vector<worker_stats>& stats);
+    void write_json(json_writer& w);
+
+#ifdef POKER_THREADS
+   private:
+    struct worker {
+        std::mutex mutex;
+        std::deque<task> tasks[NUM_PRIORITIES];
+        std::atomic<uint64_t> num_tasks[NUM_PRIORITIES];
+        std::atomic<uint64_t> stolen;
+        std::atomic<uint64_t> busy_us;
+        std::atomic<uint64_t> idle_us;
+        worker();
+    };
+
+    int _num_threads;
+    bool _stopping;
+    std::mutex _mutex;
+    std::condition_variable _ready_cv;
+    std::atomic<int> _queued;
+    std::atomic<unsigned> _next_worker;
+    std::vector<std::unique_ptr<worker>> _workers;
+    std::vector<std::thread> _threads;
+    // tasks of the keys with a task queued or running, the running one first
+    std::mutex _lanes_mutex;
+    std::map<const void*, std::deque<task>> _lanes;
+
+    void start();
+    void run(int index);
+    void run_lane(const void* key, task_priority priority);
+    bool take(int index, task& t, int& priority);
+#endif
+};
+
+/*
+ * Fork/join over a scheduler: run() submits a task, wait() runs the tasks
+ * that have not started yet on the calling thread and waits for the rest.
+ * The destructor waits
+*/
+class task_group {
+    struct state;
+    scheduler& _scheduler;
+    task_priority _priority;
+    std::shared_ptr<state> _state;
+
+   public:
+    task_group(scheduler& s, task_priority priority = PRIORITY_BACKGROUND);
+    virtual ~task_group();
+
+    task_group(const task_group&) = delete;
+    task_group& operator=(const task_group&) = delete;
+
+    void run(scheduler::task t);
+    void wait();
+};
+
+}  // namespace poker
+
+#endif
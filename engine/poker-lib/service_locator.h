@@ -1,14 +1,21 @@
 #ifndef SERVICE_LOCATOR_H
 #define SERVICE_LOCATOR_H
 
+#include "ec_participant.h"
 #include "participant.h"
 #include "poker-lib.h"
 #include "unencrypted_participant.h"
+#ifndef POKER_VERIFY_ONLY
+#include "scheduler.h"
+#endif
 
 namespace poker {
 
 class service_locator {
     poker_lib_options _opts;
+#ifndef POKER_VERIFY_ONLY
+    scheduler _scheduler;
+#endif
     service_locator() {}
 
    public:
@@ -25,8 +32,35 @@ class service_locator {
     }
 
     i_participant* new_participant() {
+        return new_participant(_opts.backend);
+    }
+
+    i_participant* new_participant(participant_backend backend) {
+        return new_participant(backend, _opts.tmcg_min_profile);
+    }
+
+    // Verifies games of any known profile unless a floor is configured
+    i_participant* new_referee_participant(participant_backend backend) {
+        auto min_profile = _opts.referee_tmcg_min_profile;
+        return new_participant(backend, min_profile ? min_profile : weakest_tmcg_profile()->name);
+    }
+
+    const poker_lib_options& options() {
+        return _opts;
+    }
+
+#ifndef POKER_VERIFY_ONLY
+    scheduler& task_scheduler() {
+        return _scheduler;
+    }
+#endif
+
+   private:
+    i_participant* new_participant(participant_backend backend, const char* tmcg_min_profile) {
         if (_opts.encryption) {
-            return new participant();
+            if (backend == BACKEND_EC)
+                return new ec_participant(_opts.pipelined);
+            return new participant(_opts.pipelined, _opts.tmcg_profile, tmcg_min_profile);
         } else {
             return new unencrypted_participant(_opts.winner);
         }
@@ -1,17 +1,63 @@
+#include <algorithm>
 #include <iostream>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#ifdef POKER_EVAL
 #include <poker_defs.h>
 #include <inlines/eval.h>
 #include <inlines/eval_type.h>
-#include <cstdint>
+#endif
 
+#include "hand-eval.h"
+#include "service_locator.h"
 #include "solver.h"
 
 namespace poker {
 
-    solver::solver() {}
+    solver::solver(solver_backend backend) : _backend(backend) {}
 
     solver::~solver(){}
 
+    bool solver::has_backend(solver_backend backend) {
+#ifdef POKER_EVAL
+        return backend == SOLVER_NATIVE || backend == SOLVER_POKER_EVAL;
+#else
+        return backend == SOLVER_NATIVE;
+#endif
+    }
+
+    static int compare_values(uint32_t value1, uint32_t value2) {
+        if (value1 > value2) {
+            return 1;
+        } else if (value1 < value2) {
+            return 2;
+        } else {
+            return 0;
+        }
+    }
+
+    game_error native_compare_hands(const card_t *hand1, const card_t *hand2, int hand_size, int* result) {
+        game_error res;
+
+        if ((res = check_hand(hand1, hand_size)))
+            return res;
+
+        if ((res = check_hand(hand2, hand_size)))
+            return res;
+
+        *result = compare_values(hand_value(hand1, hand_size), hand_value(hand2, hand_size));
+        return SUCCESS;
+    }
+
+    const char* native_get_hand_name(const card_t *hand, int hand_size) {
+        if (check_hand(hand, hand_size) != SUCCESS)
+            return 0;
+        return hand_category_names[hand_value_category(hand_value(hand, hand_size), hand_size)];
+    }
+
+#ifdef POKER_EVAL
+
     game_error convert_hand_to_mask(const card_t *hand, int hand_size, CardMask& mask) {
         CardMask_RESET(mask);
 
@@ -36,17 +82,10 @@ namespace poker {
     int eval(const CardMask& hand1, const CardMask& hand2, int hand_size) {
         int value1 = StdDeck_StdRules_EVAL_N(hand1, hand_size);
         int value2 = StdDeck_StdRules_EVAL_N(hand2, hand_size);
-
-        if (value1 > value2) {
-            return 1;
-        } else if (value1 < value2) {
-            return 2;
-        } else {
-            return 0;
-        }
+        return compare_values(value1, value2);
     }
 
-    game_error solver::compare_hands(const card_t *hand1, const card_t *hand2, int hand_size, int* result) {
+    game_error poker_eval_compare_hands(const card_t *hand1, const card_t *hand2, int hand_size, int* result) {
         CardMask hand1_mask, hand2_mask;
         game_error res;
 
@@ -60,7 +99,7 @@ namespace poker {
         return SUCCESS;
     }
 
-    const char* solver::get_hand_name(const card_t *hand, int hand_size) {
+    const char* poker_eval_get_hand_name(const card_t *hand, int hand_size) {
         CardMask mask;
 
         if (convert_hand_to_mask(hand, hand_size, mask) == SUCCESS) {
@@ -70,4 +109,69 @@ namespace poker {
             return 0;
         }
     }
+#endif // POKER_EVAL
+
+    // Runs f over chunks of [0, n) on the engine scheduler, at background
+    // priority so that message verification goes first. The verify-only
+    // library has no scheduler
+    static game_error for_each_chunk(size_t n, std::function<game_error(size_t begin, size_t end)> f) {
+#ifdef POKER_VERIFY_ONLY
+        return f(0, n);
+#else
+        const size_t chunk_size = 1 << 16;
+        return service_locator::instance().task_scheduler().parallel_for(n, chunk_size, f, PRIORITY_BACKGROUND);
+#endif
+    }
+
+    static game_error check_hands(const card_t *hands, size_t begin, size_t end) {
+        game_error res;
+        for (auto i = begin; i < end; i++)
+            if ((res = check_hand(hands + i * HAND_SIZE, HAND_SIZE)))
+                return res;
+        return SUCCESS;
+    }
+
+    game_error solver::rank_hands(const card_t *hands, size_t n, uint32_t* ranks) {
+        return for_each_chunk(n, [&](size_t begin, size_t end) -> game_error {
+            game_error res;
+            if ((res = check_hands(hands, begin, end)))
+                return res;
+            rank_hands_unchecked(hands + begin * HAND_SIZE, end - begin, ranks + begin);
+            return SUCCESS;
+        });
+    }
+
+    game_error solver::compare_batch(const card_t *hands1, const card_t *hands2, size_t n, int* results) {
+        return for_each_chunk(n, [&](size_t begin, size_t end) -> game_error {
+            game_error res;
+            if ((res = check_hands(hands1, begin, end)) || (res = check_hands(hands2, begin, end)))
+                return res;
+            const size_t block_size = 1024;
+            uint32_t ranks1[block_size], ranks2[block_size];
+            for (auto b = begin; b < end; b += block_size) {
+                auto count = std::min(block_size, end - b);
+                rank_hands_unchecked(hands1 + b * HAND_SIZE, count, ranks1);
+                rank_hands_unchecked(hands2 + b * HAND_SIZE, count, ranks2);
+                for (size_t i = 0; i < count; i++)
+                    results[b + i] = compare_values(ranks1[i], ranks2[i]);
+            }
+            return SUCCESS;
+        });
+    }
+
+    game_error solver::compare_hands(const card_t *hand1, const card_t *hand2, int hand_size, int* result) {
+#ifdef POKER_EVAL
+        if (_backend == SOLVER_POKER_EVAL)
+            return poker_eval_compare_hands(hand1, hand2, hand_size, result);
+#endif
+        return native_compare_hands(hand1, hand2, hand_size, result);
+    }
+
+    const char* solver::get_hand_name(const card_t *hand, int hand_size) {
+#ifdef POKER_EVAL
+        if (_backend == SOLVER_POKER_EVAL)
+            return poker_eval_get_hand_name(hand, hand_size);
+#endif
+        return native_get_hand_name(hand, hand_size);
+    }
 } // namespace poker
@@ -1,20 +1,35 @@
 #ifndef SOLVER_H
 #define SOLVER_H
 
+#include <cstddef>
 #include <cstdint>
 #include "common.h"
 
 namespace poker {
 
+enum solver_backend {
+    SOLVER_NATIVE,      // lookup tables, see hand-eval.h
+    SOLVER_POKER_EVAL,  // libpoker-eval; falls back to native when built without POKER_EVAL
+};
+
 /*
 * Poker hand evaluator
 */
 class solver {
+    solver_backend _backend;
 public:
-    solver();
+    solver(solver_backend backend = SOLVER_NATIVE);
     ~solver();
+    static bool has_backend(solver_backend backend);
     game_error compare_hands(const card_t *hand1, const card_t *hand2, int hand_size, int* result);
 	const char* get_hand_name(const card_t *hand, int hand_size);
+
+    // Batch evaluation of HAND_SIZE card hands stored one after another,
+    // always native and spread over all cores for large n.
+    // ranks range from 1 to NUM_HAND_RANKS (see hand-eval.h);
+    // results are those of compare_hands
+    game_error rank_hands(const card_t *hands, size_t n, uint32_t* ranks);
+    game_error compare_batch(const card_t *hands1, const card_t *hands2, size_t n, int* results);
 };
 
 } // namespace poker
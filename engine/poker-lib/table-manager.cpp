@@ -0,0 +1,234 @@
+#include "table-manager.h"
+
+#ifdef POKER_THREADS
+#include <chrono>
+#include <thread>
+#endif
+
+#include "blob.h"
+
+namespace poker {
+
+// calls run per turn before a table yields its worker to other tables
+const int table_batch_size = 16;
+
+struct table_manager::table {
+    struct job {
+        uint64_t request;
+        table_work work;
+    };
+
+    table_id id;
+    std::unique_ptr<player> p;
+    mpsc_queue<job> jobs;
+    // queued and running jobs. The producer that raises it from 0 schedules the drain
+    std::atomic<int> pending;
+
+    table(table_id id, player* p) : id(id), p(p), pending(0) {}
+};
+
+table_manager::table_manager(scheduler& s)
+    : _scheduler(s), _next_table(1), _next_request(1), _waiters(0), _outstanding(0) {
+}
+
+table_manager::~table_manager() {
+#ifdef POKER_THREADS
+    std::unique_lock<std::mutex> lock(_idle_mutex);
+    _idle_cv.wait(lock, [this] { return _outstanding.load() == 0; });
+#endif
+    table_completion* c;
+    while (_completions.pop(c))
+        delete c;
+}
+
+table_manager::table_ptr table_manager::find(table_id id) {
+#ifdef POKER_THREADS
+    std::unique_lock<std::mutex> lock(_tables_mutex);
+#endif
+    auto it = _tables.find(id);
+    if (it == _tables.end())
+        return table_ptr();
+    return it->second;
+}
+
+table_id table_manager::add(player* p) {
+    auto id = _next_table++;
+    auto t = std::make_shared<table>(id, p);
+#ifdef POKER_THREADS
+    std::unique_lock<std::mutex> lock(_tables_mutex);
+#endif
+    _tables[id] = t;
+    return id;
+}
+
+game_error table_manager::create_table(int player_id, money_t alice_money, money_t bob_money, money_t big_blind, table_id& id) {
+    game_error res;
+    std::unique_ptr<player> p(new player(player_id));
+    if ((res = p->init(alice_money, bob_money, big_blind)))
+        return res;
+    id = add(p.release());
+    return SUCCESS;
+}
+
+game_error table_manager::restore_table(const char* state, size_t len, table_id& id) {
+    game_error res;
+    std::unique_ptr<player> p(new player(ALICE));
+    memory_istream is(state, len);
+    if ((res = p->restore(is)))
+        return res;
+    id = add(p.release());
+    return SUCCESS;
+}
+
+game_error table_manager::close_table(table_id id) {
+#ifdef POKER_THREADS
+    std::unique_lock<std::mutex> lock(_tables_mutex);
+#endif
+    if (!_tables.erase(id))
+        return TBL_UNKNOWN_TABLE;
+    return SUCCESS;
+}
+
+int table_manager::num_tables() {
+#ifdef POKER_THREADS
+    std::unique_lock<std::mutex> lock(_tables_mutex);
+#endif
+    return (int)_tables.size();
+}
+
+game_error table_manager::submit(table_id id, uint64_t& request, table_work work) {
+    auto t = find(id);
+    if (!t)
+        return TBL_UNKNOWN_TABLE;
+    request = _next_request++;
+    _outstanding++;
+    t->jobs.push(table::job{request, work});
+    if (t->pending.fetch_add(1) == 0)
+        schedule(t);
+    return SUCCESS;
+}
+
+void table_manager::schedule(const table_ptr& t) {
+    _scheduler.submit([this, t]() { drain(t); }, PRIORITY_INTERACTIVE);
+}
+
+void table_manager::drain(const table_ptr& t) {
+    for (int i = 0; i < table_batch_size; i++) {
+        table::job j;
+        // pending > 0, so a job is queued or its push is being linked
+        while (!t->jobs.pop(j)) {
+#ifdef POKER_THREADS
+            std::this_thread::yield();
+#endif
+        }
+
+        auto c = new table_completion();
+        c->table = t->id;
+        c->request = j.request;
+        c->bet = BET_NONE;
+        // a failed call is completed too, or the table would never run again
+        try {
+            j.work(*t->p, *c);
+        } catch (std::exception& e) {
+            logger_at(LOG_ERROR) << "*** table_manager: call failed: " << e.what() << std::endl;
+            c->status = TBL_CALL_FAILED;
+        } catch (...) {
+            logger_at(LOG_ERROR) << "*** table_manager: call failed" << std::endl;
+            c->status = TBL_CALL_FAILED;
+        }
+        c->step = t->p->step();
+        complete(c);
+
+        bool last = t->pending.fetch_sub(1) == 1;
+        // the manager may be deleted once the last call has finished
+        finish_call();
+        if (last)
+            return;
+    }
+    // more work queued: let other tables run first
+    schedule(t);
+}
+
+void table_manager::finish_call() {
+    if (--_outstanding == 0) {
+#ifdef POKER_THREADS
+        std::unique_lock<std::mutex> lock(_idle_mutex);
+        _idle_cv.notify_all();
+#endif
+    }
+}
+
+void table_manager::complete(table_completion* c) {
+    _completions.push(c);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+#ifdef POKER_THREADS
+    if (_waiters.load(std::memory_order_relaxed)) {
+        { std::unique_lock<std::mutex> lock(_wait_mutex); }
+        _wait_cv.notify_all();
+    }
+#endif
+}
+
+game_error table_manager::create_handshake(table_id id, uint64_t& request) {
+    return submit(id, request, [](player& p, table_completion& c) {
+        c.status = p.create_handshake(c.msg_out);
+    });
+}
+
+game_error table_manager::create_bet(table_id id, bet_type type, money_t amt, uint64_t& request) {
+    return submit(id, request, [type, amt](player& p, table_completion& c) {
+        c.status = p.create_bet(type, amt, c.msg_out);
+    });
+}
+
+game_error table_manager::post_message(table_id id, const char* msg, size_t len, uint64_t& request) {
+    std::string mi(msg, len);
+    return submit(id, request, [mi](player& p, table_completion& c) mutable {
+        if (p.step() < PREFLOP_BET)
+            c.status = p.process_handshake(mi, c.msg_out);
+        else
+            c.status = p.process_bet(mi, c.msg_out, &c.bet, &c.amount);
+    });
+}
+
+int table_manager::poll(std::vector<table_completion>& out, int max) {
+#ifdef POKER_THREADS
+    std::unique_lock<std::mutex> lock(_wait_mutex);
+#endif
+    int n = 0;
+    table_completion* c;
+    while (n < max && _completions.pop(c)) {
+        out.push_back(std::move(*c));
+        delete c;
+        n++;
+    }
+    return n;
+}
+
+int table_manager::wait(std::vector<table_completion>& out, int max, int timeout_ms) {
+#ifdef POKER_THREADS
+    int n = 0;
+    std::unique_lock<std::mutex> lock(_wait_mutex);
+    _waiters++;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto ready = [this, &out, &n, max] {
+        table_completion* c;
+        while (n < max && _completions.pop(c)) {
+            out.push_back(std::move(*c));
+            delete c;
+            n++;
+        }
+        return n > 0 || max <= 0;
+    };
+    if (timeout_ms < 0)
+        _wait_cv.wait(lock, ready);
+    else
+        _wait_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+    _waiters--;
+    return n;
+#else
+    return poll(out, max);
+#endif
+}
+
+}  // namespace poker
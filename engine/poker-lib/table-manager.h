@@ -0,0 +1,110 @@
+#ifndef TABLE_MANAGER_H
+#define TABLE_MANAGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef POKER_THREADS
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#include "common.h"
+#include "mpsc-queue.h"
+#include "player.h"
+#include "scheduler.h"
+
+namespace poker {
+
+typedef uint64_t table_id;
+
+/*
+ * Outcome of one table call, delivered through the completion stream
+*/
+struct table_completion {
+    table_id table;
+    uint64_t request;
+    game_error status;
+    // the player's step after the call
+    game_step step;
+    // to be sent to the opponent's table, empty if none
+    std::string msg_out;
+    // opponent's bet, for messages processed as bets
+    bet_type bet;
+    money_t amount;
+};
+
+/*
+ * Owns the players of many tables, addressed by 64-bit handles that are
+ * never reused.
+ * Calls queue work for a table and return at once. Each table runs its
+ * work in order, one call at a time, as interactive tasks of the
+ * scheduler; tables run concurrently. Work is handed over through lock-free queues and the
+ * results come back through a single completion stream (poll/wait).
+ * A closed table is released once its queued work has run; the manager
+ * waits for all queued work when deleted.
+*/
+class table_manager {
+    struct table;
+    typedef std::function<void(player& p, table_completion& c)> table_work;
+    typedef std::shared_ptr<table> table_ptr;
+
+    scheduler& _scheduler;
+    std::atomic<table_id> _next_table;
+    std::atomic<uint64_t> _next_request;
+
+#ifdef POKER_THREADS
+    std::mutex _tables_mutex;
+    std::mutex _wait_mutex;
+    std::condition_variable _wait_cv;
+    // signaled when _outstanding drops to 0
+    std::mutex _idle_mutex;
+    std::condition_variable _idle_cv;
+#endif
+    std::unordered_map<table_id, table_ptr> _tables;
+
+    mpsc_queue<table_completion*> _completions;
+    std::atomic<int> _waiters;
+    // queued or running calls, over all tables
+    std::atomic<int> _outstanding;
+
+    table_ptr find(table_id id);
+    table_id add(player* p);
+    game_error submit(table_id id, uint64_t& request, table_work work);
+    void schedule(const table_ptr& t);
+    void drain(const table_ptr& t);
+    void complete(table_completion* c);
+    void finish_call();
+
+   public:
+    explicit table_manager(scheduler& s);
+    virtual ~table_manager();
+
+    // New initialized player of the given id (ALICE or BOB) at a new table
+    game_error create_table(int player_id, money_t alice_money, money_t bob_money, money_t big_blind, table_id& id);
+    // New table with a player restored from player::save
+    game_error restore_table(const char* state, size_t len, table_id& id);
+    game_error close_table(table_id id);
+    int num_tables();
+
+    // Fail with TBL_UNKNOWN_TABLE if the table does not exist or is closed
+    game_error create_handshake(table_id id, uint64_t& request);
+    game_error create_bet(table_id id, bet_type type, money_t amt, uint64_t& request);
+    // Inbound message from the opponent, processed as a handshake or a bet
+    // message depending on the player's step
+    game_error post_message(table_id id, const char* msg, size_t len, uint64_t& request);
+
+    // Appends up to max completions to out. wait blocks up to timeout_ms
+    // (negative waits forever) for at least one
+    int poll(std::vector<table_completion>& out, int max);
+    int wait(std::vector<table_completion>& out, int max, int timeout_ms);
+};
+
+}  // namespace poker
+
+#endif
@@ -59,9 +59,21 @@ void the_happy_path() {
 
 }
 
+void bounds() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - bounds" << std::endl;
+    std::string s;
+    std::istringstream is("$2000000000|foo");
+    poker::decoder d(is);
+    assert_eql(COD_ERROR, d.read(s));
+    std::istringstream is2("$-1|foo");
+    poker::decoder d2(is2);
+    assert_eql(COD_ERROR, d2.read(s));
+}
+
 int main(int argc, char** argv) {
     init_poker_lib();
     the_happy_path();
+    bounds();
     std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
     return 0;
 }
@@ -55,9 +55,36 @@ void test_the_naive_happy_path() {
     std::cout <<  "---- " TEST_SUITE_NAME << " - the_happy_path" << std::endl;
 }
 
+void test_buffer_views() {
+    std::string data = std::string(5000, 'x') + "tail";
+    std::string wrapped;
+    assert_eql(SUCCESS, compress_and_wrap(data, wrapped));
+
+    // the payload is located in place
+    const char* payload;
+    size_t payload_len;
+    assert_eql(SUCCESS, unwrap(wrapped.data(), wrapped.size(), &payload, &payload_len));
+    assert_eql(true, payload > wrapped.data() && payload + payload_len <= wrapped.data() + wrapped.size());
+
+    // output strings are overwritten, not appended to
+    std::string out = "stale contents";
+    assert_eql(SUCCESS, unwrap_and_decompress(wrapped.data(), wrapped.size(), out));
+    assert_eql(data, out);
+    assert_eql(SUCCESS, decompress(payload, payload_len, out));
+    assert_eql(data, out);
+    std::string empty;
+    assert_eql(SUCCESS, compress_and_wrap("", empty));
+    assert_eql(SUCCESS, unwrap_and_decompress(empty.data(), empty.size(), out));
+    assert_eql(0, out.size());
+
+    auto truncated_len = (payload - wrapped.data()) + payload_len - 1;
+    assert_eql(CPR_INSUFFICIENT_DATA, unwrap_and_decompress(wrapped.data(), truncated_len, out));
+}
+
 int main(int argc, char** argv) {
     init_poker_lib();
     test_the_naive_happy_path();
+    test_buffer_views();
     std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
     return 0;
 }
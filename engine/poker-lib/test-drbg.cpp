@@ -0,0 +1,116 @@
+#include <iostream>
+#include <cstring>
+#include <string>
+#include "test-util.h"
+#include "poker-lib.h"
+#include "drbg.h"
+
+#define TEST_SUITE_NAME "Test DRBG"
+
+using namespace poker;
+
+static std::string hex(const unsigned char* data, size_t len) {
+    static const char digits[] = "0123456789abcdef";
+    std::string s;
+    for (size_t i = 0; i < len; i++) {
+        s += digits[data[i] >> 4];
+        s += digits[data[i] & 15];
+    }
+    return s;
+}
+
+// RFC 8439, 2.3.2
+void test_chacha20_block() {
+    uint32_t key[8];
+    for (int i = 0; i < 8; i++)
+        key[i] = (4 * i) | ((4 * i + 1) << 8) | ((4 * i + 2) << 16) | ((uint32_t)(4 * i + 3) << 24);
+    uint32_t nonce[3] = {0x09000000, 0x4a000000, 0};
+    unsigned char out[64];
+    chacha20_block(key, 1, nonce, out);
+    assert_eql(std::string("10f1e7e4d13b5915500fdd1fa32071c4c7d1f4c733c068030422aa9ac3d46c4e"
+                           "d2826446079faa0914c2d705d98b02a2b5129cd1de164eb9cbd083e8a2503c4e"),
+               hex(out, sizeof(out)));
+}
+
+void test_drbg() {
+    unsigned char seed[DRBG_SEED_SIZE];
+    for (int i = 0; i < DRBG_SEED_SIZE; i++)
+        seed[i] = (unsigned char)i;
+
+    // the stream does not depend on how it is requested
+    chacha20_drbg d1, d2;
+    d1.seed(seed);
+    d2.seed(seed);
+    unsigned char one[200], many[200];
+    d1.generate(one, sizeof(one), RANDOM_STRONG);
+    size_t sizes[] = {1, 63, 64, 7, 65};
+    size_t pos = 0;
+    for (auto n : sizes) {
+        d2.generate(many + pos, n, RANDOM_VERY_STRONG);
+        pos += n;
+    }
+    assert_eql(sizeof(many), pos);
+    assert_eql(hex(one, sizeof(one)), hex(many, sizeof(many)));
+    assert_eql(200, (int)d1.position());
+
+    // a restored generator continues the stream
+    unsigned char next[50], restored[50];
+    d1.generate(next, sizeof(next), RANDOM_STRONG);
+    chacha20_drbg d3;
+    d3.seed(seed);
+    d3.seek(200);
+    d3.generate(restored, sizeof(restored), RANDOM_STRONG);
+    assert_eql(hex(next, sizeof(next)), hex(restored, sizeof(restored)));
+
+    // another seed, another stream
+    seed[0] ^= 1;
+    d3.seed(seed);
+    d3.generate(many, sizeof(many), RANDOM_STRONG);
+    assert_neq(hex(one, sizeof(one)), hex(many, sizeof(many)));
+}
+
+void test_buffered_csprng() {
+    int calls = 0;
+    unsigned char value = 0;
+    buffered_csprng r([&](unsigned char* buf, size_t len, int level) {
+        calls++;
+        memset(buf, ++value, len);
+    }, 64);
+
+    unsigned char out[48];
+    r.generate(out, 16, RANDOM_STRONG);
+    r.generate(out + 16, 32, RANDOM_WEAK);
+    assert_eql(1, calls);
+    assert_eql(1, (int)out[47]);
+
+    // refilled when used up
+    r.generate(out, 32, RANDOM_STRONG);
+    assert_eql(2, calls);
+    assert_eql(1, (int)out[15]);
+    assert_eql(2, (int)out[16]);
+
+    // very strong and large requests go straight to the source
+    r.generate(out, 8, RANDOM_VERY_STRONG);
+    assert_eql(3, calls);
+    assert_eql(3, (int)out[0]);
+    unsigned char large[100];
+    r.generate(large, sizeof(large), RANDOM_STRONG);
+    assert_eql(4, calls);
+}
+
+// SHA-256 of the previous chain followed by the message
+void test_hash_chain() {
+    unsigned char chain[DRBG_SEED_SIZE] = {0};
+    hash_chain(chain, "abc", 3);
+    assert_eql(std::string("365aa7d8f7f9402c4b9434502b4cc89ddb09fe50d7cd95b493b834c62d5a5370"), hex(chain, sizeof(chain)));
+}
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    test_chacha20_block();
+    test_drbg();
+    test_buffered_csprng();
+    test_hash_chain();
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
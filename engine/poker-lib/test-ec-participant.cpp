@@ -0,0 +1,225 @@
+#include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include "test-util.h"
+#include "poker-lib.h"
+#include "ec_participant.h"
+#include "messages.h"
+#include "player.h"
+
+#define TEST_SUITE_NAME "Test EC participant"
+
+using namespace poker;
+
+struct table {
+    ec_participant alice, bob, eve;
+
+    table(bool pipelined = false) : alice(pipelined), bob(pipelined), eve(pipelined) {
+        alice.init(ALICE, 3, false);
+        bob.init(BOB, 3, false);
+        eve.init(2, 3, true);
+    }
+
+    void keys() {
+        blob group, alice_key, bob_key, eve_key;
+        assert_eql(SUCCESS, alice.create_group(group));
+        assert_eql(SUCCESS, bob.load_group(group));
+        assert_eql(SUCCESS, eve.load_group(group));
+        assert_eql(SUCCESS, alice.generate_key(alice_key));
+        assert_eql(SUCCESS, bob.generate_key(bob_key));
+        assert_eql(SUCCESS, eve.generate_key(eve_key));
+        for (auto p : {&alice, &bob, &eve}) {
+            for (auto key : {&alice_key, &bob_key, &eve_key})
+                if (!(p == &alice && key == &alice_key) && !(p == &bob && key == &bob_key) && !(p == &eve && key == &eve_key))
+                    assert_eql(SUCCESS, p->load_their_key(*key));
+            assert_eql(SUCCESS, p->finalize_key_generation());
+        }
+        blob vsshe;
+        assert_eql(SUCCESS, alice.create_vsshe_group(vsshe));
+        assert_eql(SUCCESS, bob.load_vsshe_group(vsshe));
+        assert_eql(SUCCESS, eve.load_vsshe_group(vsshe));
+    }
+
+    // alice mixes, bob mixes on top, eve makes the final mix
+    void shuffle() {
+        blob alice_stack, alice_proof, bob_stack, bob_proof, eve_stack, eve_proof;
+        for (auto p : {&alice, &bob, &eve})
+            assert_eql(SUCCESS, p->create_stack());
+        assert_eql(SUCCESS, alice.shuffle_stack(alice_stack, alice_proof));
+        assert_eql(SUCCESS, eve.load_stack(alice_stack, alice_proof));
+        assert_eql(SUCCESS, bob.load_and_shuffle_stack(alice_stack, alice_proof, bob_stack, bob_proof));
+        assert_eql(SUCCESS, alice.load_stack(bob_stack, bob_proof));
+        assert_eql(SUCCESS, eve.load_and_shuffle_stack(bob_stack, bob_proof, eve_stack, eve_proof));
+        assert_eql(SUCCESS, alice.load_stack(eve_stack, eve_proof));
+        assert_eql(SUCCESS, bob.load_stack(eve_stack, eve_proof));
+        for (auto p : {&alice, &bob, &eve})
+            assert_eql(SUCCESS, p->take_cards_from_stack(NUM_CARDS));
+    }
+
+    // opened by eve with the proofs of alice and bob
+    size_t open(int card_index) {
+        blob alice_proof, bob_proof;
+        assert_eql(SUCCESS, alice.prove_card_secret(card_index, alice_proof));
+        assert_eql(SUCCESS, bob.prove_card_secret(card_index, bob_proof));
+        assert_eql(SUCCESS, eve.self_card_secret(card_index));
+        assert_eql(SUCCESS, eve.verify_card_secret(card_index, alice_proof));
+        assert_eql(SUCCESS, eve.verify_card_secret(card_index, bob_proof));
+        assert_eql(SUCCESS, eve.open_card(card_index));
+        return eve.get_open_card(card_index);
+    }
+};
+
+void test_protocol(bool pipelined) {
+    table t(pipelined);
+    t.keys();
+    t.shuffle();
+    std::set<size_t> types;
+    for (int i = 0; i < NUM_CARDS; i++) {
+        auto type = t.open(i);
+        assert_eql(true, type < DECK_SIZE);
+        types.insert(type);
+    }
+    assert_eql(NUM_CARDS, (int)types.size());
+
+    // a private card is opened by its owner
+    blob eve_proof, bob_proof;
+    assert_eql(SUCCESS, t.eve.prove_card_secret(0, eve_proof));
+    assert_eql(SUCCESS, t.bob.prove_card_secret(0, bob_proof));
+    assert_eql(SUCCESS, t.alice.self_card_secret(0));
+    assert_eql(SUCCESS, t.alice.verify_card_secret(0, eve_proof));
+    assert_eql(SUCCESS, t.alice.verify_card_secret(0, bob_proof));
+    assert_eql(SUCCESS, t.alice.open_card(0));
+    assert_eql(t.eve.get_open_card(0), t.alice.get_open_card(0));
+}
+
+void test_tampered_proofs() {
+    table t;
+    t.keys();
+    for (auto p : {&t.alice, &t.bob, &t.eve})
+        assert_eql(SUCCESS, p->create_stack());
+    blob stack, proof;
+    assert_eql(SUCCESS, t.alice.shuffle_stack(stack, proof));
+
+    // the cards of the stack swapped: a stack no longer matching the proof
+    auto s = stack.str();
+    auto pos = s.find('|') + 1;
+    std::string swapped = s.substr(0, pos) + s.substr(pos + 64, 64) + s.substr(pos, 64) + s.substr(pos + 128);
+    blob bad_stack;
+    bad_stack.set_data(swapped);
+    assert_eql(TMC_VERIFYSTACKEQUALITY, t.bob.load_stack(bad_stack, proof));
+    assert_eql(SUCCESS, t.bob.load_stack(stack, proof));
+
+    // a key with a wrong proof
+    table u;
+    blob group, key;
+    assert_eql(SUCCESS, u.alice.create_group(group));
+    assert_eql(SUCCESS, u.bob.load_group(group));
+    assert_eql(SUCCESS, u.alice.generate_key(key));
+    auto k = key.str();
+    k[k.size() - 1] ^= 1;
+    blob bad_key;
+    bad_key.set_data(k);
+    assert_eql(TMC_KEYGENERATIONPROTOCOL_UPDATEKEY, u.bob.load_their_key(bad_key));
+    assert_eql(SUCCESS, u.bob.load_their_key(key));
+    assert_eql(TMC_KEYGENERATIONPROTOCOL_UPDATEKEY, u.bob.load_their_key(key));
+
+    // a decryption share of another card
+    table v;
+    v.keys();
+    v.shuffle();
+    blob card_proof;
+    assert_eql(SUCCESS, v.alice.prove_card_secret(1, card_proof));
+    assert_eql(TMC_VERIFYCARDSECRET, v.eve.verify_card_secret(2, card_proof));
+}
+
+void test_save_restore() {
+    table t;
+    t.keys();
+    t.shuffle();
+    auto first = t.open(4);
+
+    std::stringstream saved;
+    assert_eql(SUCCESS, t.eve.save(saved));
+    ec_participant eve;
+    eve.init(2, 3, true);
+    assert_eql(SUCCESS, eve.restore(saved));
+    assert_eql(first, eve.get_open_card(4));
+
+    blob alice_proof, bob_proof;
+    assert_eql(SUCCESS, t.alice.prove_card_secret(5, alice_proof));
+    assert_eql(SUCCESS, t.bob.prove_card_secret(5, bob_proof));
+    assert_eql(SUCCESS, eve.self_card_secret(5));
+    assert_eql(SUCCESS, eve.verify_card_secret(5, alice_proof));
+    assert_eql(SUCCESS, eve.verify_card_secret(5, bob_proof));
+    assert_eql(SUCCESS, eve.open_card(5));
+    assert_eql(t.open(5), eve.get_open_card(5));
+
+    // a stack of more cards than the deck
+    table u;
+    u.keys();
+    assert_eql(SUCCESS, u.eve.create_stack());
+    std::stringstream full;
+    assert_eql(SUCCESS, u.eve.save(full));
+    auto s = full.str();
+    auto pos = s.find("$3328|");
+    assert_neq(std::string::npos, pos);
+    s.replace(pos, 6, "$3392|");
+    s.insert(pos + 6 + 3328, s.substr(pos + 6, 64));
+    std::istringstream oversized(s);
+    ec_participant dave;
+    dave.init(2, 3, true);
+    assert_eql(TMCG_READ_STACK, dave.restore(oversized));
+}
+
+// messages of the two backends are not mixed
+void test_message_version() {
+    msg_vtmf m;
+    std::stringstream os;
+    assert_eql(poker_ec_version, message_version());
+    assert_eql(SUCCESS, m.write(os));
+
+    // decoded by anyone, for a referee replaying the game
+    poker_lib_options opts;
+    opts.backend = BACKEND_DLOG;
+    init_poker_lib(&opts);
+    message* decoded = NULL;
+    assert_eql(SUCCESS, message::decode(os, &decoded));
+    assert_eql(poker_ec_version, decoded->version());
+    delete decoded;
+    participant_backend backend;
+    assert_eql(SUCCESS, backend_of_version(poker_ec_version, backend));
+    assert_eql(BACKEND_EC, backend);
+    assert_eql(COD_VERSION_MISMATCH, backend_of_version(poker_ec_version + 1, backend));
+
+    // but refused by a player of the other backend
+    opts.backend = BACKEND_EC;
+    init_poker_lib(&opts);
+    player alice(ALICE);
+    std::string handshake, response;
+    assert_eql(SUCCESS, alice.init(100, 100, 10));
+    assert_eql(SUCCESS, alice.create_handshake(handshake));
+    opts.backend = BACKEND_DLOG;
+    init_poker_lib(&opts);
+    player bob(BOB);
+    assert_eql(SUCCESS, bob.init(100, 100, 10));
+    assert_eql(COD_VERSION_MISMATCH, bob.process_handshake(handshake, response));
+
+    // nor restored by one
+    std::stringstream saved;
+    assert_eql(SUCCESS, alice.save(saved));
+    assert_eql(PRR_SAVE_BACKEND_MISMATCH, player(ALICE).restore(saved));
+}
+
+int main(int argc, char** argv) {
+    poker_lib_options opts;
+    opts.backend = BACKEND_EC;
+    init_poker_lib(&opts);
+    test_protocol(false);
+    test_protocol(true);
+    test_tampered_proofs();
+    test_save_restore();
+    test_message_version();
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <cmath>
+#include "test-util.h"
+#include "poker-lib.h"
+#include "equity.h"
+
+#define TEST_SUITE_NAME "Test equity"
+
+using namespace poker;
+using namespace poker::cards;
+
+static const card_t aces_vs_kings[NUM_PLAYERS][NUM_PRIVATE_CARDS] = {{hA, dA}, {cK, sK}};
+
+void river() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - river" << std::endl;
+    card_t board[] = {h2, d7, c9, sJ, h4};
+    equity_options opts;
+    equity_result r;
+    assert_eql(SUCCESS, compute_equity(aces_vs_kings, board, 5, opts, r));
+    assert_eql(1, (int)r.runouts);
+    assert_eql(1, (int)r.wins[ALICE]);
+    assert_eql(1.0, r.equity[ALICE]);
+}
+
+void turn() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - turn" << std::endl;
+    // kings need one of two kings
+    card_t board[] = {h2, d7, c9, sJ};
+    equity_options opts;
+    equity_result r;
+    assert_eql(SUCCESS, compute_equity(aces_vs_kings, board, 4, opts, r));
+    assert_eql(44, (int)r.runouts);
+    assert_eql(2, (int)r.wins[BOB]);
+    assert_eql(0, (int)r.ties);
+}
+
+void preflop() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - preflop" << std::endl;
+    equity_options opts;
+    equity_result exact, sampled;
+    assert_eql(SUCCESS, compute_equity(aces_vs_kings, NULL, 0, opts, exact));
+    assert_eql(1712304, (int)exact.runouts);
+    assert_eql(0.0, exact.error);
+    assert_eql(true, exact.equity[ALICE] > 0.81 && exact.equity[ALICE] < 0.83);
+    assert_eql(true, std::fabs(exact.equity[ALICE] + exact.equity[BOB] - 1) < 1e-9);
+
+    // sampling stops once within +-1%
+    opts.samples = 1000000;
+    opts.confidence = 0.01;
+    opts.seed = 7;
+    assert_eql(SUCCESS, compute_equity(aces_vs_kings, NULL, 0, opts, sampled));
+    assert_eql(true, sampled.runouts < opts.samples);
+    assert_eql(true, sampled.error <= 0.01);
+    assert_eql(true, std::fabs(sampled.equity[ALICE] - exact.equity[ALICE]) < 0.02);
+}
+
+void from_game_state() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - from_game_state" << std::endl;
+    game_state g;
+    g.players[ALICE].cards[0] = hA;
+    g.players[ALICE].cards[1] = dA;
+    g.players[BOB].cards[0] = cK;
+    g.players[BOB].cards[1] = sK;
+    g.public_cards[0] = h2;
+    g.public_cards[1] = d7;
+    g.public_cards[2] = c9;
+    g.public_cards[3] = sJ;
+    equity_options opts;
+    equity_result r;
+    assert_eql(SUCCESS, compute_equity(g, opts, r));
+    assert_eql(44, (int)r.runouts);
+
+    g.players[BOB].cards[1] = hA;
+    assert_eql(SRR_DUPLICATE_CARD, compute_equity(g, opts, r));
+}
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    river();
+    turn();
+    preflop();
+    from_game_state();
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <sstream>
+#include "test-util.h"
+#include "poker-lib.h"
+#include "game-events.h"
+
+#define TEST_SUITE_NAME "Test game events"
+
+using namespace poker;
+using namespace poker::cards;
+
+void sequence() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - sequence" << std::endl;
+    game_event_log log;
+    assert_eql(0, (int)log.last_seq());
+    log.card_opened(ALICE, 0, hA);
+    log.card_opened(ALICE, 1, dA);
+    log.bet_placed(ALICE, BET_RAISE, money_t(20), money_t(25));
+    log.phase_changed(PHS_FLOP);
+    log.card_opened(NONE, 0, s2);
+    log.winner_decided(BOB);
+    assert_eql(6, (int)log.last_seq());
+
+    std::vector<game_event> events;
+    log.events_since(0, events);
+    assert_eql(6, (int)events.size());
+    for (size_t i = 0; i < events.size(); i++)
+        assert_eql(i + 1, events[i].seq);
+    assert_eql(EVT_BET, events[2].type);
+    assert_eql(money_t(25), events[2].bets);
+    assert_eql(PHS_FLOP, events[3].phase);
+    assert_eql(NONE, events[4].player);
+    assert_eql(BOB, events[5].player);
+
+    events.clear();
+    log.events_since(4, events);
+    assert_eql(2, (int)events.size());
+    assert_eql(5, (int)events[0].seq);
+
+    events.clear();
+    log.events_since(6, events);
+    log.events_since(100, events);
+    assert_eql(0, (int)events.size());
+}
+
+void json() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - json" << std::endl;
+    game_event_log log;
+    log.card_opened(NONE, 2, s2);
+    log.bet_placed(BOB, BET_RAISE, money_t(20), money_t(30));
+    log.phase_changed(PHS_GAME_OVER);
+    log.winner_decided(TIE);
+
+    std::string json;
+    json_writer w(json);
+    log.write_json(1, w);
+    assert_eql(std::string("{\"last_seq\": 4, \"events\": ["
+                           "{\"seq\": 2, \"type\": \"bet\", \"player\": 1, \"bet_type\": 3, \"amount\": \"20\", \"bets\": \"30\"}, "
+                           "{\"seq\": 3, \"type\": \"phase\", \"phase\": 5}, "
+                           "{\"seq\": 4, \"type\": \"winner\", \"winner\": 2}]}"),
+               json);
+
+    json.clear();
+    json_writer w2(json);
+    log.write_json(0, w2);
+    assert_eql(0, (int)json.find("{\"last_seq\": 4, \"events\": [{\"seq\": 1, \"type\": \"card_opened\", "
+                                 "\"player\": -1, \"index\": 2, \"card\": 39}, "));
+}
+
+void bounds() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - bounds" << std::endl;
+    game_event_log log;
+    std::istringstream is("#2000000000|");
+    assert_eql(COD_ERROR, log.read(is));
+    assert_eql(0, (int)log.last_seq());
+}
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    sequence();
+    json();
+    bounds();
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
@@ -21,9 +21,28 @@ void the_happy_path() {
     assert_neq(0, gen.raw_turn_data.size());
 }
 
+void custom_strategy() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - custom_strategy" << std::endl;
+    game_generator gen;
+    int num_messages = 0;
+    gen.bet_strategy = [](int p, game_state& g, bet_type& type, money_t& amount) {
+        type = p == BOB ? BET_FOLD : BET_CALL;
+        amount = 0;
+    };
+    gen.on_message = [&](int p, const std::string& msg, double elapsed_us) {
+        num_messages++;
+    };
+    assert_eql(SUCCESS, gen.generate());
+
+    assert_eql(ALICE, gen.alice_game.winner);
+    assert_eql(ALICE, gen.bob_game.winner);
+    assert_eql((int)gen.turns.size(), num_messages);
+}
+
 int main(int argc, char** argv) {
     init_poker_lib();
     the_happy_path();
+    custom_strategy();
     std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
     return 0;
 }
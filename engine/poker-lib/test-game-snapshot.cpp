@@ -0,0 +1,101 @@
+#include <iostream>
+#include <cstring>
+#include "test-util.h"
+#include "poker-lib.h"
+#include "game-snapshot.h"
+
+#define TEST_SUITE_NAME "Test game snapshot"
+
+using namespace poker;
+using namespace poker::cards;
+
+static void make_game(game_state& g) {
+    g.big_blind = 10;
+    g.players[ALICE].total_funds = 100;
+    g.players[BOB].total_funds = 300;
+    g.players[ALICE].bets = 20;
+    g.players[BOB].bets = 40;
+    g.funds_share[ALICE] = 80;
+    g.funds_share[BOB] = 340;
+    g.open_private_card(ALICE, 0, hA);
+    g.open_private_card(ALICE, 1, dA);
+    g.open_public_card(0, sA);
+    g.open_public_card(1, s2);
+    g.open_public_card(2, c7);
+    g.current_player = BOB;
+    g.last_aggressor = ALICE;
+    g.next_msg_author = BOB;
+    g.phase = PHS_FLOP;
+    g.winner = NONE;
+}
+
+void round_trip() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - round_trip" << std::endl;
+    game_state g;
+    make_game(g);
+
+    game_snapshot s;
+    assert_eql(SUCCESS, s.capture(g));
+    assert_eql(40, (int)s.bets[BOB]);
+    assert_eql(sA, (int)s.public_cards[0]);
+    assert_eql(uk, (int)s.private_cards[BOB][0]);
+
+    char data[GAME_SNAPSHOT_SIZE];
+    s.encode(data);
+    game_snapshot s2;
+    assert_eql(SUCCESS, s2.decode(data));
+
+    game_state g2;
+    s2.restore(g2);
+    assert_eql(g.to_json(), g2.to_json());
+    assert_eql(money_t(10), g2.big_blind);
+    assert_eql(PHS_FLOP, g2.phase);
+    assert_eql(HAND_TRIPS, g2.players[ALICE].strength.category);
+    assert_eql(3, g2.players[BOB].strength.num_cards);
+
+    // snapshots copy like plain data
+    game_snapshot ring[4];
+    ring[1] = s2;
+    assert_eql(0, memcmp(&ring[1], &s2, sizeof(s2)));
+}
+
+void out_of_range() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - out_of_range" << std::endl;
+    game_state g;
+    make_game(g);
+    assert_eql(SUCCESS, g.players[BOB].total_funds.parse_string("18446744073709551615"));
+    game_snapshot s;
+    assert_eql(SUCCESS, s.capture(g));
+    assert_eql(SUCCESS, g.players[BOB].total_funds.parse_string("18446744073709551616"));
+    assert_eql(BIG_OUT_OF_RANGE, s.capture(g));
+}
+
+void invalid_encoding() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - invalid_encoding" << std::endl;
+    game_state g;
+    make_game(g);
+    game_snapshot s;
+    assert_eql(SUCCESS, s.capture(g));
+    char data[GAME_SNAPSHOT_SIZE];
+    s.encode(data);
+
+    char bad[GAME_SNAPSHOT_SIZE];
+    memcpy(bad, data, sizeof(bad));
+    bad[0] = GAME_SNAPSHOT_VERSION + 1;
+    assert_eql(SNP_INVALID_SNAPSHOT, s.decode(bad));
+    memcpy(bad, data, sizeof(bad));
+    bad[GAME_SNAPSHOT_SIZE - 1] = 60;
+    assert_eql(SNP_INVALID_SNAPSHOT, s.decode(bad));
+
+    // a failed decode leaves the snapshot unchanged
+    assert_eql(40, (int)s.bets[BOB]);
+}
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    round_trip();
+    out_of_range();
+    invalid_encoding();
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include <iostream>
+#include <cstring>
+#include <vector>
+#include "test-util.h"
+#include "poker-lib.h"
+#include "hand-eval.h"
+#include "game-state.h"
+
+#define TEST_SUITE_NAME "Test hand evaluator"
+
+using namespace poker;
+using namespace poker::cards;
+
+static uint32_t rng_state = 2463534242u;
+
+static int next_card() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state % 52;
+}
+
+// two hands sharing a board, as dealt in a game
+static void deal(card_t* hand1, card_t* hand2, int hand_size) {
+    uint64_t used = 0;
+    int board = hand_size > 2 ? hand_size - 2 : 0;
+    card_t cards[2 * 8];
+    for (int i = 0; i < 2 * hand_size - board;) {
+        int c = next_card();
+        if (used >> c & 1)
+            continue;
+        used |= 1ull << c;
+        cards[i++] = c;
+    }
+    for (int i = 0; i < hand_size; i++) {
+        hand1[i] = cards[i];
+        hand2[i] = i < board ? cards[i] : cards[hand_size + i - board];
+    }
+}
+
+void ranks() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - ranks" << std::endl;
+    card_t royal_flush[] = {sA, sK, sQ, sJ, sT, h2, d3};
+    card_t seven_high[] = {h7, d5, c4, s3, h2};
+    card_t wheel[] = {hA, d2, c3, s4, h5, dK};
+    assert_eql(NUM_HAND_RANKS, (int)rank_hand(royal_flush, 7));
+    assert_eql(1, (int)rank_hand(seven_high, 5));
+    assert_eql(HAND_STRAIGHT, rank_category(rank_hand(wheel, 6)));
+    assert_eql(HAND_STRAIGHT_FLUSH, rank_category(NUM_HAND_RANKS));
+    assert_eql(HAND_NO_PAIR, rank_category(1));
+}
+
+void invalid_cards() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - invalid_cards" << std::endl;
+    card_t unknown[] = {hA, d2, c3, s4, uk};
+    card_t duplicate[] = {hA, d2, c3, s4, hA};
+    card_t valid[] = {hA, d2, c3, s4, h5};
+    assert_eql(SRR_UNKNOWN_CARD, check_hand(unknown, 5));
+    assert_eql(SRR_DUPLICATE_CARD, check_hand(duplicate, 5));
+    assert_eql(SUCCESS, check_hand(valid, 5));
+}
+
+void batch() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - batch" << std::endl;
+    // enough hands to be split across threads
+    const size_t n = 300000;
+    std::vector<card_t> hands1(n * HAND_SIZE), hands2(n * HAND_SIZE);
+    for (size_t i = 0; i < n; i++)
+        deal(&hands1[i * HAND_SIZE], &hands2[i * HAND_SIZE], HAND_SIZE);
+
+    solver s;
+    std::vector<uint32_t> ranks(n);
+    std::vector<int> results(n);
+    assert_eql(SUCCESS, s.rank_hands(hands1.data(), n, ranks.data()));
+    assert_eql(SUCCESS, s.compare_batch(hands1.data(), hands2.data(), n, results.data()));
+    int mismatches = 0;
+    for (size_t i = 0; i < n; i++) {
+        int expected = -1;
+        assert_eql(SUCCESS, s.compare_hands(&hands1[i * HAND_SIZE], &hands2[i * HAND_SIZE], HAND_SIZE, &expected));
+        if (ranks[i] != rank_hand(&hands1[i * HAND_SIZE], HAND_SIZE) || results[i] != expected)
+            mismatches++;
+    }
+    assert_eql(0, mismatches);
+
+    hands2[(n - 1) * HAND_SIZE] = uk;
+    assert_eql(SRR_UNKNOWN_CARD, s.compare_batch(hands1.data(), hands2.data(), n, results.data()));
+}
+
+// native and poker-eval backends must agree on every comparison
+void strength() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - strength" << std::endl;
+    card_t hand[] = {hA, hK, h2, h7, c9, d9, sA};
+    hand_strength s;
+    for (int n = 1; n <= HAND_SIZE; n++) {
+        s.add_card(hand[n - 1]);
+        assert_eql(n, s.num_cards);
+        if (n >= 5) {
+            assert_eql(rank_hand(hand, n), s.rank);
+            assert_eql(rank_category(s.rank), s.category);
+        }
+    }
+    assert_eql(HAND_TWO_PAIR, s.category);
+    assert_eql(0, s.outs);
+
+    // nine hearts make a flush, 14 cards pair a rank
+    s.reset();
+    for (int i = 0; i < 5; i++)
+        s.add_card(hand[i]);
+    assert_eql(HAND_NO_PAIR, s.category);
+    assert_eql(23, s.outs);
+    s.add_card(uk);
+    s.add_card(hA);
+    assert_eql(5, s.num_cards);
+
+    game_state g;
+    assert_neq(std::string::npos, g.to_json().find("\"hand\": null"));
+    g.open_private_card(ALICE, 0, hA);
+    g.open_private_card(ALICE, 1, dA);
+    g.open_public_card(0, sA);
+    assert_eql(HAND_TRIPS, g.players[ALICE].strength.category);
+    assert_eql(1, g.players[BOB].strength.num_cards);
+    assert_neq(std::string::npos, g.to_json().find("\"hand\": {\"category\": \"Trips\", \"rank\": 0, \"outs\": 0}"));
+}
+
+void differential() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - differential" << std::endl;
+    if (!solver::has_backend(SOLVER_POKER_EVAL)) {
+        std::cout << "skipped: built without poker-eval" << std::endl;
+        return;
+    }
+    solver native(SOLVER_NATIVE), reference(SOLVER_POKER_EVAL);
+    int mismatches = 0;
+    for (int hand_size = 1; hand_size <= 8; hand_size++) {
+        int iterations = hand_size == 7 ? 1000000 : 100000;
+        for (int i = 0; i < iterations; i++) {
+            card_t hand1[8], hand2[8];
+            deal(hand1, hand2, hand_size);
+            int expected = -1, actual = -1;
+            assert_eql(SUCCESS, reference.compare_hands(hand1, hand2, hand_size, &expected));
+            assert_eql(SUCCESS, native.compare_hands(hand1, hand2, hand_size, &actual));
+            if (expected != actual || strcmp(reference.get_hand_name(hand1, hand_size), native.get_hand_name(hand1, hand_size)))
+                mismatches++;
+        }
+    }
+    assert_eql(0, mismatches);
+}
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    ranks();
+    invalid_cards();
+    strength();
+    batch();
+    differential();
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <climits>
+#include "test-util.h"
+#include "poker-lib.h"
+#include "json-writer.h"
+#include "game-state.h"
+
+#define TEST_SUITE_NAME "Test json writer"
+
+using namespace poker;
+
+void values() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - values" << std::endl;
+    money_t money;
+    assert_eql(SUCCESS, money.parse_string("-1234567"));
+    std::string json;
+    json_writer w(json);
+    w.begin_object()
+        .key("int").value(-42)
+        .key("min").value((long long)LLONG_MIN)
+        .key("max").value((unsigned long long)ULLONG_MAX)
+        .key("bool").value(true)
+        .key("null").null_value()
+        .key("str").value("a\"b\\c\n")
+        .key("money").value(money);
+    w.key("list").begin_array().value(1).begin_array().end_array().begin_object().end_object().end_array();
+    w.key("raw").raw("[1, 2]");
+    w.end_object();
+    assert_eql(std::string("{\"int\": -42, \"min\": -9223372036854775808, \"max\": 18446744073709551615, "
+                           "\"bool\": true, \"null\": null, \"str\": \"a\\\"b\\\\c\\u000a\", \"money\": \"-1234567\", "
+                           "\"list\": [1, [], {}], \"raw\": [1, 2]}"),
+               json);
+}
+
+void reuse() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - reuse" << std::endl;
+    game_state g;
+    assert_eql(SUCCESS, g.players[ALICE].total_funds.parse_string("123456789012345678901234567890"));
+    std::string json;
+    json_writer w(json);
+    g.write_json(w);
+    auto first = json;
+    auto capacity = json.capacity();
+    assert_neq(std::string::npos, first.find("\"total_funds\": \"123456789012345678901234567890\""));
+    // hand strengths are only reported to players
+    assert_eql(std::string::npos, first.find("\"hand\""));
+
+    // the buffer keeps its storage
+    json.clear();
+    json_writer w2(json);
+    g.write_json(w2);
+    assert_eql(first, json);
+    assert_eql(capacity, json.capacity());
+}
+
+void layout() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - layout" << std::endl;
+    game_state g;
+    g.players[BOB].id = BOB;
+    assert_eql(SUCCESS, g.players[ALICE].total_funds.parse_string("100"));
+    assert_eql(SUCCESS, g.funds_share[BOB].parse_string("7"));
+    const std::string head = "{\"current_player\": 0, \"next_msg_author\": -1, \"error\": 0, \"winner\": -1, "
+                             "\"public_cards\": [99, 99, 99, 99, 99], \"players\": [";
+    const std::string tail = "], \"funds_share\": [\"0\", \"7\"], \"last_aggressor\": 1, \"muck\": 0";
+
+    // referee and verifier
+    std::string json;
+    json_writer w(json);
+    g.write_json(w);
+    assert_eql(head + "{\"id\": 0, \"total_funds\": \"100\", \"bets\": \"0\", \"cards\": [99, 99]}, "
+                      "{\"id\": 1, \"total_funds\": \"0\", \"bets\": \"0\", \"cards\": [99, 99]}" + tail + "}",
+               json);
+
+    // players
+    auto players = head + "{\"id\": 0, \"total_funds\": \"100\", \"bets\": \"0\", \"cards\": [99, 99], \"hand\": null}, "
+                          "{\"id\": 1, \"total_funds\": \"0\", \"bets\": \"0\", \"cards\": [99, 99], \"hand\": null}" + tail;
+    assert_eql(players + "}", g.to_json());
+    char extra_fields[] = "\"step\": 3";
+    assert_eql(players + ", \"step\": 3}", g.to_json(extra_fields));
+
+    json.clear();
+    json_writer w2(json);
+    w2.begin_object();
+    g.write_json_fields(w2, true);
+    w2.key("step").value(3).end_object();
+    assert_eql(players + ", \"step\": 3}", json);
+}
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    values();
+    reuse();
+    layout();
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
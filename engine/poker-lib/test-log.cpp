@@ -0,0 +1,77 @@
+#include <iostream>
+#include <sstream>
+#include "test-util.h"
+#include "poker-lib.h"
+#include "log.h"
+
+#define TEST_SUITE_NAME "Test log"
+
+using namespace poker;
+
+static std::ostringstream out;
+
+static std::string take_output() {
+    flush_log();
+    auto s = out.str();
+    out.str("");
+    return s;
+}
+
+void levels() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - levels" << std::endl;
+    logger << "debug line " << 1 << std::endl;
+    logger_at(LOG_TRACE) << "trace line";
+    auto s = take_output();
+    assert_neq(std::string::npos, s.find("level=debug module=test-log thread="));
+    assert_neq(std::string::npos, s.find(" msg=\"debug line 1\"\n"));
+    assert_eql(std::string::npos, s.find("trace line"));
+
+    int evaluated = 0;
+    logger_at(LOG_TRACE) << ++evaluated;
+    assert_eql(0, evaluated);
+}
+
+void module_levels() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - module_levels" << std::endl;
+    assert_eql(true, set_log_levels("warn,test-log=trace"));
+    logger_at(LOG_TRACE) << "trace line";
+    assert_neq(std::string::npos, take_output().find("level=trace module=test-log"));
+
+    set_log_level("test-log", LOG_WARN);
+    logger << "debug line";
+    logger_at(LOG_ERROR) << "error line";
+    auto s = take_output();
+    assert_eql(std::string::npos, s.find("debug line"));
+    assert_neq(std::string::npos, s.find("level=error"));
+
+    assert_eql(false, set_log_levels("participant=loud"));
+    set_log_level(LOG_DEBUG);
+}
+
+void escaping() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - escaping" << std::endl;
+    logger << "say \"hi\"" << std::endl << "bye" << std::endl;
+    assert_neq(std::string::npos, take_output().find("msg=\"say \\\"hi\\\"\\nbye\"\n"));
+}
+
+void disabled() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - disabled" << std::endl;
+    logging_enabled = false;
+    logger_at(LOG_ERROR) << "error line";
+    assert_eql(std::string(""), take_output());
+    logging_enabled = true;
+}
+
+int main(int argc, char** argv) {
+    poker_lib_options opts;
+    opts.logging = true;
+    init_poker_lib(&opts);
+    set_log_output(&out);
+    levels();
+    module_levels();
+    escaping();
+    disabled();
+    set_log_output(&std::cerr);
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
@@ -1,8 +1,11 @@
 #include <iostream>
 #include <sstream>
+#include <memory>
 #include "poker-lib.h"
 #include "player.h"
 #include "game-playback.h"
+#include "compression.h"
+#include "messages.h"
 #include "test-util.h"
 #include "poker-lib.h"
 
@@ -223,6 +226,56 @@ void test_fold() {
     assert_eql(BOB, bob.winner());
 }
 
+// Restores a saved player into a new one, as after a restart
+static void checkpoint(player& p, std::unique_ptr<player>& restored) {
+    std::ostringstream os;
+    assert_eql(SUCCESS, p.save(os));
+    restored.reset(new player(ALICE));
+    std::istringstream is(os.str());
+    assert_eql(SUCCESS, restored->restore(is));
+    assert_eql(p.game().to_json(), restored->game().to_json());
+    assert_eql(p.step(), restored->step());
+    assert_eql(p.events().last_seq(), restored->events().last_seq());
+}
+
+void test_save_restore() {
+    player alice(ALICE);
+    assert_eql(SUCCESS, alice.init(100, 300, 10));
+    player bob(BOB);
+    assert_eql(SUCCESS, bob.init(100, 300, 10));
+    std::unique_ptr<player> alice2, bob2;
+
+    std::map<int, std::string> msg; // messages exchanged during game
+
+    // Bob moves in the middle of the handshake
+    assert_eql(SUCCESS, alice.create_handshake(msg[0]));
+    assert_eql(CONTINUED, bob.process_handshake(msg[0], msg[1]));
+    assert_eql(CONTINUED, alice.process_handshake(msg[1], msg[2]));
+    checkpoint(bob, bob2);
+    assert_eql(CONTINUED, bob2->process_handshake(msg[2], msg[3]));
+    assert_eql(SUCCESS, alice.process_handshake(msg[3], msg[4]));
+    assert_eql(SUCCESS, bob2->process_handshake(msg[4], msg[5]));
+    assert_eql(true, msg[5].size()==0);
+    assert_neq(uk, bob2->private_card(0));
+
+    // Alice moves after dealing; the flop is opened with the restored keys
+    checkpoint(alice, alice2);
+    assert_eql(alice.private_card(0), alice2->private_card(0));
+    assert_eql(SUCCESS, alice2->create_bet(BET_CALL, 0, msg[6]));
+    assert_eql(SUCCESS, bob2->process_bet(msg[6], msg[7]));
+    assert_eql(CONTINUED, bob2->create_bet(BET_CHECK, 0, msg[7]));
+    assert_eql(SUCCESS, alice2->process_bet(msg[7], msg[8]));
+    assert_eql(SUCCESS, bob2->process_bet(msg[8], msg[9]));
+    assert_eql(true, msg[9].empty());
+    assert_eql(game_step::FLOP_BET, alice2->step());
+    assert_eql(game_step::FLOP_BET, bob2->step());
+    assert_neq(uk, alice2->public_card(FLOP(0)));
+    assert_eql(alice2->public_card(FLOP(2)), bob2->public_card(FLOP(2)));
+
+    std::istringstream garbage("#2|");
+    assert_eql(PRR_SAVE_VERSION_MISMATCH, player(BOB).restore(garbage));
+}
+
 void test_next_msg_author() {
     player alice(ALICE);
     assert_eql(SUCCESS, alice.init(100, 300, 10));
@@ -312,11 +365,44 @@ void test_next_msg_author() {
     assert_eql(NONE, alice.game().next_msg_author);
 }
 
+void test_tampered_alice_mix() {
+    player alice(ALICE);
+    assert_eql(SUCCESS, alice.init(100, 300, 10));
+    player bob(BOB);
+    assert_eql(SUCCESS, bob.init(100, 300, 10));
+
+    std::map<int, std::string> msg;
+    assert_eql(SUCCESS, alice.create_handshake(msg[0]));
+    assert_eql(CONTINUED, bob.process_handshake(msg[0], msg[1]));
+    assert_eql(CONTINUED, alice.process_handshake(msg[1], msg[2]));
+
+    // Truncate the proof of Alice's shuffle
+    std::string raw;
+    assert_eql(SUCCESS, unwrap_and_decompress(msg[2], raw));
+    std::istringstream is(raw);
+    message* m;
+    assert_eql(SUCCESS, message::decode(is, &m));
+    assert_eql(MSG_VSSHE, m->type());
+    auto vsshe = (msg_vsshe*)m;
+    std::string proof = vsshe->stack_proof;
+    vsshe->stack_proof.set_data(proof.substr(0, proof.size() / 2));
+    std::ostringstream os;
+    assert_eql(SUCCESS, vsshe->write(os));
+    delete m;
+    assert_eql(SUCCESS, compress_and_wrap(os.str(), msg[2]));
+
+    // Bob rejects it and does not publish his own mix
+    assert_eql(PRR_LOAD_STACK, bob.process_handshake(msg[2], msg[3]));
+    assert_eql(true, msg[3].size()==0);
+}
+
 int main(int argc, char** argv) {
     init_poker_lib();
     test_the_happy_path();
     test_fold();
+    test_save_restore();
     test_next_msg_author();
+    test_tampered_alice_mix();
     std::cout << "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
     return 0;
 }
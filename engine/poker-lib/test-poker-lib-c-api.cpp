@@ -2,6 +2,7 @@
 #include <sstream>
 #include <map>
 #include <cstring>
+#include <cstdio>
 #include "test-util.h"
 #include "common.h"
 #include "poker-lib-c-api.h"
@@ -11,6 +12,7 @@
 #define RIVER   FLOP(2)+2
 
 void test_the_happy_path() {
+    assert_eql((PAPI_ERR)poker::TMC_UNKNOWN_PROFILE, papi_init_ex(true, true, -1, "weak"));
     assert_eql(PAPI_SUCCESS, papi_init(true, true, -1));
     PAPI_PLAYER alice, bob;
     assert_eql(PAPI_SUCCESS, papi_new_player(0, &alice));
@@ -38,6 +40,54 @@ void test_the_happy_path() {
     assert_eql(true, (int)type == (int)poker::BET_CALL);
     assert_eql(0, strcmp(amt, "0"));
 
+    // Bob saw his cards and Alice's call; nothing new after last_seq
+    PAPI_BUFFER events;
+    PAPI_MESSAGE data;
+    int last_seq = 0;
+    assert_eql(PAPI_SUCCESS, papi_new_buffer(&events));
+    assert_eql(PAPI_SUCCESS, papi_get_events(bob, 0, events));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(events, &data, &len));
+    std::string json(data, len);
+    assert_eql(1, sscanf(json.c_str(), "{\"last_seq\": %d", &last_seq));
+    assert_neq(std::string::npos, json.find("\"type\": \"card_opened\", \"player\": 1, \"index\": 0"));
+    assert_neq(std::string::npos, json.find("\"type\": \"bet\", \"player\": 0, \"bet_type\": 2"));
+    assert_eql(PAPI_SUCCESS, papi_get_events(bob, last_seq, events));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(events, &data, &len));
+    assert_eql(std::string("\"events\": []}"), std::string(data, len).substr(len - 13));
+
+    // Game state: no truncation into a short buffer
+    char short_json[16];
+    assert_eql(poker::API_BUFFER_TOO_SMALL, papi_get_game_state(bob, short_json, sizeof(short_json)));
+    assert_eql(PAPI_SUCCESS, papi_get_game_state_into(bob, events));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(events, &data, &len));
+    json.assign(data, len);
+    assert_neq(std::string::npos, json.find("\"players\": [{\"id\": 0, \"total_funds\": \"100\""));
+    assert_neq(std::string::npos, json.find(", \"step\": "));
+    assert_eql(PAPI_SUCCESS, papi_delete_buffer(events));
+
+    // Bob resumes from a checkpoint
+    PAPI_BUFFER state, json1, json2;
+    PAPI_PLAYER bob2, truncated;
+    assert_eql(PAPI_SUCCESS, papi_new_buffer(&state));
+    assert_eql(PAPI_SUCCESS, papi_new_buffer(&json1));
+    assert_eql(PAPI_SUCCESS, papi_new_buffer(&json2));
+    assert_eql(PAPI_SUCCESS, papi_save_player(bob, state));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(state, &data, &len));
+    assert_eql(PAPI_SUCCESS, papi_restore_player(data, len, &bob2));
+    assert_neq(PAPI_SUCCESS, papi_restore_player(data, len / 2, &truncated));
+    assert_eql(true, truncated == NULL);
+    assert_eql(PAPI_SUCCESS, papi_get_game_state_into(bob, json1));
+    assert_eql(PAPI_SUCCESS, papi_get_game_state_into(bob2, json2));
+    PAPI_MESSAGE data2;
+    PAPI_INT len2;
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(json1, &data, &len));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(json2, &data2, &len2));
+    assert_eql(std::string(data, len), std::string(data2, len2));
+    assert_eql(PAPI_SUCCESS, papi_delete_buffer(state));
+    assert_eql(PAPI_SUCCESS, papi_delete_buffer(json1));
+    assert_eql(PAPI_SUCCESS, papi_delete_buffer(json2));
+    assert_eql(PAPI_SUCCESS, papi_delete_player(bob2));
+
     for(auto m: msg)
       if (m.second)
         assert_eql(PAPI_SUCCESS, papi_delete_message(m.second));
@@ -46,8 +96,173 @@ void test_the_happy_path() {
     assert_eql(PAPI_SUCCESS, papi_delete_player(bob));
 }
 
+void test_reusable_buffers() {
+    PAPI_PLAYER alice, bob;
+    assert_eql(PAPI_SUCCESS, papi_new_player(0, &alice));
+    assert_eql(PAPI_SUCCESS, papi_new_player(1, &bob));
+    assert_eql(PAPI_SUCCESS, papi_init_player(alice, (PAPI_MONEY)"100", (PAPI_MONEY)"300", (PAPI_MONEY)"10"));
+    assert_eql(PAPI_SUCCESS, papi_init_player(bob, (PAPI_MONEY)"100", (PAPI_MONEY)"300", (PAPI_MONEY)"10"));
+
+    // each player writes into its own buffer, reused for every message
+    PAPI_BUFFER alice_out, bob_out;
+    PAPI_MESSAGE data;
+    PAPI_INT len;
+    assert_eql(PAPI_SUCCESS, papi_new_buffer(&alice_out));
+    assert_eql(PAPI_SUCCESS, papi_new_buffer(&bob_out));
+
+    assert_eql(PAPI_SUCCESS, papi_create_handshake_into(alice, alice_out));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(alice_out, &data, &len));
+    assert_eql(PAPI_CONTINUED, papi_process_handshake_into(bob, data, len, bob_out));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(bob_out, &data, &len));
+    assert_eql(PAPI_CONTINUED, papi_process_handshake_into(alice, data, len, alice_out));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(alice_out, &data, &len));
+    assert_eql(PAPI_CONTINUED, papi_process_handshake_into(bob, data, len, bob_out));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(bob_out, &data, &len));
+    assert_eql(PAPI_SUCCESS, papi_process_handshake_into(alice, data, len, alice_out));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(alice_out, &data, &len));
+    assert_eql(PAPI_SUCCESS, papi_process_handshake_into(bob, data, len, bob_out));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(bob_out, &data, &len));
+    assert_eql(0, len);
+
+    // Preflop: Alice raises
+    assert_eql(PAPI_SUCCESS, papi_create_bet_into(alice, poker::BET_RAISE, (PAPI_MONEY)"20", alice_out));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(alice_out, &data, &len));
+    PAPI_INT type;
+    char amt[10];
+    assert_eql(PAPI_SUCCESS, papi_process_bet_into(bob, data, len, bob_out, &type, amt, sizeof(amt)));
+    assert_eql(true, (int)type == (int)poker::BET_RAISE);
+    assert_eql(0, strcmp(amt, "20"));
+
+    assert_eql(PAPI_SUCCESS, papi_delete_buffer(alice_out));
+    assert_eql(PAPI_SUCCESS, papi_delete_buffer(bob_out));
+    assert_eql(PAPI_SUCCESS, papi_delete_player(alice));
+    assert_eql(PAPI_SUCCESS, papi_delete_player(bob));
+}
+
+void test_async_handshakes() {
+    const int num_games = 3;
+    PAPI_PLAYER players[num_games][2];
+    for (int g = 0; g < num_games; g++) {
+        for (int id = 0; id < 2; id++) {
+            assert_eql(PAPI_SUCCESS, papi_new_player(id, &players[g][id]));
+            assert_eql(PAPI_SUCCESS, papi_init_player(players[g][id], (PAPI_MONEY)"100", (PAPI_MONEY)"300", (PAPI_MONEY)"10"));
+        }
+        // user_data identifies the game and the player that did the work
+        PAPI_REQUEST req = 0;
+        assert_eql(PAPI_SUCCESS, papi_create_handshake_async(players[g][0], NULL, (void*)(intptr_t)(g * 2), &req));
+        assert_neq(0, req);
+    }
+
+    // Drive all handshakes from this thread until Bob has nothing left to say
+    int finished = 0;
+    while (finished < num_games) {
+        PAPI_COMPLETION completions[4];
+        PAPI_INT count;
+        assert_eql(PAPI_SUCCESS, papi_wait(completions, 4, -1, &count));
+        for (int i = 0; i < count; i++) {
+            auto& c = completions[i];
+            int g = (int)(intptr_t)c.user_data / 2;
+            int author = (int)(intptr_t)c.user_data % 2;
+            assert_eql(true, c.status == PAPI_SUCCESS || c.status == PAPI_CONTINUED);
+            if (!c.msg_out_len) {
+                assert_eql(1, author);
+                finished++;
+                continue;
+            }
+            int to = 1 - author;
+            assert_eql(PAPI_SUCCESS, papi_process_handshake_async(players[g][to], c.msg_out, c.msg_out_len, NULL, (void*)(intptr_t)(g * 2 + to), NULL));
+            assert_eql(PAPI_SUCCESS, papi_delete_message(c.msg_out));
+        }
+    }
+
+    PAPI_INT count;
+    PAPI_COMPLETION c;
+    assert_eql(PAPI_SUCCESS, papi_poll(&c, 1, &count));
+    assert_eql(0, count);
+
+    for (int g = 0; g < num_games; g++)
+        for (int id = 0; id < 2; id++)
+            assert_eql(PAPI_SUCCESS, papi_delete_player(players[g][id]));
+}
+
+void test_trace() {
+    PAPI_PLAYER alice;
+    PAPI_BUFFER out, json;
+    PAPI_MESSAGE data;
+    PAPI_INT len;
+    assert_eql(PAPI_SUCCESS, papi_new_player(0, &alice));
+    assert_eql(PAPI_SUCCESS, papi_init_player(alice, (PAPI_MONEY)"100", (PAPI_MONEY)"300", (PAPI_MONEY)"10"));
+    assert_eql(PAPI_SUCCESS, papi_new_buffer(&out));
+    assert_eql(PAPI_SUCCESS, papi_new_buffer(&json));
+
+    assert_eql(PAPI_SUCCESS, papi_set_tracing(true));
+    assert_eql(PAPI_SUCCESS, papi_create_handshake_into(alice, out));
+    assert_eql(PAPI_SUCCESS, papi_set_tracing(false));
+
+    assert_eql(PAPI_SUCCESS, papi_dump_trace(json, true));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(json, &data, &len));
+    std::string trace(data, len);
+    assert_eql(0, (int)trace.find("{\"traceEvents\":["));
+    assert_neq(std::string::npos, trace.find("\"name\":\"create_handshake\""));
+    assert_neq(std::string::npos, trace.find("\"name\":\"step_vtmf_group\""));
+    assert_neq(std::string::npos, trace.find("\"name\":\"compress_and_wrap\""));
+
+    // cleared by the previous dump
+    assert_eql(PAPI_SUCCESS, papi_dump_trace(json, false));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(json, &data, &len));
+    trace = std::string(data, len);
+    assert_eql(std::string::npos, trace.find("create_handshake"));
+
+    assert_eql(PAPI_SUCCESS, papi_delete_buffer(out));
+    assert_eql(PAPI_SUCCESS, papi_delete_buffer(json));
+    assert_eql(PAPI_SUCCESS, papi_delete_player(alice));
+}
+
+void test_metrics() {
+    PAPI_BUFFER json, text;
+    PAPI_MESSAGE data;
+    PAPI_INT len;
+    assert_eql(PAPI_SUCCESS, papi_new_buffer(&json));
+    assert_eql(PAPI_SUCCESS, papi_new_buffer(&text));
+
+    // the previous tests played handshakes and bets
+    assert_eql(PAPI_SUCCESS, papi_get_metrics(json));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(json, &data, &len));
+    std::string metrics(data, len);
+    assert_eql(0, (int)metrics.find("{\"steps\":{"));
+    assert_neq(std::string::npos, metrics.find("\"vtmf_group\":{\"count\":"));
+    assert_neq(std::string::npos, metrics.find("\"vtmf_out\":{\"count\":"));
+    assert_neq(std::string::npos, metrics.find("\"stack\":{\"checked\":"));
+
+    assert_eql(PAPI_SUCCESS, papi_get_metrics_prometheus(text));
+    assert_eql(PAPI_SUCCESS, papi_buffer_data(text, &data, &len));
+    std::string prometheus(data, len);
+    assert_neq(std::string::npos, prometheus.find("poker_step_duration_seconds_count{step=\"vtmf_group\"}"));
+    assert_neq(std::string::npos, prometheus.find("poker_message_bytes_total{type=\"vtmf\",direction=\"out\",encoding=\"wire\"}"));
+
+    assert_eql(PAPI_SUCCESS, papi_delete_buffer(json));
+    assert_eql(PAPI_SUCCESS, papi_delete_buffer(text));
+}
+
+void test_preflop_equity() {
+    // AhAd against KcKs
+    PAPI_INT aces[2] = {12, 25}, kings[2] = {37, 50};
+    double equity = 0;
+    assert_eql(PAPI_SUCCESS, papi_preflop_equity(aces, kings, &equity));
+    assert_eql(true, equity > 0.81 && equity < 0.83);
+    assert_eql(PAPI_SUCCESS, papi_preflop_equity(kings, aces, &equity));
+    assert_eql(true, equity > 0.17 && equity < 0.19);
+    assert_neq(PAPI_SUCCESS, papi_preflop_equity(aces, aces, &equity));
+    assert_neq(PAPI_SUCCESS, papi_load_preflop_equity("no-such-preflop-equity.bin"));
+}
+
 int main(int argc, char** argv) {
     test_the_happy_path();
+    test_reusable_buffers();
+    test_async_handshakes();
+    test_trace();
+    test_metrics();
+    test_preflop_equity();
     std::cout << "---- SUCCESS" << std::endl;
     return 0;
 }
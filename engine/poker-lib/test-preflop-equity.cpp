@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include "test-util.h"
+#include "poker-lib.h"
+#include "equity.h"
+#include "preflop-equity.h"
+
+#define TEST_SUITE_NAME "Test preflop equity"
+
+using namespace poker;
+using namespace poker::cards;
+
+static const char* table_path = "test-preflop-equity.bin";
+
+void classes() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - classes" << std::endl;
+    assert_eql(std::string("AA"), preflop_class_name(preflop_class(hA, dA)));
+    assert_eql(std::string("AKs"), preflop_class_name(preflop_class(sK, sA)));
+    assert_eql(std::string("T9o"), preflop_class_name(preflop_class(h9, cT)));
+    assert_eql(preflop_class(hA, hK), preflop_class(dK, dA));
+
+    std::set<int> seen_classes, seen_holdings;
+    for (card_t c2 = 0; c2 < DECK_SIZE; c2++) {
+        for (card_t c1 = 0; c1 < c2; c1++) {
+            seen_classes.insert(preflop_class(c1, c2));
+            seen_holdings.insert(holding_index(c1, c2));
+            assert_eql(holding_index(c1, c2), holding_index(c2, c1));
+        }
+    }
+    assert_eql(NUM_PREFLOP_CLASSES, (int)seen_classes.size());
+    assert_eql(NUM_HOLDINGS, (int)seen_holdings.size());
+    assert_eql(0, *seen_holdings.begin());
+    assert_eql(NUM_HOLDINGS - 1, *seen_holdings.rbegin());
+}
+
+void canonical() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - canonical" << std::endl;
+    const card_t h1[NUM_PLAYERS][NUM_PRIVATE_CARDS] = {{hA, dA}, {cK, sK}};
+    const card_t h2[NUM_PLAYERS][NUM_PRIVATE_CARDS] = {{sA, cA}, {hK, dK}};
+    const card_t h3[NUM_PLAYERS][NUM_PRIVATE_CARDS] = {{hA, dA}, {hK, sK}};
+    card_t c1[NUM_PLAYERS][NUM_PRIVATE_CARDS], c2[NUM_PLAYERS][NUM_PRIVATE_CARDS], c3[NUM_PLAYERS][NUM_PRIVATE_CARDS];
+    canonical_holdings(h1, c1);
+    canonical_holdings(h2, c2);
+    canonical_holdings(h3, c3);
+    assert_eql(true, std::equal(&c1[0][0], &c1[0][0] + 4, &c2[0][0]));
+    assert_eql(false, std::equal(&c1[0][0], &c1[0][0] + 4, &c3[0][0]));
+    for (int p = 0; p < NUM_PLAYERS; p++)
+        assert_eql(preflop_class(h1[p][0], h1[p][1]), preflop_class(c1[p][0], c1[p][1]));
+}
+
+void class_equities() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - class_equities" << std::endl;
+    for (int c1 = 0; c1 < NUM_PREFLOP_CLASSES; c1++)
+        for (int c2 = 0; c2 < NUM_PREFLOP_CLASSES; c2++)
+            assert_eql(true, std::fabs(preflop_class_equity(c1, c2) + preflop_class_equity(c2, c1) - 1) < 1e-5);
+
+    // AA against KK over all suit combinations
+    const card_t cards[NUM_PLAYERS][NUM_PRIVATE_CARDS] = {{hA, dA}, {cK, sK}};
+    equity_options opts;
+    equity_result r;
+    assert_eql(SUCCESS, compute_equity(cards, NULL, 0, opts, r));
+    auto aa_kk = preflop_class_equity(preflop_class(hA, dA), preflop_class(cK, sK));
+    assert_eql(true, aa_kk > 0.81 && aa_kk < 0.83);
+    assert_eql(true, std::fabs(aa_kk - r.equity[ALICE]) < 0.01);
+
+    preflop_equity_table table;
+    double equity;
+    assert_eql(SUCCESS, preflop_equity(table, cards, equity));
+    assert_eql(aa_kk, equity);
+    const card_t duplicated[NUM_PLAYERS][NUM_PRIVATE_CARDS] = {{hA, dA}, {hA, sK}};
+    assert_eql(SRR_DUPLICATE_CARD, preflop_equity(table, duplicated, equity));
+}
+
+void table() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - table" << std::endl;
+    preflop_equity_table t;
+    double equity;
+    const card_t cards[NUM_PLAYERS][NUM_PRIVATE_CARDS] = {{hA, dA}, {cK, sK}};
+    assert_eql(PEQ_TABLE_NOT_LOADED, t.equity(cards, equity));
+    assert_eql(PEQ_OPEN_TABLE, t.load("no-such-preflop-equity.bin"));
+
+    // small table with a made up entry
+    preflop_equity_header header = {PREFLOP_EQUITY_MAGIC, PREFLOP_EQUITY_VERSION, NUM_HOLDINGS, 0};
+    std::vector<float> values(NUM_HOLDINGS * NUM_HOLDINGS, -1);
+    values[holding_index(hA, dA) * NUM_HOLDINGS + holding_index(cK, sK)] = 0.75f;
+    FILE* f = fopen(table_path, "wb");
+    fwrite(&header, sizeof(header), 1, f);
+    fwrite(values.data(), sizeof(float), values.size() / 2, f);
+    fclose(f);
+    assert_eql(PEQ_INVALID_TABLE, t.load(table_path));
+    assert_eql(false, t.loaded());
+
+    f = fopen(table_path, "wb");
+    fwrite(&header, sizeof(header), 1, f);
+    fwrite(values.data(), sizeof(float), values.size(), f);
+    fclose(f);
+    assert_eql(SUCCESS, t.load(table_path));
+    assert_eql(true, t.loaded());
+    assert_eql(SUCCESS, t.equity(cards, equity));
+    assert_eql(0.75, equity);
+    assert_eql(SUCCESS, preflop_equity(t, cards, equity));
+    assert_eql(0.75, equity);
+
+    t.unload();
+    assert_eql(false, t.loaded());
+    remove(table_path);
+}
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    classes();
+    canonical();
+    class_equities();
+    table();
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
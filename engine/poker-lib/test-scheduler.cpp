@@ -0,0 +1,141 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "test-util.h"
+#include "poker-lib.h"
+#include "scheduler.h"
+
+#define TEST_SUITE_NAME "Test scheduler"
+
+using namespace poker;
+
+void test_parallel_for() {
+    scheduler s(4);
+    const size_t n = 100000;
+    std::vector<int> v(n, 0);
+    assert_eql(SUCCESS, s.parallel_for(n, 1000, [&](size_t begin, size_t end) {
+        for (auto i = begin; i < end; i++)
+            v[i] += (int)i % 7;
+        return SUCCESS;
+    }));
+    for (size_t i = 0; i < n; i++)
+        assert_eql((int)i % 7, v[i]);
+
+    // the first error is returned
+    assert_eql(SRR_UNKNOWN_CARD, s.parallel_for(n, 1000, [&](size_t begin, size_t end) {
+        return begin == 50000 ? SRR_UNKNOWN_CARD : SUCCESS;
+    }));
+
+    // nested loops run on the workers and the calling tasks
+    std::atomic<int> count(0);
+    assert_eql(SUCCESS, s.parallel_for(16, 1, [&](size_t begin, size_t end) {
+        return s.parallel_for(16, 1, [&](size_t b, size_t e) {
+            count++;
+            return SUCCESS;
+        });
+    }));
+    assert_eql(16 * 16, count.load());
+}
+
+void test_task_group() {
+    scheduler s(2);
+    std::atomic<int> count(0);
+    {
+        task_group g(s, PRIORITY_INTERACTIVE);
+        for (int i = 0; i < 10; i++)
+            g.run([&]() { count++; });
+        g.wait();
+        assert_eql(10, count.load());
+        g.run([&]() { count++; });
+    }
+    assert_eql(11, count.load());
+}
+
+// Tasks of one key run in order, one at a time, also after one throws
+void test_keys() {
+    scheduler s(4);
+    const int n = 200;
+    std::vector<int> order[2];
+    std::atomic<int> running[2], done(0);
+    for (int k = 0; k < 2; k++)
+        running[k] = 0;
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < 2; k++) {
+            s.submit(&order[k], [&, i, k]() {
+                assert_eql(1, ++running[k]);
+                order[k].push_back(i);
+                running[k]--;
+                done++;
+#ifdef POKER_THREADS
+                // logged by the worker; without threads it would reach the caller
+                if (i == n / 2)
+                    throw std::runtime_error("task failed");
+#endif
+            }, PRIORITY_INTERACTIVE);
+        }
+    }
+    while (done < 2 * n)
+        std::this_thread::yield();
+    for (int k = 0; k < 2; k++) {
+        assert_eql(n, (int)order[k].size());
+        for (int i = 0; i < n; i++)
+            assert_eql(i, order[k][i]);
+    }
+}
+
+#ifdef POKER_THREADS
+// Interactive tasks are taken before queued background tasks
+void test_priorities() {
+    scheduler s(1);
+    std::atomic<bool> started(false), blocked(true);
+    std::vector<int> order;
+    s.submit([&]() {
+        started = true;
+        while (blocked)
+            std::this_thread::yield();
+    });
+    while (!started)
+        std::this_thread::yield();
+
+    std::atomic<int> done(0);
+    for (int i = 0; i < 3; i++)
+        s.submit([&, i]() { order.push_back(i); done++; }, PRIORITY_BACKGROUND);
+    s.submit([&]() { order.push_back(100); done++; }, PRIORITY_INTERACTIVE);
+    blocked = false;
+    while (done < 4)
+        std::this_thread::yield();
+
+    assert_eql(4, (int)order.size());
+    assert_eql(100, order[0]);
+
+    // counted once the task has returned
+    std::vector<worker_stats> stats;
+    do {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        s.get_stats(stats);
+    } while (stats[0].tasks[PRIORITY_INTERACTIVE] + stats[0].tasks[PRIORITY_BACKGROUND] < 5);
+    assert_eql(1, (int)stats.size());
+    assert_eql(1, (int)stats[0].tasks[PRIORITY_INTERACTIVE]);
+    assert_eql(4, (int)stats[0].tasks[PRIORITY_BACKGROUND]);
+
+    std::string json;
+    json_writer w(json);
+    s.write_json(w);
+    assert_eql(0, (int)json.find("{\"workers\": [{\"interactive_tasks\": 1, "));
+}
+#endif
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    test_parallel_for();
+    test_task_group();
+    test_keys();
+#ifdef POKER_THREADS
+    test_priorities();
+#endif
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <map>
+#include <sstream>
+#include "test-util.h"
+#include "poker-lib.h"
+#include "table-manager.h"
+
+#define TEST_SUITE_NAME "Test table manager"
+
+using namespace poker;
+
+// Plays several hands at once, routing messages between Alice's and Bob's
+// tables through the completion stream, until Alice folds preflop
+void test_concurrent_hands() {
+    const int num_games = 4;
+    scheduler s(4);
+    table_manager tm(s);
+    std::map<table_id, table_id> opponent;
+    std::map<table_id, int> owner;
+    for (int g = 0; g < num_games; g++) {
+        table_id alice, bob;
+        assert_eql(SUCCESS, tm.create_table(ALICE, 100, 300, 10, alice));
+        assert_eql(SUCCESS, tm.create_table(BOB, 100, 300, 10, bob));
+        opponent[alice] = bob;
+        opponent[bob] = alice;
+        owner[alice] = ALICE;
+        owner[bob] = BOB;
+        uint64_t req = 0;
+        assert_eql(SUCCESS, tm.create_handshake(alice, req));
+        assert_neq(0, req);
+    }
+    assert_eql(2 * num_games, tm.num_tables());
+
+    int finished = 0;
+    while (finished < num_games) {
+        std::vector<table_completion> completions;
+        tm.wait(completions, 8, -1);
+        for (auto& c : completions) {
+            assert_eql(true, c.status == SUCCESS || c.status == CONTINUED);
+            uint64_t req;
+            if (c.msg_out.size()) {
+                assert_eql(SUCCESS, tm.post_message(opponent[c.table], c.msg_out.data(), c.msg_out.size(), req));
+                continue;
+            }
+            assert_eql(BOB, owner[c.table]);
+            if (c.step == GAME_OVER) {
+                assert_eql(BET_FOLD, c.bet);
+                finished++;
+            } else {
+                assert_eql(PREFLOP_BET, c.step);
+                assert_eql(SUCCESS, tm.create_bet(opponent[c.table], BET_FOLD, 0, req));
+            }
+        }
+    }
+
+    std::vector<table_completion> rest;
+    assert_eql(0, tm.poll(rest, 8));
+}
+
+void test_closed_table() {
+    scheduler s(2);
+    table_manager tm(s);
+    table_id alice;
+    uint64_t req;
+    assert_eql(SUCCESS, tm.create_table(ALICE, 100, 300, 10, alice));
+    assert_eql(TBL_UNKNOWN_TABLE, tm.create_handshake(alice + 1, req));
+
+    // queued work still runs after the table is closed
+    assert_eql(SUCCESS, tm.create_handshake(alice, req));
+    assert_eql(SUCCESS, tm.close_table(alice));
+    assert_eql(0, tm.num_tables());
+    assert_eql(TBL_UNKNOWN_TABLE, tm.close_table(alice));
+    assert_eql(TBL_UNKNOWN_TABLE, tm.post_message(alice, "x", 1, req));
+
+    std::vector<table_completion> completions;
+    assert_eql(1, tm.wait(completions, 8, -1));
+    assert_eql(alice, completions[0].table);
+    assert_eql(req, completions[0].request);
+    assert_eql(SUCCESS, completions[0].status);
+    assert_eql(true, completions[0].msg_out.size() > 0);
+
+    // handles are not reused
+    table_id next;
+    assert_eql(SUCCESS, tm.create_table(ALICE, 100, 300, 10, next));
+    assert_neq(alice, next);
+}
+
+void test_restore_table() {
+    scheduler s(2);
+    table_manager tm(s);
+    player bob(BOB);
+    assert_eql(SUCCESS, bob.init(100, 300, 10));
+    std::ostringstream os;
+    assert_eql(SUCCESS, bob.save(os));
+    std::string state = os.str();
+
+    table_id id;
+    assert_eql(SUCCESS, tm.restore_table(state.data(), state.size(), id));
+    assert_eql(1, tm.num_tables());
+    assert_neq(SUCCESS, tm.restore_table(state.data(), state.size() / 2, id));
+    assert_eql(1, tm.num_tables());
+}
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    test_concurrent_hands();
+    test_closed_table();
+    test_restore_table();
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
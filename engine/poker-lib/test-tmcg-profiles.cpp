@@ -0,0 +1,97 @@
+#include <iostream>
+#include <string>
+#include "test-util.h"
+#include "poker-lib.h"
+#include "participant.h"
+#include "referee.h"
+
+#define TEST_SUITE_NAME "Test TMCG profiles"
+
+using namespace poker;
+
+void test_profiles() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - profiles" << std::endl;
+    assert_eql(3, num_tmcg_profiles);
+    assert_eql(std::string("standard"), std::string(find_tmcg_profile("standard")->name));
+    assert_eql(64, (int)find_tmcg_profile("standard")->security_level);
+    assert_eql(true, find_tmcg_profile("fast-test")->strength < find_tmcg_profile("standard")->strength);
+    assert_eql(true, find_tmcg_profile("standard")->strength < find_tmcg_profile("high")->strength);
+    assert_eql(std::string("fast-test"), std::string(weakest_tmcg_profile()->name));
+    assert_eql(true, NULL == find_tmcg_profile("weak"));
+
+    participant p(false, "weak");
+    p.init(ALICE, 2, false);
+    blob group;
+    assert_eql(TMC_UNKNOWN_PROFILE, p.create_group(group));
+}
+
+void test_negotiation() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - negotiation" << std::endl;
+    participant alice(false, "fast-test");
+    alice.init(ALICE, 2, false);
+    blob group;
+    assert_eql(SUCCESS, alice.create_group(group));
+
+    // accepted by a participant requiring the same profile or a weaker one
+    participant bob(false, "fast-test");
+    bob.init(BOB, 2, false);
+    blob g1(group);
+    assert_eql(SUCCESS, bob.load_group(g1));
+
+    // rejected by a participant requiring a stronger one
+    participant carol(false, "standard");
+    carol.init(BOB, 2, false);
+    blob g2(group);
+    assert_eql(TMC_PROFILE_REJECTED, carol.load_group(g2));
+
+    // unless its floor is lower than the profile it proposes
+    participant erin(false, "standard", "fast-test");
+    erin.init(BOB, 2, false);
+    blob g3(group);
+    assert_eql(SUCCESS, erin.load_group(g3));
+
+    // a group smaller than the profile it claims
+    std::string s = group.str();
+    auto pos = s.find("$9|fast-test");
+    assert_neq(std::string::npos, pos);
+    s.replace(pos, 12, "$8|standard");
+    blob forged;
+    forged.set_data(s);
+    participant dave(false, "fast-test");
+    dave.init(BOB, 2, false);
+    assert_eql(TMC_CHECK_GROUP, dave.load_group(forged));
+}
+
+// referees verify games of any known profile, or of a configured floor
+void test_referee() {
+    std::cout <<  "---- " TEST_SUITE_NAME << " - referee" << std::endl;
+    participant alice(false, "fast-test");
+    alice.init(ALICE, 2, false);
+    blob group;
+    assert_eql(SUCCESS, alice.create_group(group));
+
+    poker_lib_options opts;
+    opts.tmcg_profile = "standard";
+    opts.referee_tmcg_min_profile = NULL;
+    init_poker_lib(&opts);
+    referee r;
+    assert_eql(SUCCESS, r.step_init_game(100, 100, 10));
+    blob g1(group);
+    assert_eql(SUCCESS, r.step_vtmf_group(g1, BACKEND_DLOG));
+
+    opts.referee_tmcg_min_profile = "standard";
+    init_poker_lib(&opts);
+    referee strict;
+    assert_eql(SUCCESS, strict.step_init_game(100, 100, 10));
+    blob g2(group);
+    assert_eql(ERR_VTMF_LOAD_FAILED, strict.step_vtmf_group(g2, BACKEND_DLOG));
+}
+
+int main(int argc, char** argv) {
+    init_poker_lib();
+    test_profiles();
+    test_negotiation();
+    test_referee();
+    std::cout <<  "---- SUCCESS - " TEST_SUITE_NAME << std::endl;
+    return 0;
+}
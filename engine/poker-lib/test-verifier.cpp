@@ -43,6 +43,27 @@ void test_the_happy_path() {
     std::cout << output.str() << std::endl;
 }
 
+// the backend of the game comes from its messages, not from the options
+void test_ec_game() {
+    poker_lib_options opts;
+    opts.backend = BACKEND_EC;
+    init_poker_lib(&opts);
+    game_generator gen;
+    assert_eql(SUCCESS, gen.generate());
+    init_poker_lib();
+
+    std::istringstream turns(gen.raw_turn_data);
+    std::istringstream turns_meta(gen.raw_turn_metadata);
+    std::istringstream player_info(gen.raw_player_info);
+    std::istringstream verification_info(gen.raw_verification_info);
+    std::ostringstream output;
+    verifier ver(player_info, turns_meta, verification_info, turns, output);
+    assert_eql(SUCCESS, ver.verify());
+    assert_neq(RULE_PLAYBACK_FAILED, ver.applied_rule());
+    assert_eql(gen.alice_game.winner, ver.game().winner);
+    assert_eql(SUCCESS, ver.game().error);
+}
+
 void test_punish() {
     verification_results_t funds{ 100, 200 };
     verifier::punish(ALICE, funds);
@@ -208,6 +229,7 @@ int main(int argc, char** argv) {
     init_poker_lib();
 
     test_the_happy_path();
+    test_ec_game();
     test_punish();
     test_compute_result();
 
@@ -0,0 +1,133 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+#ifdef POKER_THREADS
+#include <mutex>
+#endif
+
+namespace poker {
+
+std::atomic<bool> tracing_enabled(false);
+
+namespace {
+
+const uint64_t ring_capacity = 8192;
+
+// slot fields are relaxed atomics so a reader racing the writer is benign
+struct trace_slot {
+    std::atomic<const char*> category;
+    std::atomic<const char*> name;
+    std::atomic<uint64_t> start_ns;
+    std::atomic<uint64_t> duration_ns;
+};
+
+/*
+ * Spans of one thread. Only the owning thread writes; readers copy the
+ * last ring_capacity events and drop the ones overwritten meanwhile
+*/
+struct trace_ring {
+    int tid;
+    std::atomic<uint64_t> head;     // number of events ever written
+    std::atomic<uint64_t> cleared;  // events before this index were dropped
+    trace_slot events[ring_capacity];
+
+    trace_ring(int id) : tid(id), head(0), cleared(0) {}
+};
+
+// rings are never freed: spans of finished threads remain available
+std::vector<trace_ring*> rings;
+
+#ifdef POKER_THREADS
+std::mutex rings_mutex;
+thread_local trace_ring* local_ring = NULL;
+#else
+trace_ring* local_ring = NULL;
+#endif
+
+trace_ring* new_ring() {
+#ifdef POKER_THREADS
+    std::lock_guard<std::mutex> lock(rings_mutex);
+#endif
+    auto r = new trace_ring(rings.size() + 1);
+    rings.push_back(r);
+    return r;
+}
+
+}  // namespace
+
+void enable_tracing(bool enabled) {
+    tracing_enabled.store(enabled);
+}
+
+void record_trace_event(const trace_event& e) {
+    if (!local_ring)
+        local_ring = new_ring();
+    auto h = local_ring->head.load(std::memory_order_relaxed);
+    auto& slot = local_ring->events[h % ring_capacity];
+    slot.category.store(e.category, std::memory_order_relaxed);
+    slot.name.store(e.name, std::memory_order_relaxed);
+    slot.start_ns.store(e.start_ns, std::memory_order_relaxed);
+    slot.duration_ns.store(e.duration_ns, std::memory_order_relaxed);
+    local_ring->head.store(h + 1, std::memory_order_release);
+}
+
+void clear_trace() {
+#ifdef POKER_THREADS
+    std::lock_guard<std::mutex> lock(rings_mutex);
+#endif
+    for (auto r : rings)
+        r->cleared.store(r->head.load(std::memory_order_acquire));
+}
+
+void write_trace(std::ostream& os) {
+#ifdef POKER_THREADS
+    std::lock_guard<std::mutex> lock(rings_mutex);
+#endif
+    auto flags = os.flags();
+    auto precision = os.precision();
+    os << std::fixed << std::setprecision(3);
+
+    os << "{\"traceEvents\":[";
+    bool first = true;
+    std::vector<trace_event> events;
+    for (auto r : rings) {
+        auto head = r->head.load(std::memory_order_acquire);
+        auto start = std::max(r->cleared.load(), head > ring_capacity ? head - ring_capacity : 0);
+        events.clear();
+        for (auto i = start; i < head; i++) {
+            auto& slot = r->events[i % ring_capacity];
+            trace_event e = {slot.category.load(std::memory_order_relaxed),
+                             slot.name.load(std::memory_order_relaxed),
+                             slot.start_ns.load(std::memory_order_relaxed),
+                             slot.duration_ns.load(std::memory_order_relaxed)};
+            events.push_back(e);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // skip events the writer overwrote while they were being copied
+        auto after = r->head.load(std::memory_order_acquire);
+        auto valid = after > ring_capacity ? after - ring_capacity : 0;
+        size_t skip = valid > start ? std::min<uint64_t>(valid - start, events.size()) : 0;
+
+        os << (first ? "" : ",")
+           << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << r->tid
+           << ",\"args\":{\"name\":\"thread " << r->tid << "\"}}";
+        first = false;
+        for (size_t i = skip; i < events.size(); i++) {
+            auto& e = events[i];
+            os << ",{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category
+               << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << r->tid
+               << ",\"ts\":" << e.start_ns / 1000.0
+               << ",\"dur\":" << e.duration_ns / 1000.0 << "}";
+        }
+    }
+    os << "],\"displayTimeUnit\":\"ms\"}";
+
+    os.flags(flags);
+    os.precision(precision);
+}
+
+}  // namespace poker
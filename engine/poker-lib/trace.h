@@ -0,0 +1,84 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace poker {
+
+/*
+ * Hot-path tracing.
+ * Spans are recorded into a per-thread ring buffer (single writer, no
+ * locks) and exported as Chrome/Perfetto trace-event JSON.
+ * When tracing is disabled a span costs one relaxed atomic load.
+*/
+
+extern std::atomic<bool> tracing_enabled;
+
+void enable_tracing(bool enabled);
+
+// Writes the recorded spans as Chrome trace-event JSON
+void write_trace(std::ostream& os);
+
+// Drops all recorded spans
+void clear_trace();
+
+struct trace_event {
+    const char* category;
+    const char* name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+};
+
+void record_trace_event(const trace_event& e);
+
+inline uint64_t trace_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/*
+ * Scoped span: records the time between construction and destruction.
+ * category and name must be string literals (only the pointers are kept)
+*/
+class trace_span {
+    const char* _category;
+    const char* _name;
+    uint64_t _start_ns;
+
+   public:
+    trace_span(const char* category, const char* name) : _category(NULL) {
+        if (tracing_enabled.load(std::memory_order_relaxed)) {
+            _category = category;
+            _name = name;
+            _start_ns = trace_now_ns();
+        }
+    }
+
+    ~trace_span() {
+        if (_category) {
+            trace_event e = {_category, _name, _start_ns, trace_now_ns() - _start_ns};
+            record_trace_event(e);
+        }
+    }
+
+    trace_span(const trace_span&) = delete;
+    void operator=(const trace_span&) = delete;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+// Traces the enclosing scope
+#define TRACE_SPAN(category, name) poker::trace_span TRACE_CONCAT(_trace_span_, __LINE__)(category, name)
+
+// Traces the enclosing function, named after it
+#define TRACE_FUNC(category) TRACE_SPAN(category, __func__)
+
+}  // namespace poker
+
+#endif
@@ -1,5 +1,5 @@
 import { BigNumber } from "ethers";
-import { Engine, EngineBetType, EngineResult, EngineState, StatusCode } from "./Engine";
+import { Engine, EngineBetType, EngineEvents, EngineResult, EngineState, StatusCode } from "./Engine";
 
 export class EngineImpl implements Engine {
     _player: number; //Player* address in C++ memory
@@ -8,9 +8,11 @@ export class EngineImpl implements Engine {
     callbacks: {};
     worker: Worker;
 
-    constructor(player_id: number, wasm_path: string = null) {
+    constructor(player_id: number, wasm_path: string = null, threads: boolean = supportsWasmThreads()) {
         if (wasm_path == null)
-          wasm_path = "../../assets/engine/poker-lib-wasm.js";
+          wasm_path = threads
+            ? "../../assets/engine/poker-lib-wasm-mt-worker.js"
+            : "../../assets/engine/poker-lib-wasm.js";
         
         this.player_id = player_id;
         this.counter = new Date().getTime();
@@ -26,10 +28,11 @@ export class EngineImpl implements Engine {
         bob_funds: BigNumber,
         big_blind: BigNumber,
         encryption: boolean = true,
-        winner: number = -1
+        winner: number = -1,
+        tmcg_profile: string = ""
     ): Promise<EngineResult> {
         // Initialize libraries
-        await this._callWorker("poker_init", makeMessage(encryption, false, winner), () => StatusCode.SUCCESS);
+        await this._callWorker("poker_init_ex", makeMessage(encryption, false, winner, tmcg_profile), () => StatusCode.SUCCESS);
 
         // create player instance
         await this._callWorker("poker_new_player", makeMessage(this.player_id), (results) => {
@@ -105,6 +108,20 @@ export class EngineImpl implements Engine {
         });
     }
 
+    async events(since: number): Promise<EngineEvents> {
+        return this._callWorker("player_events", makeMessage(this._player, since), (results) => {
+            return JSON.parse(parseString(results[0]), (key, value) => {
+                switch (key) {
+                    case "amount":
+                    case "bets":
+                        return BigNumber.from(value);
+                    default:
+                        return value;
+                }
+            });
+        });
+    }
+
     on_game_over(): void {
        this._callWorker("poker_delete_player", makeMessage(this._player), {});
     }
@@ -136,6 +153,15 @@ export class EngineImpl implements Engine {
     }
 }
 
+// The threaded module needs SharedArrayBuffer, which browsers only expose
+// to cross-origin isolated pages (COOP/COEP headers)
+export function supportsWasmThreads(): boolean {
+    if (typeof SharedArrayBuffer === "undefined") return false;
+    if (typeof crossOriginIsolated !== "undefined") return crossOriginIsolated;
+    // node
+    return typeof process === "object" && !!process.versions && !!process.versions.node;
+}
+
 function makeMessage(...args): Uint8Array {
     const enc = new TextEncoder();
     const buffers = [];
@@ -0,0 +1,55 @@
+require("./WebWorker.js");
+const path = require("path");
+import { expect } from "chai";
+import { BigNumber } from "ethers";
+import { StatusCode, EngineBetType, EngineStep } from "../src/Engine";
+import { EngineImpl, supportsWasmThreads } from "../src/EngineImpl";
+
+const wasm_mt_path = `${path.resolve(__dirname, "..")}/build/lib/poker-lib-wasm-mt-worker.js`;
+
+describe("Threaded WASM module", () => {
+    it("should be selected under node", () => {
+        expect(supportsWasmThreads()).to.equal(true);
+    });
+
+    it("should run an encrypted handshake and folds", async () => {
+        const alice = new EngineImpl(0, wasm_mt_path, true);
+        expect(await alice.init(BigNumber.from(200), BigNumber.from(300), BigNumber.from(10), true)).to.equal(
+            StatusCode.SUCCESS
+        );
+        const bob = new EngineImpl(1, wasm_mt_path, true);
+        expect(await bob.init(BigNumber.from(200), BigNumber.from(300), BigNumber.from(10), true)).to.equal(
+            StatusCode.SUCCESS
+        );
+
+        // Handshake
+        const r0 = await alice.create_handshake();
+        expect(r0.status).to.equal(StatusCode.SUCCESS);
+        const r1 = await bob.process_handshake(r0.message_out);
+        expect(r1.status).to.equal(StatusCode.CONTINUED);
+        const r2 = await alice.process_handshake(r1.message_out);
+        expect(r2.status).to.equal(StatusCode.CONTINUED);
+        const r3 = await bob.process_handshake(r2.message_out);
+        expect(r3.status).to.equal(StatusCode.CONTINUED);
+        const r4 = await alice.process_handshake(r3.message_out);
+        expect(r4.status).to.equal(StatusCode.SUCCESS);
+        const r5 = await bob.process_handshake(r4.message_out);
+        expect(r5.status).to.equal(StatusCode.SUCCESS);
+
+        // Preflop: Alice folds
+        const r6 = await alice.create_bet(EngineBetType.BET_FOLD, BigNumber.from(0));
+        expect(r6.status).to.equal(StatusCode.SUCCESS);
+        const r7 = await bob.process_bet(r6.message_out);
+        expect(r7.status).to.equal(StatusCode.SUCCESS);
+
+        const gAlice = await alice.game_state();
+        const gBob = await bob.game_state();
+        expect(gAlice.winner).to.equal(1);
+        expect(gBob.winner).to.equal(1);
+        expect(gAlice.step).to.equal(EngineStep.GAME_OVER);
+        expect(gBob.step).to.equal(EngineStep.GAME_OVER);
+
+        alice.on_game_over();
+        bob.on_game_over();
+    });
+});
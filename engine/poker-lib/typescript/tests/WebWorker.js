@@ -65,4 +65,40 @@ class WebWorker {
   }
 }
 
-global.Worker = WebWorker;
+/*
+The threaded module (poker-lib-wasm-mt-worker.js) needs real threads for
+its pthreads, so it is hosted by a node worker_threads Worker.
+*/
+class ThreadedWebWorker {
+  constructor(src) {
+    const { Worker } = require('worker_threads');
+    this.listeners = [];
+    this.worker = new Worker(path.resolve(src));
+    this.worker.on('message', (a) => {
+      this.listeners.map(fn => fn({data: a}));
+    });
+    // let mocha exit once the tests are done
+    this.worker.unref();
+  }
+
+  postMessage(m) {
+    this.worker.postMessage(m);
+  }
+
+  terminate() {
+    this.worker.terminate();
+  }
+
+  addEventListener(event, listener) {
+    if (event === 'message')
+      this.listeners.push(listener);
+  }
+
+  removeEventListener() { }
+}
+
+global.Worker = function(src) {
+  if (src.endsWith('-mt-worker.js'))
+    return new ThreadedWebWorker(src);
+  return new WebWorker(src);
+};
@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <chrono>
 #include <random>
+#include "codec.h"
+#include "trace.h"
 
 namespace poker {
 
@@ -36,40 +38,48 @@ int unencrypted_participant::num_participants() { return _num_participants; }
 bool unencrypted_participant::predictable() { return _predictable; }
 
 game_error unencrypted_participant::unencrypted_participant::create_group(blob& group) {
+    TRACE_FUNC("participant");
     logger << _pfx << "[MOCK] BarnettSmartVTMF_dlog done " << std::endl;
     return SUCCESS;
 }
 
 game_error unencrypted_participant::load_group(blob& group) {
+    TRACE_FUNC("participant");
     return SUCCESS;
 }
 
 game_error unencrypted_participant::generate_key(blob& key) {
+    TRACE_FUNC("participant");
     logger << _pfx << "[MOCK] publishKey " << std::endl;
     return SUCCESS;
 }
 
 game_error unencrypted_participant::load_their_key(blob& key) {
+    TRACE_FUNC("participant");
     logger << _pfx << "[MOCK] load_their_key " << std::endl;
     return SUCCESS;
 }
 
 game_error unencrypted_participant::finalize_key_generation() {
+    TRACE_FUNC("participant");
     logger << _pfx << "[MOCK] finalize_key_generation " << std::endl;
     return SUCCESS;
 }
 
 game_error unencrypted_participant::create_vsshe_group(blob& group) {
+    TRACE_FUNC("participant");
     logger << _pfx << "[MOCK] create_vsshe_group" << std::endl;
     return SUCCESS;
 }
 
 game_error unencrypted_participant::load_vsshe_group(blob& group) {
+    TRACE_FUNC("participant");
     logger << _pfx << "[MOCK] load_vsshe_group" << std::endl;
     return SUCCESS;
 }
 
 game_error unencrypted_participant::create_stack() {
+    TRACE_FUNC("participant");
     for (auto i = 0; i < DECK_SIZE; i++)
         _stack.push_back(i);
 
@@ -77,6 +87,7 @@ game_error unencrypted_participant::create_stack() {
 }
 
 game_error unencrypted_participant::shuffle_stack(blob& mixed_stack, blob& stack_proof) {
+    TRACE_FUNC("participant");
     logger << _pfx << "shuffle_stack" << std::endl;
 
     if (!_predictable) {
@@ -105,6 +116,7 @@ game_error unencrypted_participant::shuffle_stack(blob& mixed_stack, blob& stack
 }
 
 game_error unencrypted_participant::load_stack(blob& mixed_stack, blob& mixed_stack_proof) {
+    TRACE_FUNC("participant");
     logger << _pfx << "load_stack " << std::endl;
 
     std::vector<std::string> cards;
@@ -117,6 +129,14 @@ game_error unencrypted_participant::load_stack(blob& mixed_stack, blob& mixed_st
     return SUCCESS;
 }
 
+game_error unencrypted_participant::load_and_shuffle_stack(blob& their_stack, blob& their_proof, blob& mixed_stack, blob& stack_proof) {
+    TRACE_FUNC("participant");
+    game_error res;
+    if ((res = load_stack(their_stack, their_proof)))
+        return res;
+    return shuffle_stack(mixed_stack, stack_proof);
+}
+
 void unencrypted_participant::split_cards(std::string const& str, const char delim, std::vector<std::string>& out) {
     size_t start;
     size_t end = 0;
@@ -128,6 +148,7 @@ void unencrypted_participant::split_cards(std::string const& str, const char del
 }
 
 game_error unencrypted_participant::take_cards_from_stack(int count) {
+    TRACE_FUNC("participant");
     logger << _pfx << "take_cards_from_stack(" << count << ")" << std::endl;
 
     for (size_t i = 0; i < count; i++) {
@@ -139,30 +160,76 @@ game_error unencrypted_participant::take_cards_from_stack(int count) {
 }
 
 game_error unencrypted_participant::prove_card_secret(int card_index, blob& my_proof) {
+    TRACE_FUNC("participant");
     logger << _pfx << "[MOCK] prove_card_secret(" << card_index << ")" << std::endl;
     return SUCCESS;
 }
 
 game_error unencrypted_participant::self_card_secret(int card_index) {
+    TRACE_FUNC("participant");
     logger << _pfx << "[MOCK] self_card_secret(" << card_index << ")" << std::endl;
     return SUCCESS;
 }
 
 game_error unencrypted_participant::verify_card_secret(int card_index, blob& their_proof) {
+    TRACE_FUNC("participant");
     logger << _pfx << "[MOCK] verify_card_secret(" << card_index << ")" << std::endl;
     return SUCCESS;
 }
 
 game_error unencrypted_participant::open_card(int card_index) {
-    logger << _pfx << "open_card(" << card_index << ")" << std::endl;
+    TRACE_FUNC("participant");
+    logger_at(LOG_TRACE) << _pfx << "open_card(" << card_index << ")" << std::endl;
     return SUCCESS;
 }
 
 size_t unencrypted_participant::get_open_card(int card_index) {
-    logger << _pfx << "get_open_card(" << card_index << ")" << std::endl;
+    logger_at(LOG_TRACE) << _pfx << "get_open_card(" << card_index << ")" << std::endl;
     auto card_type = _cards[card_index];
-    logger << _pfx << "get_open_card(" << card_index << ") = " << card_type << std::endl;
+    logger_at(LOG_TRACE) << _pfx << "get_open_card(" << card_index << ") = " << card_type << std::endl;
     return card_type;
 }
 
+static game_error write_cards(encoder& out, const std::vector<int>& cards) {
+    game_error res;
+    if ((res = out.write((int)cards.size())))
+        return res;
+    for (auto card : cards)
+        if ((res = out.write(card)))
+            return res;
+    return SUCCESS;
+}
+
+static game_error read_cards(decoder& in, std::vector<int>& cards) {
+    game_error res;
+    int count;
+    if ((res = in.read(count)))
+        return res;
+    if (count < 0 || count > DECK_SIZE)
+        return COD_ERROR;
+    cards.resize(count);
+    for (auto& card : cards)
+        if ((res = in.read(card)))
+            return res;
+    return SUCCESS;
+}
+
+game_error unencrypted_participant::save(std::ostream& os) {
+    TRACE_FUNC("participant");
+    game_error res;
+    encoder out(os);
+    if ((res = write_cards(out, _stack)))
+        return res;
+    return write_cards(out, _cards);
+}
+
+game_error unencrypted_participant::restore(std::istream& is) {
+    TRACE_FUNC("participant");
+    game_error res;
+    decoder in(is);
+    if ((res = read_cards(in, _stack)))
+        return res;
+    return read_cards(in, _cards);
+}
+
 }  // namespace poker
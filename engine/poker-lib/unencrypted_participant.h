@@ -42,6 +42,7 @@ class unencrypted_participant : public i_participant {
     game_error create_stack() override;
     game_error shuffle_stack(blob& mixed_stack, blob& stack_proof) override;
     game_error load_stack(blob& mixed_stack, blob& mixed_stack_proof) override;
+    game_error load_and_shuffle_stack(blob& their_stack, blob& their_proof, blob& mixed_stack, blob& stack_proof) override;
 
     // Cards
     game_error take_cards_from_stack(int count) override;
@@ -50,6 +51,9 @@ class unencrypted_participant : public i_participant {
     game_error verify_card_secret(int card_index, blob& their_proof) override;
     game_error open_card(int card_index) override;
     size_t get_open_card(int card_index) override;
+
+    game_error save(std::ostream& os) override;
+    game_error restore(std::istream& is) override;
 };
 
 }  // namespace poker
@@ -52,12 +52,16 @@ game_error verifier::verify() {
     }
 
     // write verification results and game state as JSON to stdout
-    std::cout << "{\"funds\":[";
-    for(int i=0; i < _results.size(); i++) {
-        if (i>0) std::cout << ",";
-        std::cout << "\"" << _results[i].to_string() << "\"";
-    }
-    std::cout << "], \"game_state\":" << _g.to_json() << "}";
+    std::string json;
+    json_writer w(json);
+    w.begin_object().key("funds").begin_array();
+    for (auto& funds : _results)
+        w.value(funds);
+    w.end_array();
+    w.key("game_state");
+    _g.write_json(w);
+    w.end_object();
+    std::cout << json;
 
     return SUCCESS;
 }
@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# Size and startup time of verifier binaries.
+# Startup is measured up to the first file the verifier opens, which is
+# missing: process creation, loading, static initialization and
+# init_poker_lib(). Reports the median of RUNS runs.
+#
+# Usage: verify-report.sh <verifier>...
+
+RUNS=${RUNS:-50}
+
+if [ $# -eq 0 ]; then
+  echo "Usage: $0 <verifier>..." >&2
+  exit 1
+fi
+
+size "$@"
+echo
+
+printf "%-20s %12s %10s %16s\n" binary bytes libs "startup (us)"
+for v in "$@"; do
+  bytes=$(wc -c < "$v")
+  libs=$(ldd "./$v" 2>/dev/null | grep -c "=>")
+  times=()
+  for i in $(seq $RUNS); do
+    t0=$(date +%s%N)
+    "./$v" /nonexistent /nonexistent /nonexistent /nonexistent /nonexistent > /dev/null 2>&1
+    t1=$(date +%s%N)
+    times+=($(( (t1 - t0) / 1000 )))
+  done
+  median=$(printf "%s\n" "${times[@]}" | sort -n | sed -n "$(( (RUNS + 1) / 2 ))p")
+  printf "%-20s %12s %10s %16s\n" "$v" "$bytes" "$libs" "$median"
+done
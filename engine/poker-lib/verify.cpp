@@ -2,6 +2,7 @@
 #include <fstream>
 #include "common.h"
 #include "poker-lib.h"
+#include "trace.h"
 #include "verifier.h"
 
 void open_write(std::ofstream &f, char* path);
@@ -11,7 +12,7 @@ using namespace poker;
 
 int usage(int argc, char**argv) {
     std::cerr << "Usage: " << argv[0]
-        << "<player-info-path>  <turn-metadata-path> <verification-info-path>  <turn-data-path> <output-path>"
+        << " [--trace <trace-output-path>] <player-info-path>  <turn-metadata-path> <verification-info-path>  <turn-data-path> <output-path>"
         << std::endl;
     return 1;
 }
@@ -20,10 +21,18 @@ int usage(int argc, char**argv) {
 * poker verifier
 */
 int main(int argc, char**argv) {
+    char* trace_path = NULL;
+    if (argc == 8 && std::string(argv[1]) == "--trace") {
+        trace_path = argv[2];
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
     if (argc !=6)
         return usage(argc, argv);
     
     poker_lib_options opts;
+    opts.tracing = opts.tracing || trace_path;
     init_poker_lib(&opts);
     
     logger << "opening files... \n";
@@ -40,6 +49,11 @@ int main(int argc, char**argv) {
     logger << "verifying... \n";
     verifier ver(player_info, turn_metadata, verification_info, turn_data, output);
     auto res = ver.verify();
+    if (trace_path) {
+        std::ofstream trace;
+        open_write(trace, trace_path);
+        write_trace(trace);
+    }
     if (res) {
         std::cout << std::endl << ver.game().to_json() << std::endl;
         return (int)res;
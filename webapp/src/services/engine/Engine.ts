@@ -6,13 +6,18 @@ export interface Engine {
         bob_funds: BigNumber,
         big_blind: BigNumber,
         encryption: boolean,
-        winner: number
+        winner: number,
+        // libTMCG group parameters: "fast-test", "standard" or "high"
+        tmcg_profile?: string
     ): Promise<EngineResult>;
     create_handshake(): Promise<EngineResult>;
     process_handshake(message_in: Uint8Array): Promise<EngineResult>;
     create_bet(type: bet_type, amount: BigNumber): Promise<EngineResult>;
     process_bet(message_in: Uint8Array): Promise<EngineResult>;
     game_state(): Promise<game_state>;
+    // state changes after sequence number since; pass the last_seq of
+    // the previous call to only get new ones
+    events(since: number): Promise<game_events>;
     on_game_over(): void;
 }
 
@@ -41,6 +46,31 @@ interface player_state {
     total_funds: BigNumber;
     bets: BigNumber;
     cards: number[];
+    hand: hand_strength | null;
+}
+
+interface game_events {
+    last_seq: number;
+    events: game_event[];
+}
+
+interface game_event {
+    seq: number;
+    type: "card_opened" | "bet" | "phase" | "winner";
+    player?: number;    // card_opened (-1 for public cards), bet
+    index?: number;     // card_opened
+    card?: number;      // card_opened
+    bet_type?: number;  // bet
+    amount?: BigNumber; // bet
+    bets?: BigNumber;   // bet
+    phase?: number;     // phase
+    winner?: number;    // winner
+}
+
+interface hand_strength {
+    category: string;
+    rank: number;
+    outs: number;
 }
 
 // Auto-generated enums
@@ -205,5 +235,6 @@ export {
     bet_type as EngineBetType,
     game_state as EngineState,
     player_state as EnginePlayer,
+    game_events as EngineEvents,
     game_step as EngineStep,
 };